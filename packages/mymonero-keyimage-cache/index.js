@@ -10,6 +10,17 @@ const Lazy_KeyImage = function (
   spend_key__private,
   coreBridge_instance // must pass this so this fn can remain synchronous
 ) {
+  if (typeof coreBridge_instance.cachedKeyImage === 'function') {
+    // the bridge keeps a bounded, persistable cache per wallet so the JS dictionary isn't needed
+    return coreBridge_instance.cachedKeyImage(
+      public_address,
+      tx_pub_key,
+      view_key__private,
+      spend_key__public,
+      spend_key__private,
+      out_index
+    )
+  }
   var cache_index = tx_pub_key + ':' + public_address + ':' + out_index
   const cached__key_image = mutable_keyImagesByCacheKey[cache_index]
   if (
@@ -59,11 +70,14 @@ const Lazy_KeyImageCacheForWalletWith = function (public_address) {
 }
 exports.Lazy_KeyImageCacheForWalletWith = Lazy_KeyImageCacheForWalletWith
 
-const DeleteManagedKeyImagesForWalletWith = function (public_address) {
+const DeleteManagedKeyImagesForWalletWith = function (public_address, coreBridge_instance) {
   // IMPORTANT: Ensure you call this method when you want to clear your wallet from
   // memory or delete it, or else you could leak key images and public addresses.
   const cacheId = _managedKeyImageCacheWalletIdForWalletWith(public_address)
   delete __global_managed_keyImageCaches_by_walletId[cacheId]
+  if (coreBridge_instance && typeof coreBridge_instance.deleteKeyImageCache === 'function') {
+    coreBridge_instance.deleteKeyImageCache(cacheId)
+  }
   //
   const cache = __global_managed_keyImageCaches_by_walletId[cacheId]
   if (typeof cache !== 'undefined') {
@@ -71,3 +85,22 @@ const DeleteManagedKeyImagesForWalletWith = function (public_address) {
   }
 }
 exports.DeleteManagedKeyImagesForWalletWith = DeleteManagedKeyImagesForWalletWith
+//
+// Persistence - only available with bridges which keep the key image cache natively
+const KeyImageCacheSnapshotForWalletWith = function (public_address, coreBridge_instance) {
+  const cacheId = _managedKeyImageCacheWalletIdForWalletWith(public_address)
+  if (typeof coreBridge_instance.keyImageCacheSnapshot !== 'function') {
+    return null
+  }
+  return coreBridge_instance.keyImageCacheSnapshot(cacheId) // Uint8Array
+}
+exports.KeyImageCacheSnapshotForWalletWith = KeyImageCacheSnapshotForWalletWith
+
+const LoadKeyImageCacheSnapshotForWalletWith = function (public_address, snapshot, coreBridge_instance) {
+  const cacheId = _managedKeyImageCacheWalletIdForWalletWith(public_address)
+  if (typeof coreBridge_instance.loadKeyImageCacheSnapshot !== 'function') {
+    return false
+  }
+  return coreBridge_instance.loadKeyImageCacheSnapshot(cacheId, snapshot)
+}
+exports.LoadKeyImageCacheSnapshotForWalletWith = LoadKeyImageCacheSnapshotForWalletWith
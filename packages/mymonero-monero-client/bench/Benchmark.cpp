@@ -0,0 +1,167 @@
+//
+//  Benchmark.cpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+#include "Benchmark.hpp"
+//
+#include <new>
+#include <cstddef>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+//
+using namespace std;
+//
+// Runtime - Allocation counting
+//
+// Every block carries its size in a header so that delete can keep live/peak bytes current.
+static atomic<uint64_t> allocation__count(0);
+static atomic<uint64_t> allocation__bytes(0);
+static atomic<uint64_t> allocation__live_bytes(0);
+static atomic<uint64_t> allocation__peak_live_bytes(0);
+static const size_t allocation__header_size = alignof(std::max_align_t) > sizeof(size_t) ? alignof(std::max_align_t) : sizeof(size_t);
+//
+static void *_counted_alloc(size_t size)
+{
+	void *block = malloc(size + allocation__header_size);
+	if (block == NULL) {
+		return NULL;
+	}
+	*(size_t *)block = size;
+	allocation__count.fetch_add(1, memory_order_relaxed);
+	allocation__bytes.fetch_add(size, memory_order_relaxed);
+	uint64_t live = allocation__live_bytes.fetch_add(size, memory_order_relaxed) + size;
+	uint64_t peak = allocation__peak_live_bytes.load(memory_order_relaxed);
+	while (live > peak && !allocation__peak_live_bytes.compare_exchange_weak(peak, live, memory_order_relaxed)) {}
+	return (char *)block + allocation__header_size;
+}
+static void _counted_free(void *ptr)
+{
+	if (ptr == NULL) {
+		return;
+	}
+	void *block = (char *)ptr - allocation__header_size;
+	allocation__live_bytes.fetch_sub(*(size_t *)block, memory_order_relaxed);
+	free(block);
+}
+void *operator new(size_t size)
+{
+	void *ptr = _counted_alloc(size);
+	if (ptr == NULL) {
+		throw bad_alloc();
+	}
+	return ptr;
+}
+void *operator new[](size_t size) { return operator new(size); }
+void *operator new(size_t size, const nothrow_t &) noexcept { return _counted_alloc(size); }
+void *operator new[](size_t size, const nothrow_t &) noexcept { return _counted_alloc(size); }
+void operator delete(void *ptr) noexcept { _counted_free(ptr); }
+void operator delete[](void *ptr) noexcept { _counted_free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { _counted_free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { _counted_free(ptr); }
+void operator delete(void *ptr, const nothrow_t &) noexcept { _counted_free(ptr); }
+void operator delete[](void *ptr, const nothrow_t &) noexcept { _counted_free(ptr); }
+//
+Bench::AllocationCounters Bench::allocation_counters()
+{
+	return AllocationCounters{
+		allocation__count.load(),
+		allocation__bytes.load(),
+		allocation__live_bytes.load(),
+		allocation__peak_live_bytes.load()
+	};
+}
+void Bench::reset_peak_live_bytes()
+{
+	allocation__peak_live_bytes.store(allocation__live_bytes.load());
+}
+static volatile size_t do_not_optimize__sink;
+void Bench::do_not_optimize(const string &value)
+{
+	do_not_optimize__sink = value.size();
+}
+//
+// Runtime - Registry
+struct _Case
+{
+	string name;
+	Bench::Fn fn;
+};
+static vector<_Case> &_cases()
+{
+	static vector<_Case> cases;
+	return cases;
+}
+void Bench::add(const string &name, Fn fn)
+{
+	_cases().push_back(_Case{ name, std::move(fn) });
+}
+//
+// Imperatives
+vector<Bench::Result> Bench::run(const string &filter, uint64_t min_time_ms)
+{
+	typedef chrono::steady_clock clock;
+	vector<Result> results;
+	for (const _Case &c : _cases()) {
+		if (!filter.empty() && c.name.find(filter) == string::npos) {
+			continue;
+		}
+		c.fn(); // warm-up: first-touch allocations, lazily built tables
+		Result result{ c.name, 0, 0, 0, 0, 0 };
+		AllocationCounters before = allocation_counters();
+		clock::duration elapsed(0);
+		while (elapsed < chrono::milliseconds(min_time_ms) || result.iterations == 0) {
+			uint64_t live_at_start = allocation_counters().live_bytes;
+			reset_peak_live_bytes();
+			clock::time_point start = clock::now();
+			c.fn();
+			elapsed += clock::now() - start;
+			result.peak_bytes = max(result.peak_bytes, (size_t)(allocation_counters().peak_live_bytes - live_at_start));
+			result.iterations += 1;
+		}
+		AllocationCounters after = allocation_counters();
+		result.ns_per_op = (double)chrono::duration_cast<chrono::nanoseconds>(elapsed).count() / result.iterations;
+		result.allocs_per_op = (double)(after.n_allocs - before.n_allocs) / result.iterations;
+		result.bytes_per_op = (double)(after.n_bytes - before.n_bytes) / result.iterations;
+		results.push_back(result);
+		print(vector<Result>{ result });
+	}
+	return results;
+}
+void Bench::print(const vector<Result> &results)
+{
+	for (const Result &r : results) {
+		printf("%-40s %10zu it %14.0f ns/op %12.1f allocs/op %14.0f B/op %12zu peak B\n",
+			r.name.c_str(), r.iterations, r.ns_per_op, r.allocs_per_op, r.bytes_per_op, r.peak_bytes);
+		fflush(stdout);
+	}
+}
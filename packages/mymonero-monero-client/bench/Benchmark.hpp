@@ -0,0 +1,84 @@
+//
+//  Benchmark.hpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#ifndef Benchmark_hpp
+#define Benchmark_hpp
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <functional>
+
+namespace Bench
+{
+	using namespace std;
+	//
+	// A minimal google-benchmark-style harness with no dependencies beyond the standard library,
+	// so it builds anywhere the native library does.
+	//
+	// Each case runs until it has taken at least `min_time_ms`, after one untimed warm-up call.
+	// Allocations are counted by replacing the global operator new/delete (see Benchmark.cpp),
+	// so they cover C++ allocations only - not malloc calls made by the C parts of the core.
+	//
+	struct Result
+	{
+		string name;
+		size_t iterations;
+		double ns_per_op;
+		double allocs_per_op;
+		double bytes_per_op; // allocated, not retained
+		size_t peak_bytes; // highest live-heap growth over the starting point seen during any one call
+	};
+	//
+	typedef function<void(void)> Fn;
+	void add(const string &name, Fn fn);
+	//
+	// Runs every case whose name contains `filter` (all when empty) and prints a table
+	vector<Result> run(const string &filter, uint64_t min_time_ms = 500);
+	void print(const vector<Result> &results);
+	//
+	// Allocation counters - cumulative since process start
+	struct AllocationCounters
+	{
+		uint64_t n_allocs;
+		uint64_t n_bytes;
+		uint64_t live_bytes;
+		uint64_t peak_live_bytes;
+	};
+	AllocationCounters allocation_counters();
+	void reset_peak_live_bytes(); // peak := live
+	//
+	// Keeps the optimizer from discarding a result
+	void do_not_optimize(const string &value);
+}
+
+#endif /* Benchmark_hpp */
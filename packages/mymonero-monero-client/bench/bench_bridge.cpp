@@ -0,0 +1,731 @@
+//
+//  bench_bridge.cpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+//
+// Benchmarks every exported bridge function through the same entry points the WASM and
+// C ABI callers use, over the fixture wallets written by mymonero_client_bench_fixtures.
+//
+//   mymonero_client_bench [filter] [--fixtures <dir>] [--min-time <ms>]
+//
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+//
+#include "Benchmark.hpp"
+#include "StreamingJSON.hpp"
+#include "mymonero_client.h"
+#include "serial_bridge_index.hpp"
+#include "emscr_KeyImage_bridge.hpp"
+#include "emscr_WalletContext_bridge.hpp"
+#include "emscr_OutputScanner_bridge.hpp"
+#include "emscr_Address_bridge.hpp"
+#include "emscr_Fee_bridge.hpp"
+#include "emscr_TransactionHistory_bridge.hpp"
+#include "emscr_WalletState_bridge.hpp"
+#include "AddressDecoding.hpp"
+#include "crypto.h"
+#include "ringct/rctOps.h"
+#include "string_tools.h"
+extern "C" {
+#include "crypto-ops.h"
+}
+//
+using namespace std;
+//
+struct FixtureOutput
+{
+	string tx_pub_key;
+	string index;
+	string public_key;
+	string rct; // commitment + encrypted amount
+};
+struct Fixture
+{
+	string name; // e.g. "1k"
+	string address;
+	string seed;
+	string sec_viewKey;
+	string pub_spendKey;
+	string sec_spendKey;
+	string send_amount;
+	string unspentOuts_json; // verbatim, as a get_unspent_outs response
+	vector<FixtureOutput> outputs;
+	vector<string> decoys_json; // verbatim random outs
+};
+//
+// Accessory functions
+static bool _read_file(const string &path, string &out__contents)
+{
+	ifstream file(path, ios::binary);
+	if (!file) {
+		return false;
+	}
+	stringstream ss;
+	ss << file.rdbuf();
+	out__contents = ss.str();
+	return true;
+}
+static void _read_fixture_outputs(StreamingJSON::Reader &reader, vector<FixtureOutput> &out__outputs)
+{
+	reader.begin_array();
+	while (reader.next_element()) {
+		FixtureOutput output;
+		string key;
+		reader.begin_object();
+		while (reader.next_key(key)) {
+			if (key == "tx_pub_key") {
+				reader.read_string(output.tx_pub_key);
+			} else if (key == "index") {
+				reader.read_scalar_text(output.index);
+			} else if (key == "public_key") {
+				reader.read_string(output.public_key);
+			} else if (key == "rct") {
+				reader.read_string(output.rct);
+			} else {
+				reader.skip_value();
+			}
+		}
+		out__outputs.push_back(std::move(output));
+	}
+}
+static bool _load_fixture(const string &path, const string &name, Fixture &out__fixture)
+{
+	string contents;
+	if (!_read_file(path, contents)) {
+		return false;
+	}
+	out__fixture.name = name;
+	StreamingJSON::Reader reader(contents);
+	string key;
+	reader.begin_object();
+	while (reader.next_key(key)) {
+		if (key == "wallet") {
+			string wallet_key;
+			reader.begin_object();
+			while (reader.next_key(wallet_key)) {
+				if (wallet_key == "address") {
+					reader.read_string(out__fixture.address);
+				} else if (wallet_key == "seed") {
+					reader.read_string(out__fixture.seed);
+				} else if (wallet_key == "sec_viewKey") {
+					reader.read_string(out__fixture.sec_viewKey);
+				} else if (wallet_key == "pub_spendKey") {
+					reader.read_string(out__fixture.pub_spendKey);
+				} else if (wallet_key == "sec_spendKey") {
+					reader.read_string(out__fixture.sec_spendKey);
+				} else {
+					reader.skip_value();
+				}
+			}
+		} else if (key == "unspentOuts") {
+			const char *begin, *end;
+			reader.read_raw_value(begin, end);
+			out__fixture.unspentOuts_json.assign(begin, end);
+			//
+			StreamingJSON::Reader outs_reader(begin, end);
+			string outs_key;
+			outs_reader.begin_object();
+			while (outs_reader.next_key(outs_key)) {
+				if (outs_key == "outputs") {
+					_read_fixture_outputs(outs_reader, out__fixture.outputs);
+				} else {
+					outs_reader.skip_value();
+				}
+			}
+		} else if (key == "decoys") {
+			reader.begin_array();
+			while (reader.next_element()) {
+				const char *begin, *end;
+				reader.read_raw_value(begin, end);
+				out__fixture.decoys_json.emplace_back(begin, end);
+			}
+		} else if (key == "send_amount") {
+			reader.read_string(out__fixture.send_amount);
+		} else {
+			reader.skip_value();
+		}
+	}
+	return true;
+}
+//
+static string _prepare_args(const Fixture &fixture)
+{
+	StreamingJSON::Writer writer(fixture.unspentOuts_json.size() + 1024);
+	writer.begin_object();
+	writer.key("destinations").begin_array();
+	writer.begin_object();
+	writer.key("to_address").string_value(fixture.address);
+	writer.key("send_amount").string_value(fixture.send_amount);
+	writer.end_object();
+	writer.end_array();
+	writer.key("from_address_string").string_value(fixture.address);
+	writer.key("sec_viewKey_string").string_value(fixture.sec_viewKey);
+	writer.key("sec_spendKey_string").string_value(fixture.sec_spendKey);
+	writer.key("pub_spendKey_string").string_value(fixture.pub_spendKey);
+	writer.key("is_sweeping").bool_string_value(false);
+	writer.key("priority").string_value("1");
+	writer.key("nettype_string").string_value("MAINNET");
+	writer.key("unspentOuts");
+	writer.raw_value(fixture.unspentOuts_json.data(), fixture.unspentOuts_json.data() + fixture.unspentOuts_json.size());
+	writer.end_object();
+	return writer.take();
+}
+// the send from a wallet context's output index: unspentOuts keeps only its fee fields
+static string _output_index_prepare_args(const Fixture &fixture, const string &wallet_context)
+{
+	StreamingJSON::Writer writer(1024);
+	writer.begin_object();
+	writer.key("destinations").begin_array();
+	writer.begin_object();
+	writer.key("to_address").string_value(fixture.address);
+	writer.key("send_amount").string_value(fixture.send_amount);
+	writer.end_object();
+	writer.end_array();
+	writer.key("wallet_context").string_value(wallet_context);
+	writer.key("output_index").string_value("minimize_inputs");
+	writer.key("is_sweeping").bool_string_value(false);
+	writer.key("priority").string_value("1");
+	writer.key("nettype_string").string_value("MAINNET");
+	writer.key("unspentOuts").begin_object();
+	StreamingJSON::Reader reader(fixture.unspentOuts_json);
+	string key;
+	const char *begin, *end;
+	reader.begin_object();
+	while (reader.next_key(key)) {
+		if (key == "outputs") {
+			reader.skip_value();
+			continue;
+		}
+		reader.read_raw_value(begin, end);
+		writer.key(key.c_str()).raw_value(begin, end);
+	}
+	writer.key("outputs").begin_array().end_array();
+	writer.end_object();
+	writer.end_object();
+	return writer.take();
+}
+static string _output_index_add_args(const Fixture &fixture, const string &wallet_context)
+{
+	StreamingJSON::Writer writer(fixture.unspentOuts_json.size() + 256);
+	writer.begin_object();
+	writer.key("wallet_context").string_value(wallet_context);
+	StreamingJSON::Reader reader(fixture.unspentOuts_json);
+	string key;
+	const char *begin, *end;
+	reader.begin_object();
+	while (reader.next_key(key)) {
+		if (key == "outputs") {
+			reader.read_raw_value(begin, end);
+			writer.key("outputs").raw_value(begin, end);
+		} else {
+			reader.skip_value();
+		}
+	}
+	writer.end_object();
+	return writer.take();
+}
+// the fixture's unspentOuts as appendUnspentOuts chunks of up to chunk_size outputs
+static vector<string> _unspent_outs_chunks(const Fixture &fixture, size_t chunk_size)
+{
+	vector<string> chunks;
+	StreamingJSON::Reader reader(fixture.unspentOuts_json);
+	string key;
+	const char *begin, *end;
+	reader.begin_object();
+	while (reader.next_key(key)) {
+		if (key != "outputs") {
+			reader.skip_value();
+			continue;
+		}
+		reader.begin_array();
+		size_t n_in_chunk = 0;
+		StreamingJSON::Writer writer(64);
+		while (reader.next_element()) {
+			if (n_in_chunk == 0) {
+				writer = StreamingJSON::Writer(chunk_size * 512);
+				writer.begin_object();
+				writer.key("outputs").begin_array();
+			}
+			reader.read_raw_value(begin, end);
+			writer.raw_value(begin, end);
+			if (++n_in_chunk == chunk_size) {
+				writer.end_array();
+				writer.end_object();
+				chunks.push_back(writer.take());
+				n_in_chunk = 0;
+			}
+		}
+		if (n_in_chunk > 0) {
+			writer.end_array();
+			writer.end_object();
+			chunks.push_back(writer.take());
+		}
+	}
+	return chunks;
+}
+static string _random_outs_args(const Fixture &fixture, const string &prepare_response)
+{ // answers a random outs request from the decoy pool
+	string session_id;
+	uint64_t count = 0;
+	vector<string> amounts;
+	StreamingJSON::Reader reader(prepare_response);
+	string key;
+	reader.begin_object();
+	while (reader.next_key(key)) {
+		if (key == "session_id") {
+			reader.read_scalar_text(session_id);
+		} else if (key == "count") {
+			count = reader.read_uint64();
+		} else if (key == "amounts") {
+			reader.begin_array();
+			while (reader.next_element()) {
+				string amount;
+				reader.read_scalar_text(amount);
+				amounts.push_back(std::move(amount));
+			}
+		} else if (key == "err_msg") {
+			string err_msg;
+			reader.read_string(err_msg);
+			fprintf(stderr, "prepareTx/%s failed: %s\n", fixture.name.c_str(), err_msg.c_str());
+			exit(1);
+		} else {
+			reader.skip_value();
+		}
+	}
+	StreamingJSON::Writer writer(amounts.size() * count * 200 + 256);
+	writer.begin_object();
+	writer.key("session_id").string_value(session_id);
+	writer.key("amount_outs").begin_array();
+	size_t next_decoy = 0;
+	for (const string &amount : amounts) {
+		writer.begin_object();
+		writer.key("amount").string_value(amount);
+		writer.key("outputs").begin_array();
+		for (uint64_t i = 0; i < count; ++i) {
+			const string &decoy = fixture.decoys_json[next_decoy++ % fixture.decoys_json.size()];
+			writer.raw_value(decoy.data(), decoy.data() + decoy.size());
+		}
+		writer.end_array();
+		writer.end_object();
+	}
+	writer.end_array();
+	writer.end_object();
+	return writer.take();
+}
+static string _key_images_args(const Fixture &fixture, size_t n_outputs)
+{
+	StreamingJSON::Writer writer(n_outputs * 120 + 256);
+	writer.begin_object();
+	writer.key("sec_viewKey_string").string_value(fixture.sec_viewKey);
+	writer.key("pub_spendKey_string").string_value(fixture.pub_spendKey);
+	writer.key("sec_spendKey_string").string_value(fixture.sec_spendKey);
+	writer.key("outputs").begin_array();
+	for (size_t i = 0; i < n_outputs && i < fixture.outputs.size(); ++i) {
+		writer.begin_object();
+		writer.key("tx_pub_key").string_value(fixture.outputs[i].tx_pub_key);
+		writer.key("out_index").string_value(fixture.outputs[i].index);
+		writer.end_object();
+	}
+	writer.end_array();
+	writer.end_object();
+	return writer.take();
+}
+static string _scan_args(const Fixture &fixture, const string &wallet_context)
+{ // each fixture output in a two-output transaction, beside a decoy which isn't ours
+	StreamingJSON::Writer writer(fixture.outputs.size() * 400 + 256);
+	writer.begin_object();
+	writer.key("wallet_context").string_value(wallet_context);
+	writer.key("transactions").begin_array();
+	for (size_t i = 0; i < fixture.outputs.size(); ++i) {
+		const FixtureOutput &output = fixture.outputs[i];
+		writer.begin_object();
+		writer.key("tx_pub_key").string_value(output.tx_pub_key);
+		writer.key("outputs").begin_array();
+		for (size_t j = 0; j < 2; ++j) {
+			writer.begin_object();
+			if (std::to_string(j) == output.index) {
+				writer.key("public_key").string_value(output.public_key);
+				writer.key("commitment").string_value(output.rct.substr(0, 64));
+				writer.key("encrypted_amount").string_value(output.rct.substr(64, 16));
+			} else {
+				writer.key("public_key").string_value(output.tx_pub_key); // a valid point which isn't ours
+			}
+			writer.end_object();
+		}
+		writer.end_array();
+		writer.end_object();
+	}
+	writer.end_array();
+	writer.end_object();
+	return writer.take();
+}
+static string _ret_val(const string &ret_json)
+{
+	StreamingJSON::Reader reader(ret_json);
+	string key, value;
+	reader.begin_object();
+	while (reader.next_key(key)) {
+		if (key == "retVal") {
+			reader.read_string(value);
+		} else {
+			reader.skip_value();
+		}
+	}
+	return value;
+}
+static string _take_c_str(char *c_str)
+{
+	string str(c_str != NULL ? c_str : "");
+	mymonero_string_free(c_str);
+	return str;
+}
+//
+// Known answers of the curve primitives, for the keys of the "generate key image" unit test - so
+// that a build with another crypto-ops implementation (MYMONERO_CLIENT_CRYPTO_OPS) is timed only
+// once it agrees with ref10. Returns the name of the first primitive which disagrees.
+static const char *_failed_crypto_vector()
+{
+	crypto::public_key tx_pub_key, pub_spendKey;
+	crypto::secret_key sec_viewKey, sec_spendKey;
+	epee::string_tools::hex_to_pod("585d3601bc6f3b63ad041fbb5f301a6239cbc98ec2954ef827d5f81aed59cff9", tx_pub_key);
+	epee::string_tools::hex_to_pod("5925eac0f78c40a79c75a43be68905adeb7b6ae34c1be2dda2b5b417f8099700", sec_viewKey);
+	epee::string_tools::hex_to_pod("1a9fd7ccfa0de91673f5637eb94a67d85b54eae83d1ec9b609689ec846a50fdd", pub_spendKey);
+	epee::string_tools::hex_to_pod("5000f1da72ec13401b6e4cfccdc5e52c9d0b04383fcb32c85f235874c5104e0d", sec_spendKey);
+	//
+	crypto::public_key derived_pub_spendKey;
+	if (!crypto::secret_key_to_public_key(sec_spendKey, derived_pub_spendKey) || derived_pub_spendKey != pub_spendKey) {
+		return "scalarmult_base";
+	}
+	crypto::key_derivation derivation;
+	if (!crypto::generate_key_derivation(tx_pub_key, sec_viewKey, derivation)
+		|| epee::string_tools::pod_to_hex(derivation) != "1f602b47b423b95c2571f59f845b2abecec93b757d220588698bb9942f381309") {
+		return "scalarmult";
+	}
+	ge_p3 tx_pub_key__p3;
+	ge_p2 sum;
+	crypto::public_key sum_key;
+	ge_frombytes_vartime(&tx_pub_key__p3, (const unsigned char *)&tx_pub_key);
+	ge_double_scalarmult_base_vartime(&sum, (const unsigned char *)&sec_viewKey, &tx_pub_key__p3, (const unsigned char *)&sec_spendKey);
+	ge_tobytes((unsigned char *)&sum_key, &sum);
+	if (epee::string_tools::pod_to_hex(sum_key) != "6a08a27ed4d8172500401f13fc95554e3a8894236c9b3a9b967c752041b34d23") {
+		return "double_scalarmult_base";
+	}
+	// hash_to_ec only shows through the key image
+	crypto::secret_key output_sec_key;
+	crypto::public_key output_pub_key;
+	crypto::key_image key_image;
+	crypto::derive_secret_key(derivation, 1, sec_spendKey, output_sec_key);
+	crypto::secret_key_to_public_key(output_sec_key, output_pub_key);
+	crypto::generate_key_image(output_pub_key, output_sec_key, key_image);
+	if (epee::string_tools::pod_to_hex(key_image) != "8a90c3e855fde0a85e71c9c345a26d094a56a5070b0bba6c1e9495bd49aa0741") {
+		return "hash_to_ec";
+	}
+	return NULL;
+}
+static void _prepare_and_release(const string &prepare_args)
+{
+	string response = _take_c_str(mymonero_prepare_tx(prepare_args.c_str()));
+	string session_id;
+	StreamingJSON::Reader reader(response);
+	string key;
+	reader.begin_object();
+	while (reader.next_key(key)) {
+		if (key == "session_id") {
+			reader.read_scalar_text(session_id);
+		} else {
+			reader.skip_value();
+		}
+	}
+	mymonero_release_send_session(session_id.c_str());
+}
+static string _address_txs_payload(const Fixture &fixture, size_t n_outputs)
+{ // a get_address_txs response: a tx receiving each output, then one spending it beside a decoy
+	n_outputs = std::min(n_outputs, fixture.outputs.size());
+	string key_images = _ret_val(emscr_KeyImage_bridge::generate_key_images(_key_images_args(fixture, n_outputs)));
+	StreamingJSON::Writer writer(n_outputs * 1200 + 256);
+	writer.begin_object();
+	writer.key("total_received").uint_string_value(n_outputs * 1000);
+	writer.key("scanned_height").uint_value(3000000);
+	writer.key("scanned_block_height").uint_value(3000000);
+	writer.key("blockchain_height").uint_value(3000010);
+	writer.key("transactions").begin_array();
+	for (size_t i = 0; i < n_outputs; ++i) {
+		const FixtureOutput &output = fixture.outputs[i];
+		writer.begin_object();
+		writer.key("id").uint_value(2 * i);
+		writer.key("hash").string_value(output.public_key);
+		writer.key("timestamp").string_value("2022-08-13T00:00:00Z");
+		writer.key("total_received").uint_string_value(1000);
+		writer.key("total_sent").uint_string_value(0);
+		writer.key("unlock_time").uint_value(0);
+		writer.key("height").uint_value(2000000 + i);
+		writer.key("mempool").bool_string_value(false);
+		writer.end_object();
+		writer.begin_object();
+		writer.key("id").uint_value(2 * i + 1);
+		writer.key("hash").string_value(output.tx_pub_key);
+		writer.key("timestamp").string_value("2022-08-14T00:00:00Z");
+		writer.key("total_received").uint_string_value(0);
+		writer.key("total_sent").uint_string_value(1500);
+		writer.key("unlock_time").uint_value(0);
+		writer.key("height").uint_value(2100000 + i);
+		writer.key("spent_outputs").begin_array();
+		for (size_t j = 0; j < 2; ++j) {
+			writer.begin_object();
+			writer.key("amount").uint_string_value(j == 0 ? 1000 : 500);
+			writer.key("key_image").string_value(j == 0 ? key_images.substr(i * 64, 64) : output.public_key); // the decoy's isn't ours
+			writer.key("tx_pub_key").string_value(output.tx_pub_key);
+			writer.key("out_index").string_value(j == 0 ? output.index : "7");
+			writer.key("mixin").uint_value(15);
+			writer.end_object();
+		}
+		writer.end_array();
+		writer.key("mempool").bool_string_value(false);
+		writer.end_object();
+	}
+	writer.end_array();
+	writer.end_object();
+	return writer.take();
+}
+//
+// Cases
+static void _add_stateless_cases(const Fixture &fixture)
+{
+	Bench::add("decodeAddress", [fixture]() {
+		Bench::do_not_optimize(serial_bridge::decode_address(fixture.address, "MAINNET"));
+	});
+	string addresses;
+	for (size_t i = 0; i < 1000; ++i) {
+		addresses.append(fixture.address).push_back('\n');
+	}
+	Bench::add("decodeAddresses/1000", [addresses]() {
+		Bench::do_not_optimize(emscr_Address_bridge::decode_addresses(addresses, "MAINNET"));
+	});
+	Bench::add("decodeAddresses/uncached", [fixture]() {
+		Addresses::DecodeCache::shared().clear();
+		Bench::do_not_optimize(emscr_Address_bridge::decode_addresses(fixture.address, "MAINNET"));
+	});
+	Bench::add("estimateTxFee", []() {
+		Bench::do_not_optimize(serial_bridge::estimated_tx_network_fee("1", "20000", "16"));
+	});
+	Bench::add("estimateFeeMatrix/120x16", []() {
+		string fees;
+		emscr_Fee_bridge::estimate_fee_matrix(
+			"{\"fee_per_b\":\"20000\",\"fork_versions\":[\"16\"],\"max_inputs\":\"120\",\"max_outputs\":\"16\"}",
+			fees
+		);
+		Bench::do_not_optimize(fees);
+	});
+	Bench::add("generateKeyImage", [fixture]() {
+		Bench::do_not_optimize(serial_bridge::generate_key_image(
+			fixture.outputs[0].tx_pub_key,
+			fixture.sec_viewKey,
+			fixture.pub_spendKey,
+			fixture.sec_spendKey,
+			fixture.outputs[0].index
+		));
+	});
+	string mnemonic = _ret_val(serial_bridge::mnemonic_from_seed(fixture.seed, "English"));
+	Bench::add("mnemonicFromSeed", [fixture]() {
+		Bench::do_not_optimize(serial_bridge::mnemonic_from_seed(fixture.seed, "English"));
+	});
+	Bench::add("seedAndKeysFromMnemonic", [mnemonic]() {
+		Bench::do_not_optimize(serial_bridge::seed_and_keys_from_mnemonic(mnemonic, "MAINNET"));
+	});
+	Bench::add("addressAndKeysFromSeed", [fixture]() {
+		Bench::do_not_optimize(serial_bridge::address_and_keys_from_seed(fixture.seed, "MAINNET"));
+	});
+}
+static void _add_crypto_cases(const Fixture &fixture)
+{ // the crypto-ops primitives which derivations, key images, CLSAG and range proofs bottom out in
+	crypto::secret_key sec_viewKey, sec_spendKey;
+	crypto::public_key tx_pub_key;
+	epee::string_tools::hex_to_pod(fixture.sec_viewKey, sec_viewKey);
+	epee::string_tools::hex_to_pod(fixture.sec_spendKey, sec_spendKey);
+	epee::string_tools::hex_to_pod(fixture.outputs[0].tx_pub_key, tx_pub_key);
+	Bench::add("crypto/scalarmultBase", [sec_spendKey]() {
+		crypto::public_key pub_key;
+		crypto::secret_key_to_public_key(sec_spendKey, pub_key);
+		Bench::do_not_optimize(epee::string_tools::pod_to_hex(pub_key));
+	});
+	Bench::add("crypto/scalarmult", [tx_pub_key, sec_viewKey]() { // as generate_key_derivation, with its mul8
+		crypto::key_derivation derivation;
+		crypto::generate_key_derivation(tx_pub_key, sec_viewKey, derivation);
+		Bench::do_not_optimize(epee::string_tools::pod_to_hex(derivation));
+	});
+	Bench::add("crypto/doubleScalarmult", [tx_pub_key, sec_viewKey, sec_spendKey]() { // as check_signature
+		ge_p3 tx_pub_key__p3;
+		ge_p2 sum;
+		crypto::public_key sum_key;
+		ge_frombytes_vartime(&tx_pub_key__p3, (const unsigned char *)&tx_pub_key);
+		ge_double_scalarmult_base_vartime(&sum, (const unsigned char *)&sec_viewKey, &tx_pub_key__p3, (const unsigned char *)&sec_spendKey);
+		ge_tobytes((unsigned char *)&sum_key, &sum);
+		Bench::do_not_optimize(epee::string_tools::pod_to_hex(sum_key));
+	});
+	Bench::add("crypto/hashToEc", [tx_pub_key]() {
+		Bench::do_not_optimize(epee::string_tools::pod_to_hex(rct::hashToPoint(rct::pk2rct(tx_pub_key))));
+	});
+}
+static void _add_wallet_cases(const Fixture &fixture)
+{
+	string key_images_args = _key_images_args(fixture, 1000);
+	Bench::add("generateKeyImages/" + fixture.name, [key_images_args]() {
+		Bench::do_not_optimize(emscr_KeyImage_bridge::generate_key_images(key_images_args));
+	});
+	string wallet_context = _ret_val(emscr_WalletContext_bridge::open_wallet_context(
+		fixture.address,
+		fixture.sec_viewKey,
+		fixture.sec_spendKey,
+		"MAINNET"
+	));
+	string scan_args = _scan_args(fixture, wallet_context);
+	Bench::add("scanOutputs/" + fixture.name, [scan_args]() {
+		Bench::do_not_optimize(emscr_OutputScanner_bridge::scan_outputs(scan_args));
+	});
+	Bench::add("scanOutputs/per-output-baseline/" + fixture.name, [fixture]() {
+		// what scanning costs through the single-output primitives: a derivation and a
+		// derive_public_key for each of the two outputs of every transaction
+		crypto::secret_key sec_viewKey;
+		crypto::public_key pub_spendKey;
+		epee::string_tools::hex_to_pod(fixture.sec_viewKey, sec_viewKey);
+		epee::string_tools::hex_to_pod(fixture.pub_spendKey, pub_spendKey);
+		size_t n_owned = 0;
+		for (const FixtureOutput &output : fixture.outputs) {
+			crypto::public_key tx_pub_key, out_pub_key, derived;
+			epee::string_tools::hex_to_pod(output.tx_pub_key, tx_pub_key);
+			epee::string_tools::hex_to_pod(output.public_key, out_pub_key);
+			for (size_t j = 0; j < 2; ++j) {
+				crypto::key_derivation derivation;
+				crypto::generate_key_derivation(tx_pub_key, sec_viewKey, derivation);
+				crypto::derive_public_key(derivation, j, pub_spendKey, derived);
+				n_owned += derived == out_pub_key ? 1 : 0;
+			}
+		}
+		Bench::do_not_optimize(std::to_string(n_owned));
+	});
+	// 25k outputs make a 50k-transaction history; key images come from the cache after the first call
+	string history_args = "{\"wallet_context\":\"" + wallet_context + "\"}";
+	string history_payload = _address_txs_payload(fixture, 25000);
+	Bench::add("parseOwnedTransactions/" + fixture.name, [history_args, history_payload]() {
+		Bench::do_not_optimize(emscr_TransactionHistory_bridge::parse_owned_transactions(history_args, history_payload));
+	});
+	// the same history as a refresh which brings nothing new, once the wallet state has applied it
+	string state_wallet_context = _ret_val(emscr_WalletContext_bridge::open_wallet_context(
+		fixture.address,
+		fixture.sec_viewKey,
+		fixture.sec_spendKey,
+		"MAINNET"
+	));
+	emscr_WalletState_bridge::apply_address_txs(state_wallet_context, history_payload);
+	Bench::add("applyAddressTxs/refresh/" + fixture.name, [state_wallet_context, history_payload]() {
+		Bench::do_not_optimize(emscr_WalletState_bridge::apply_address_txs(state_wallet_context, history_payload));
+	});
+	string prepare_args = _prepare_args(fixture);
+	Bench::add("prepareTx/" + fixture.name, [prepare_args]() {
+		_prepare_and_release(prepare_args);
+	});
+	_take_c_str(mymonero_output_index_add(_output_index_add_args(fixture, wallet_context).c_str()));
+	string output_index_prepare_args = _output_index_prepare_args(fixture, wallet_context);
+	Bench::add("prepareTx/output-index/" + fixture.name, [output_index_prepare_args]() {
+		_prepare_and_release(output_index_prepare_args);
+	});
+	vector<string> chunks = _unspent_outs_chunks(fixture, 1000);
+	string begin_args = "{\"wallet_context\":\"" + wallet_context + "\"}";
+	Bench::add("appendUnspentOuts/1000/" + fixture.name, [begin_args, chunks]() {
+		string unspent_outs_id = _ret_val(_take_c_str(mymonero_begin_unspent_outs(begin_args.c_str())));
+		for (const string &chunk : chunks) {
+			Bench::do_not_optimize(_take_c_str(mymonero_append_unspent_outs(unspent_outs_id.c_str(), chunk.c_str())));
+		}
+		Bench::do_not_optimize(_take_c_str(mymonero_finish_unspent_outs(unspent_outs_id.c_str())));
+		mymonero_release_unspent_outs(unspent_outs_id.c_str());
+	});
+	Bench::add("createAndSignTx/" + fixture.name, [fixture, prepare_args]() {
+		// prepareTx is part of the measured call since each session signs once
+		string response = _take_c_str(mymonero_prepare_tx(prepare_args.c_str()));
+		string random_outs_args = _random_outs_args(fixture, response);
+		Bench::do_not_optimize(_take_c_str(mymonero_create_and_sign_tx(random_outs_args.c_str())));
+	});
+	string verified_prepare_args = "{\"verify_before_return\":true," + prepare_args.substr(1);
+	Bench::add("createAndSignTx/verified/" + fixture.name, [fixture, verified_prepare_args]() {
+		string response = _take_c_str(mymonero_prepare_tx(verified_prepare_args.c_str()));
+		string random_outs_args = _random_outs_args(fixture, response);
+		Bench::do_not_optimize(_take_c_str(mymonero_create_and_sign_tx(random_outs_args.c_str())));
+	});
+}
+//
+int main(int argc, char **argv)
+{
+	string filter;
+	string fixtures_dir = "bench/fixtures";
+	uint64_t min_time_ms = 500;
+	for (int i = 1; i < argc; ++i) {
+		string arg = argv[i];
+		if (arg == "--fixtures" && i + 1 < argc) {
+			fixtures_dir = argv[++i];
+		} else if (arg == "--min-time" && i + 1 < argc) {
+			min_time_ms = strtoull(argv[++i], NULL, 10);
+		} else {
+			filter = arg;
+		}
+	}
+	const char *names[][2] = { { "10", "10" }, { "1000", "1k" }, { "100000", "100k" } };
+	vector<Fixture> fixtures;
+	for (const auto &name : names) {
+		Fixture fixture;
+		string path = fixtures_dir + "/wallet-" + name[0] + ".json";
+		if (!_load_fixture(path, name[1], fixture)) {
+			fprintf(stderr, "Skipping missing fixture %s (run mymonero_client_bench_fixtures)\n", path.c_str());
+			continue;
+		}
+		fixtures.push_back(std::move(fixture));
+	}
+	if (fixtures.empty()) {
+		fprintf(stderr, "No fixtures found in %s\n", fixtures_dir.c_str());
+		return 1;
+	}
+	const char *failed_primitive = _failed_crypto_vector();
+	if (failed_primitive != NULL) {
+		fprintf(stderr, "crypto-ops disagrees with the known answer of %s\n", failed_primitive);
+		return 1;
+	}
+	_add_stateless_cases(fixtures.front());
+	_add_crypto_cases(fixtures.front());
+	for (const Fixture &fixture : fixtures) {
+		_add_wallet_cases(fixture);
+	}
+	Bench::print(Bench::run(filter, min_time_ms));
+	//
+	return 0;
+}
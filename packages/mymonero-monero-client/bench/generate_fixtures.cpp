@@ -0,0 +1,198 @@
+//
+//  generate_fixtures.cpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+//
+// Writes the fixture wallets used by the benchmarks: <dir>/wallet-<n>.json for n outputs.
+//
+// Outputs are real outputs of the test wallet below (the one in test/unit/WABridge.spec.js),
+// with RingCT v2 commitments and encrypted amounts, so prepareTx and createAndSignTx go through
+// the same decryption and signing work as for a live wallet. Everything is derived from
+// counters, so the files are identical from run to run.
+//
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <fstream>
+//
+#include "crypto.h"
+#include "string_tools.h"
+#include "ringct/rctOps.h"
+#include "StreamingJSON.hpp"
+//
+using namespace std;
+//
+static const char *wallet__address = "43zxvpcj5Xv9SEkNXbMCG7LPQStHMpFCQCmkmR4u5nzjWwq5Xkv5VmGgYEsHXg4ja2FGRD5wMWbBVMijDTqmmVqm93wHGkg";
+static const char *wallet__seed = "9c973aa296b79bbf452781dd3d32ad7f";
+static const char *wallet__sec_viewKey = "7bea1907940afdd480eff7c4bcadb478a0fbb626df9e3ed74ae801e18f53e104";
+static const char *wallet__pub_viewKey = "080a6e9b17de47ec62c8a1efe0640b554a2cde7204b9b07bdf9bd225eeeb1c47";
+static const char *wallet__sec_spendKey = "4e6d43cd03812b803c6f3206689f5fcc910005fc7e91d50d79b0776dbefcd803";
+static const char *wallet__pub_spendKey = "3eb884d3440d71326e27cc07a861b873e72abd339feb654660c36a008a0028b3";
+//
+static const size_t decoys__count = 16 * 64; // enough for a 64-input transaction at ring size 16
+static const uint64_t output__base_amount = 10000000000; // 0.01 XMR
+//
+// Accessory functions
+static crypto::secret_key _scalar_from(const char *domain, uint64_t counter)
+{
+	string buf(domain);
+	buf.append((const char *)&counter, sizeof(counter));
+	crypto::secret_key scalar;
+	crypto::hash_to_scalar(buf.data(), buf.size(), scalar);
+	return scalar;
+}
+static crypto::public_key _point_from(const char *domain, uint64_t counter)
+{
+	crypto::public_key point;
+	crypto::secret_key_to_public_key(_scalar_from(domain, counter), point);
+	return point;
+}
+static uint64_t _output_amount(size_t i)
+{
+	return output__base_amount + (uint64_t)(i % 97) * 100000000;
+}
+//
+static void _write_wallet(StreamingJSON::Writer &writer)
+{
+	writer.key("wallet").begin_object();
+	writer.key("address").string_value(wallet__address);
+	writer.key("seed").string_value(wallet__seed);
+	writer.key("sec_viewKey").string_value(wallet__sec_viewKey);
+	writer.key("pub_viewKey").string_value(wallet__pub_viewKey);
+	writer.key("sec_spendKey").string_value(wallet__sec_spendKey);
+	writer.key("pub_spendKey").string_value(wallet__pub_spendKey);
+	writer.key("nettype").string_value("MAINNET");
+	writer.end_object();
+}
+static void _write_output(
+	StreamingJSON::Writer &writer,
+	size_t i,
+	const crypto::public_key &pub_viewKey,
+	const crypto::public_key &pub_spendKey
+) {
+	crypto::secret_key tx_sec_key = _scalar_from("bench-tx", i);
+	crypto::public_key tx_pub_key;
+	crypto::secret_key_to_public_key(tx_sec_key, tx_pub_key);
+	crypto::key_derivation derivation;
+	crypto::generate_key_derivation(pub_viewKey, tx_sec_key, derivation);
+	size_t out_index = i % 2;
+	crypto::public_key out_pub_key;
+	crypto::derive_public_key(derivation, out_index, pub_spendKey, out_pub_key);
+	crypto::ec_scalar shared_scalar;
+	crypto::derivation_to_scalar(derivation, out_index, shared_scalar);
+	//
+	uint64_t amount = _output_amount(i);
+	rct::key shared_secret = rct::sk2rct((const crypto::secret_key &)shared_scalar);
+	rct::key commitment = rct::commit(amount, rct::genCommitmentMask(shared_secret));
+	rct::ecdhTuple ecdh_info{ rct::zero(), rct::d2h(amount) };
+	rct::ecdhEncode(ecdh_info, shared_secret, true);
+	string rct_string = epee::string_tools::pod_to_hex(commitment);
+	rct_string += epee::string_tools::pod_to_hex(ecdh_info.amount).substr(0, 16);
+	//
+	writer.begin_object();
+	writer.key("amount").uint_string_value(amount);
+	writer.key("public_key").string_value(epee::string_tools::pod_to_hex(out_pub_key));
+	writer.key("index").uint_string_value(out_index);
+	writer.key("global_index").uint_string_value(1000000 + i * 37);
+	writer.key("rct").string_value(rct_string);
+	writer.key("tx_id").uint_string_value(i);
+	writer.key("tx_hash").string_value(epee::string_tools::pod_to_hex(_point_from("bench-tx-hash", i)));
+	writer.key("tx_prefix_hash").string_value(epee::string_tools::pod_to_hex(_point_from("bench-tx-prefix-hash", i)));
+	writer.key("tx_pub_key").string_value(epee::string_tools::pod_to_hex(tx_pub_key));
+	writer.key("timestamp").string_value("2022-01-01T00:00:00Z");
+	writer.key("height").uint_string_value(2500000 + i / 4);
+	writer.key("spend_key_images").begin_array();
+	if (i % 4 == 0) { // a candidate which isn't ours, so that the spent check has work to do
+		writer.string_value(epee::string_tools::pod_to_hex(_point_from("bench-foreign-key-image", i)));
+	}
+	writer.end_array();
+	writer.end_object();
+}
+static void _write_decoy(StreamingJSON::Writer &writer, size_t j)
+{
+	rct::key commitment = rct::commit(output__base_amount + j, rct::sk2rct(_scalar_from("bench-decoy-mask", j)));
+	writer.begin_object();
+	writer.key("global_index").uint_string_value(5000000 + j * 11);
+	writer.key("public_key").string_value(epee::string_tools::pod_to_hex(_point_from("bench-decoy", j)));
+	writer.key("rct").string_value(epee::string_tools::pod_to_hex(commitment));
+	writer.end_object();
+}
+static bool _write_fixture(const string &path, size_t n_outputs)
+{
+	crypto::public_key pub_viewKey, pub_spendKey;
+	epee::string_tools::hex_to_pod(wallet__pub_viewKey, pub_viewKey);
+	epee::string_tools::hex_to_pod(wallet__pub_spendKey, pub_spendKey);
+	//
+	StreamingJSON::Writer writer(n_outputs * 700 + decoys__count * 200);
+	writer.begin_object();
+	_write_wallet(writer);
+	uint64_t total = 0;
+	for (size_t i = 0; i < n_outputs; ++i) {
+		total += _output_amount(i);
+	}
+	writer.key("unspentOuts").begin_object();
+	writer.key("amount").uint_string_value(total);
+	writer.key("per_byte_fee").uint_string_value(20000);
+	writer.key("fee_mask").uint_string_value(10000);
+	writer.key("fork_version").uint_string_value(16);
+	writer.key("outputs").begin_array();
+	for (size_t i = 0; i < n_outputs; ++i) {
+		_write_output(writer, i, pub_viewKey, pub_spendKey);
+	}
+	writer.end_array();
+	writer.end_object();
+	writer.key("decoys").begin_array();
+	for (size_t j = 0; j < decoys__count; ++j) {
+		_write_decoy(writer, j);
+	}
+	writer.end_array();
+	// about two outputs' worth, so a send selects a couple of inputs whatever the wallet size
+	writer.key("send_amount").string_value(n_outputs > 1 ? "0.015" : "0.005");
+	writer.end_object();
+	//
+	ofstream file(path, ios::binary);
+	file << writer.str();
+	return file.good();
+}
+//
+int main(int argc, char **argv)
+{
+	string dir = argc > 1 ? argv[1] : "bench/fixtures";
+	const size_t sizes[] = { 10, 1000, 100000 };
+	for (size_t n_outputs : sizes) {
+		string path = dir + "/wallet-" + std::to_string(n_outputs) + ".json";
+		if (!_write_fixture(path, n_outputs)) {
+			fprintf(stderr, "Unable to write %s\n", path.c_str());
+			return 1;
+		}
+		printf("Wrote %s\n", path.c_str());
+	}
+	return 0;
+}
@@ -0,0 +1,117 @@
+'use strict'
+
+// Measures the startup of each WASM build: download size, and the time a fresh node process takes
+// to load, compile and instantiate the module, then make its first call. For the full builds, also
+// the time warmUpProofs takes to build the range proof tables which the first send would otherwise.
+//
+//   node bench/run-startup.js [filter] [--runs <n>]
+//
+// Every run is a new process so nothing is cached between runs; the median is reported. Node
+// compiles from a buffer - in a browser the external .wasm is also compiled while it downloads.
+const childProcess = require('child_process')
+const fs = require('fs')
+const path = require('path')
+
+const ADDRESS = '43zxvpcj5Xv9SEkNXbMCG7LPQStHMpFCQCmkmR4u5nzjWwq5Xkv5VmGgYEsHXg4ja2FGRD5wMWbBVMijDTqmmVqm93wHGkg'
+const BUILDS = [
+  ['address', 'MyMoneroClient_WASM_Address', { variant: 'address' }],
+  ['scan', 'MyMoneroClient_WASM_Scan', { variant: 'scan' }],
+  ['full', 'MyMoneroClient_WASM', { variant: 'full', threads: false, warmUp: false }],
+  ['full-mt', 'MyMoneroClient_WASM_MT', { variant: 'full', warmUp: false }]
+]
+
+function parseArgs (argv) {
+  const args = { filter: '', runs: 15 }
+  for (let i = 0; i < argv.length; i++) {
+    if (argv[i] === '--runs') {
+      args.runs = parseInt(argv[++i])
+    } else {
+      args.filter = argv[i]
+    }
+  }
+  return args
+}
+
+function fileSize (file) {
+  return fs.existsSync(file) ? fs.statSync(file).size : 0
+}
+
+// Runs in the child process: times one load and first call, and writes them to stdout as JSON
+async function measure (options) {
+  const start = process.hrtime.bigint()
+  const loadBridge = require('../src/index')
+  const bridge = await loadBridge(options)
+  const loaded = process.hrtime.bigint()
+  bridge.decodeAddress(ADDRESS, 'MAINNET')
+  const called = process.hrtime.bigint()
+  let warmUpNs = 0
+  if (options.variant === 'full') {
+    bridge.warmUpProofs(false)
+    warmUpNs = Number(process.hrtime.bigint() - called)
+  }
+  process.stdout.write(JSON.stringify({
+    loadNs: Number(loaded - start),
+    firstCallNs: Number(called - loaded),
+    warmUpNs: warmUpNs,
+    heapBytes: bridge.Module.HEAPU8.length
+  }))
+  process.exit(0)
+}
+
+function median (values) {
+  const sorted = values.slice().sort((a, b) => a - b)
+  return sorted[Math.floor(sorted.length / 2)]
+}
+
+function run (options) {
+  const stdout = childProcess.execFileSync(process.execPath, [__filename, '--child', JSON.stringify(options)])
+  return JSON.parse(stdout.toString())
+}
+
+function print (results) {
+  const pad = (str, width) => ('' + str).padStart(width)
+  console.log('name'.padEnd(12) + pad('.js B', 12) + pad('.wasm B', 12) + pad('load ms', 12) + pad('first call ms', 16) + pad('warm-up ms', 12) + pad('heap B', 14))
+  for (const result of results) {
+    console.log(result.name.padEnd(12) + pad(result.jsBytes, 12) + pad(result.wasmBytes, 12) + pad((result.loadNs / 1e6).toFixed(1), 12) +
+      pad((result.firstCallNs / 1e6).toFixed(2), 16) + pad(result.warmUpNs ? (result.warmUpNs / 1e6).toFixed(1) : '-', 12) + pad(result.heapBytes, 14))
+  }
+}
+
+function main () {
+  const args = parseArgs(process.argv.slice(2))
+  const srcDir = path.join(__dirname, '..', 'src')
+  const results = []
+  for (const [name, file, options] of BUILDS) {
+    if (!name.includes(args.filter)) {
+      continue
+    }
+    const jsFile = path.join(srcDir, file + '.js')
+    if (!fs.existsSync(jsFile)) {
+      console.error('Skipping missing build ' + jsFile + ' (run npm run build)')
+      continue
+    }
+    const runs = []
+    for (let i = 0; i < args.runs; i++) {
+      runs.push(run(options))
+    }
+    results.push({
+      name: name,
+      jsBytes: fileSize(jsFile),
+      wasmBytes: fileSize(path.join(srcDir, file + '.wasm')),
+      loadNs: median(runs.map(r => r.loadNs)),
+      firstCallNs: median(runs.map(r => r.firstCallNs)),
+      warmUpNs: median(runs.map(r => r.warmUpNs)),
+      heapBytes: median(runs.map(r => r.heapBytes))
+    })
+  }
+  print(results)
+}
+
+if (process.argv[2] === '--child') {
+  measure(JSON.parse(process.argv[3])).catch(function (e) {
+    console.error(e)
+    process.exit(1)
+  })
+} else {
+  main()
+}
@@ -0,0 +1,185 @@
+'use strict'
+
+// Benchmarks the WASM bridge functions through WABridge, over the fixture wallets written by
+// the native mymonero_client_bench_fixtures (see `npm run bench:native`).
+//
+//   node bench/run-wasm.js [filter] [--fixtures <dir>] [--min-time <ms>] [--no-threads]
+//
+// Reports ns/op and the growth of WASM linear memory over the run of each case. Linear memory
+// never shrinks, so growth is the high-water mark the case pushed the heap to.
+const fs = require('fs')
+const path = require('path')
+const loadBridge = require('../src/index')
+
+const RING_SIZE = 16
+const FIXTURES = [['10', '10'], ['1000', '1k'], ['100000', '100k']]
+
+function parseArgs (argv) {
+  const args = { filter: '', fixturesDir: path.join(__dirname, 'fixtures'), minTimeMs: 500, threads: true }
+  for (let i = 0; i < argv.length; i++) {
+    if (argv[i] === '--fixtures') {
+      args.fixturesDir = argv[++i]
+    } else if (argv[i] === '--min-time') {
+      args.minTimeMs = parseInt(argv[++i])
+    } else if (argv[i] === '--no-threads') {
+      args.threads = false
+    } else {
+      args.filter = argv[i]
+    }
+  }
+  return args
+}
+
+function loadFixtures (dir) {
+  const fixtures = []
+  for (const [size, name] of FIXTURES) {
+    const file = path.join(dir, 'wallet-' + size + '.json')
+    if (!fs.existsSync(file)) {
+      console.error('Skipping missing fixture ' + file + ' (run npm run bench:native)')
+      continue
+    }
+    fixtures.push(Object.assign({ name: name }, JSON.parse(fs.readFileSync(file, 'utf8'))))
+  }
+  return fixtures
+}
+
+function randomOutsCb (fixture) {
+  return function (numberOfOuts) {
+    const amountOuts = []
+    let next = 0
+    for (let i = 0; i < numberOfOuts; i++) {
+      const outputs = []
+      for (let j = 0; j < RING_SIZE; j++) {
+        outputs.push(fixture.decoys[next++ % fixture.decoys.length])
+      }
+      amountOuts.push({ amount: '0', outputs: outputs })
+    }
+    return Promise.resolve({ amount_outs: amountOuts })
+  }
+}
+
+function transactionOptions (fixture, useWireFormat) {
+  return {
+    destinations: [{ to_address: fixture.wallet.address, send_amount: fixture.send_amount }],
+    shouldSweep: false,
+    address: fixture.wallet.address,
+    privateViewKey: fixture.wallet.sec_viewKey,
+    publicSpendKey: fixture.wallet.pub_spendKey,
+    privateSpendKey: fixture.wallet.sec_spendKey,
+    priority: 1,
+    nettype: fixture.wallet.nettype,
+    unspentOuts: fixture.unspentOuts,
+    randomOutsCb: randomOutsCb(fixture),
+    useWireFormat: useWireFormat
+  }
+}
+
+// A get_address_txs response: a tx receiving each output, then one spending it beside a decoy
+function addressTxsPayload (bridge, fixture, nOutputs) {
+  const wallet = fixture.wallet
+  const outputs = fixture.unspentOuts.outputs.slice(0, nOutputs)
+  const keyImages = bridge.generateKeyImages(wallet.sec_viewKey, wallet.pub_spendKey, wallet.sec_spendKey, outputs.map(function (output) {
+    return { txPublicKey: output.tx_pub_key, outputIndex: output.index }
+  }))
+  const transactions = []
+  outputs.forEach(function (output, i) {
+    transactions.push({ id: 2 * i, hash: output.public_key, total_received: '1000', total_sent: '0', height: 2000000 + i, mempool: false })
+    transactions.push({
+      id: 2 * i + 1,
+      hash: output.tx_pub_key,
+      total_received: '0',
+      total_sent: '1500',
+      height: 2100000 + i,
+      spent_outputs: [
+        { amount: '1000', key_image: keyImages[i], tx_pub_key: output.tx_pub_key, out_index: output.index, mixin: 15 },
+        { amount: '500', key_image: output.public_key, tx_pub_key: output.tx_pub_key, out_index: 7, mixin: 15 }
+      ],
+      mempool: false
+    })
+  })
+  return JSON.stringify({ scanned_height: 3000000, scanned_block_height: 3000000, blockchain_height: 3000010, transactions: transactions })
+}
+
+function addCases (cases, bridge, fixtures) {
+  const wallet = fixtures[0].wallet
+  const output = fixtures[0].unspentOuts.outputs[0]
+  const mnemonic = bridge.mnemonicFromSeed(wallet.seed, 'English')
+  cases.push(['decodeAddress', () => bridge.decodeAddress(wallet.address, wallet.nettype)])
+  const addresses = new Array(1000).fill(wallet.address)
+  cases.push(['decodeAddresses/1000', () => bridge.decodeAddresses(addresses, wallet.nettype)])
+  cases.push(['estimateTxFee', () => bridge.estimateTxFee(1, 20000, 16)])
+  cases.push(['estimateFeeMatrix/120x16', () => bridge.estimateFeeMatrix(20000, { maxInputs: 120, maxOutputs: 16, forkVersions: [16] })])
+  cases.push(['generateKeyImage', () => bridge.generateKeyImage(output.tx_pub_key, wallet.sec_viewKey, wallet.pub_spendKey, wallet.sec_spendKey, output.index)])
+  cases.push(['mnemonicFromSeed', () => bridge.mnemonicFromSeed(wallet.seed, 'English')])
+  cases.push(['seedAndKeysFromMnemonic', () => bridge.seedAndKeysFromMnemonic(mnemonic, wallet.nettype)])
+  cases.push(['addressAndKeysFromSeed', () => bridge.addressAndKeysFromSeed(wallet.seed, wallet.nettype)])
+  for (const fixture of fixtures) {
+    const outputs = fixture.unspentOuts.outputs.slice(0, 1000).map(function (output) {
+      return { txPublicKey: output.tx_pub_key, outputIndex: output.index }
+    })
+    cases.push(['generateKeyImages/' + fixture.name, () => bridge.generateKeyImages(wallet.sec_viewKey, wallet.pub_spendKey, wallet.sec_spendKey, outputs)])
+    const payload = addressTxsPayload(bridge, fixture, 25000)
+    const historyWallet = { address: fixture.wallet.address, privateViewKey: fixture.wallet.sec_viewKey, publicSpendKey: fixture.wallet.pub_spendKey, privateSpendKey: fixture.wallet.sec_spendKey }
+    cases.push(['parseOwnedTransactions/' + fixture.name, () => bridge.parseOwnedTransactions(payload, historyWallet)])
+    // a refresh which brings nothing new, once the wallet state has applied the history
+    const stateWalletContext = bridge.openWalletContext(fixture.wallet.address, fixture.wallet.sec_viewKey, fixture.wallet.sec_spendKey, fixture.wallet.nettype)
+    bridge.applyAddressTxs(stateWalletContext, payload)
+    cases.push(['applyAddressTxs/refresh/' + fixture.name, () => bridge.applyAddressTxs(stateWalletContext, payload)])
+    cases.push(['createTransaction/json/' + fixture.name, () => bridge.createTransaction(transactionOptions(fixture, false))])
+    cases.push(['createTransaction/wire/' + fixture.name, () => bridge.createTransaction(transactionOptions(fixture, true))])
+    cases.push(['createTransaction/verified/' + fixture.name, () => bridge.createTransaction(Object.assign(transactionOptions(fixture, true), { verifyBeforeReturn: true }))])
+  }
+}
+
+async function runCase (bridge, name, fn, minTimeMs) {
+  await fn() // warm-up, which also grows the heap to what the case needs
+  const heapBefore = bridge.Module.HEAPU8.length
+  const minTimeNs = BigInt(minTimeMs) * 1000000n
+  let iterations = 0
+  const start = process.hrtime.bigint()
+  let elapsed = 0n
+  while (elapsed < minTimeNs) {
+    await fn()
+    iterations++
+    elapsed = process.hrtime.bigint() - start
+  }
+  return {
+    name: name,
+    iterations: iterations,
+    nsPerOp: Number(elapsed) / iterations,
+    heapGrowth: bridge.Module.HEAPU8.length - heapBefore,
+    heapBytes: bridge.Module.HEAPU8.length
+  }
+}
+
+function print (results) {
+  const pad = (str, width) => ('' + str).padStart(width)
+  console.log('name'.padEnd(32) + pad('iterations', 12) + pad('ns/op', 16) + pad('heap growth B', 16) + pad('heap B', 14))
+  for (const result of results) {
+    console.log(result.name.padEnd(32) + pad(result.iterations, 12) + pad(result.nsPerOp.toFixed(0), 16) + pad(result.heapGrowth, 16) + pad(result.heapBytes, 14))
+  }
+}
+
+async function main () {
+  const args = parseArgs(process.argv.slice(2))
+  const fixtures = loadFixtures(args.fixturesDir)
+  if (fixtures.length === 0) {
+    console.error('No fixtures found in ' + args.fixturesDir)
+    process.exit(1)
+  }
+  const bridge = await loadBridge({ threads: args.threads })
+  const cases = []
+  addCases(cases, bridge, fixtures)
+  const results = []
+  for (const [name, fn] of cases) {
+    if (name.includes(args.filter)) {
+      results.push(await runCase(bridge, name, fn, args.minTimeMs))
+    }
+  }
+  print(results)
+}
+
+main().catch(function (e) {
+  console.error(e)
+  process.exit(1)
+})
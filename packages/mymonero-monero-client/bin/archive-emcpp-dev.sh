@@ -1,6 +1,7 @@
 #!/bin/sh
 
 bin/build-emcpp-dev.sh &&
-cp build/MyMoneroClient_WASM.js src/; 
-cp build/MyMoneroClient_WASM.wasm src/;
-cp build/MyMoneroClient_WASM.wasm.map src/;
\ No newline at end of file
+for target in MyMoneroClient_WASM MyMoneroClient_WASM_Scan MyMoneroClient_WASM_Address MyMoneroClient_WASM_MT; do
+    cp build/$target.js build/$target.wasm build/$target.wasm.map src/;
+done;
+cp build/MyMoneroClient_WASM_MT.worker.js src/;
@@ -1,5 +1,9 @@
 #!/bin/sh
 
 bin/build-emcpp.sh &&
-cp build/MyMoneroClient_WASM.js src/; 
-#cp build/MyMoneroClient_WASM.wasm src/;
\ No newline at end of file
+for target in MyMoneroClient_WASM MyMoneroClient_WASM_Scan MyMoneroClient_WASM_Address MyMoneroClient_WASM_MT; do
+    cp build/$target.js src/;
+    # absent when built with -DMYMONERO_CLIENT_SINGLE_FILE=ON
+    [ ! -f build/$target.wasm ] || cp build/$target.wasm src/;
+done;
+cp build/MyMoneroClient_WASM_MT.worker.js src/;
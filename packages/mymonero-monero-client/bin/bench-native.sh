@@ -0,0 +1,12 @@
+#!/bin/sh
+# Builds the native benchmarks, writes the fixture wallets on first use and runs every case
+# whose name contains $1 (all when omitted).
+
+mkdir -p build-native &&
+cd build-native &&
+cmake .. -DCMAKE_BUILD_TYPE=Release -DMYMONERO_CLIENT_BENCHMARKS=ON &&
+cmake --build . --target mymonero_client_bench mymonero_client_bench_fixtures -- -j4 &&
+cd .. &&
+mkdir -p bench/fixtures &&
+{ [ -f bench/fixtures/wallet-100000.json ] || ./build-native/mymonero_client_bench_fixtures bench/fixtures; } &&
+./build-native/mymonero_client_bench "$@" --fixtures bench/fixtures
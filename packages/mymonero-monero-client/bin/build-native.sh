@@ -0,0 +1,6 @@
+#!/bin/sh
+
+mkdir -p build-native && 
+cd build-native && 
+cmake .. -DCMAKE_BUILD_TYPE=Release && 
+cmake --build . -- -j4
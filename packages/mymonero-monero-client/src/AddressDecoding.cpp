@@ -0,0 +1,235 @@
+//
+//  AddressDecoding.cpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#include "AddressDecoding.hpp"
+//
+using namespace std;
+using namespace Addresses;
+//
+// Constants
+static const char base58__alphabet[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+static const size_t base58__full_block_size = 8;
+static const size_t base58__full_encoded_block_size = 11;
+static const int base58__decoded_block_sizes[base58__full_encoded_block_size + 1] = { 0, -1, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8 }; // by encoded size
+static const size_t address__checksum_size = 4;
+static const size_t address__keys_size = 2 * sizeof(crypto::public_key);
+//
+// Accessory functions
+struct _Base58ReverseTable
+{
+	int8_t digits[256];
+	_Base58ReverseTable()
+	{
+		memset(digits, -1, sizeof(digits));
+		for (size_t i = 0; i < sizeof(base58__alphabet) - 1; ++i) {
+			digits[(uint8_t)base58__alphabet[i]] = (int8_t)i;
+		}
+	}
+};
+static const _Base58ReverseTable base58__reverse_table;
+//
+static bool _decode_block(const char *block, size_t encoded_size, uint8_t *out__decoded)
+{
+	int decoded_size = base58__decoded_block_sizes[encoded_size];
+	if (decoded_size <= 0) {
+		return false;
+	}
+	uint64_t value = 0;
+	for (size_t i = 0; i < encoded_size; ++i) {
+		int8_t digit = base58__reverse_table.digits[(uint8_t)block[i]];
+		if (digit < 0) {
+			return false;
+		}
+		// 58^10 < 2^64 - only the eleventh digit of a full block can overflow
+		if (i == base58__full_encoded_block_size - 1 && value > (UINT64_MAX - (uint64_t)digit) / 58) {
+			return false;
+		}
+		value = value * 58 + (uint64_t)digit;
+	}
+	if ((size_t)decoded_size < base58__full_block_size && (value >> (8 * decoded_size)) != 0) {
+		return false;
+	}
+	for (int i = decoded_size - 1; i >= 0; --i) { // big-endian
+		out__decoded[i] = (uint8_t)(value & 0xff);
+		value >>= 8;
+	}
+	return true;
+}
+static bool _read_varint(const uint8_t *data, size_t size, uint64_t &out__value, size_t &out__read)
+{
+	uint64_t value = 0;
+	for (size_t i = 0; i < size && i < 10; ++i) {
+		value |= (uint64_t)(data[i] & 0x7f) << (7 * i);
+		if ((data[i] & 0x80) == 0) {
+			out__value = value;
+			out__read = i + 1;
+			return true;
+		}
+	}
+	return false;
+}
+//
+// Base58
+bool Addresses::base58_decode(const char *encoded, size_t encoded_size, uint8_t *out__decoded, size_t &out__size)
+{
+	size_t n_full_blocks = encoded_size / base58__full_encoded_block_size;
+	size_t last_block_size = encoded_size % base58__full_encoded_block_size;
+	int last_block_decoded_size = base58__decoded_block_sizes[last_block_size];
+	if (last_block_decoded_size < 0) {
+		return false;
+	}
+	size_t decoded_size = n_full_blocks * base58__full_block_size + (size_t)last_block_decoded_size;
+	if (decoded_size > base58__max_decoded_size) {
+		return false;
+	}
+	for (size_t i = 0; i < n_full_blocks; ++i) {
+		if (!_decode_block(encoded + i * base58__full_encoded_block_size, base58__full_encoded_block_size, out__decoded + i * base58__full_block_size)) {
+			return false;
+		}
+	}
+	if (last_block_size > 0) {
+		if (!_decode_block(encoded + n_full_blocks * base58__full_encoded_block_size, last_block_size, out__decoded + n_full_blocks * base58__full_block_size)) {
+			return false;
+		}
+	}
+	out__size = decoded_size;
+	return true;
+}
+//
+// Addresses
+bool Addresses::decode(const string &address, cryptonote::network_type nettype, cryptonote::address_parse_info &out__info)
+{
+	uint8_t decoded[base58__max_decoded_size];
+	size_t decoded_size = 0;
+	if (!base58_decode(address.data(), address.size(), decoded, decoded_size)) {
+		return false;
+	}
+	if (decoded_size <= address__checksum_size) {
+		return false;
+	}
+	size_t payload_size = decoded_size - address__checksum_size;
+	crypto::hash checksum = crypto::cn_fast_hash(decoded, payload_size);
+	if (memcmp(checksum.data, decoded + payload_size, address__checksum_size) != 0) {
+		return false;
+	}
+	uint64_t tag = 0;
+	size_t tag_size = 0;
+	if (!_read_varint(decoded, payload_size, tag, tag_size)) {
+		return false;
+	}
+	const cryptonote::config_t &config = cryptonote::get_config(nettype);
+	bool is_subaddress = false;
+	bool has_payment_id = false;
+	if (tag == config.CRYPTONOTE_PUBLIC_INTEGRATED_ADDRESS_BASE58_PREFIX) {
+		has_payment_id = true;
+	} else if (tag == config.CRYPTONOTE_PUBLIC_SUBADDRESS_BASE58_PREFIX) {
+		is_subaddress = true;
+	} else if (tag != config.CRYPTONOTE_PUBLIC_ADDRESS_BASE58_PREFIX) {
+		return false;
+	}
+	size_t expected_size = tag_size + address__keys_size + (has_payment_id ? sizeof(crypto::hash8) : 0);
+	if (payload_size != expected_size) {
+		return false;
+	}
+	const uint8_t *cursor = decoded + tag_size;
+	cryptonote::address_parse_info info{};
+	memcpy(info.address.m_spend_public_key.data, cursor, sizeof(crypto::public_key));
+	cursor += sizeof(crypto::public_key);
+	memcpy(info.address.m_view_public_key.data, cursor, sizeof(crypto::public_key));
+	cursor += sizeof(crypto::public_key);
+	if (has_payment_id) {
+		memcpy(info.payment_id.data, cursor, sizeof(crypto::hash8));
+	}
+	if (!crypto::check_key(info.address.m_spend_public_key) || !crypto::check_key(info.address.m_view_public_key)) {
+		return false;
+	}
+	info.is_subaddress = is_subaddress;
+	info.has_payment_id = has_payment_id;
+	out__info = info;
+	//
+	return true;
+}
+//
+// DecodeCache - Lifecycle - Init
+DecodeCache &DecodeCache::shared()
+{
+	static DecodeCache cache;
+	return cache;
+}
+//
+// DecodeCache - Imperatives
+bool DecodeCache::decode(const string &address, cryptonote::network_type nettype, cryptonote::address_parse_info &out__info)
+{
+	string key;
+	key.reserve(address.size() + 1);
+	key.push_back((char)nettype);
+	key.append(address);
+	{
+		lock_guard<mutex> lock(this->m);
+		auto found = this->entries_by_key.find(key);
+		if (found != this->entries_by_key.end()) {
+			this->entries.splice(this->entries.begin(), this->entries, found->second);
+			out__info = found->second->info;
+			return true;
+		}
+	}
+	cryptonote::address_parse_info info;
+	if (!Addresses::decode(address, nettype, info)) { // decoded outside of the lock
+		return false;
+	}
+	out__info = info;
+	lock_guard<mutex> lock(this->m);
+	if (this->capacity == 0 || this->entries_by_key.find(key) != this->entries_by_key.end()) {
+		return true;
+	}
+	if (this->entries.size() >= this->capacity) {
+		this->entries_by_key.erase(this->entries.back().key);
+		this->entries.pop_back();
+	}
+	this->entries.push_front(Entry{ key, info });
+	this->entries_by_key.emplace(std::move(key), this->entries.begin());
+	//
+	return true;
+}
+void DecodeCache::clear()
+{
+	lock_guard<mutex> lock(this->m);
+	this->entries_by_key.clear();
+	this->entries.clear();
+}
+//
+// DecodeCache - Accessors
+size_t DecodeCache::size() const
+{
+	lock_guard<mutex> lock(this->m);
+	return this->entries.size();
+}
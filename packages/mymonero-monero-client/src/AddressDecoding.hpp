@@ -0,0 +1,95 @@
+//
+//  AddressDecoding.hpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#ifndef AddressDecoding_hpp
+#define AddressDecoding_hpp
+
+#include <string>
+#include <list>
+#include <mutex>
+#include <cstdint>
+#include <unordered_map>
+#include "crypto.h"
+#include "cryptonote_config.h"
+#include "cryptonote_basic_impl.h"
+
+namespace Addresses
+{
+	using namespace std;
+	//
+	// Decodes a standard, sub- or integrated address of `nettype`, as
+	// cryptonote::get_account_address_from_str does: base58, prefix, Keccak checksum and a
+	// check that both keys are points. The base58 blocks are decoded straight into a stack
+	// buffer with Horner's rule and a table lookup per character, so nothing is allocated.
+	bool decode(const string &address, cryptonote::network_type nettype, cryptonote::address_parse_info &out__info);
+	//
+	// Base58 - monero's 8-byte / 11-character block variant; false on any invalid character,
+	// block length or overflow. out__size is set to the number of bytes written.
+	static const size_t base58__max_decoded_size = 128;
+	bool base58_decode(const char *encoded, size_t encoded_size, uint8_t *out__decoded, size_t &out__size);
+	//
+	// A bounded LRU of decoded addresses, keyed by (nettype, address). Shared by the send path
+	// and the batch decode so that repeat recipients are only decoded once.
+	//
+	class DecodeCache
+	{
+	public:
+		static const size_t default_capacity = 4096;
+		//
+		// Lifecycle - Init
+		DecodeCache(size_t capacity = default_capacity) : capacity(capacity) {}
+		DecodeCache(const DecodeCache &) = delete;
+		DecodeCache &operator=(const DecodeCache &) = delete;
+		//
+		static DecodeCache &shared();
+		//
+		// Imperatives
+		// As decode(), answered from the cache when possible. Invalid addresses aren't cached.
+		bool decode(const string &address, cryptonote::network_type nettype, cryptonote::address_parse_info &out__info);
+		void clear();
+		//
+		// Accessors
+		size_t size() const;
+	private:
+		struct Entry
+		{
+			string key;
+			cryptonote::address_parse_info info;
+		};
+		mutable mutex m;
+		size_t capacity;
+		list<Entry> entries; // most recently used first
+		unordered_map<string, list<Entry>::iterator> entries_by_key;
+	};
+}
+
+#endif /* AddressDecoding_hpp */
@@ -0,0 +1,123 @@
+//
+//  Arena.cpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#include "Arena.hpp"
+//
+#include <mutex>
+#include <cstdlib>
+#include "memwipe.h"
+//
+using namespace std;
+using namespace Runtime;
+//
+// Accessory functions
+static mutex pool__m;
+static vector<uint8_t *> &_pooled_blocks()
+{
+	static vector<uint8_t *> blocks;
+	return blocks;
+}
+static uint8_t *_acquire_block(size_t size)
+{
+	if (size == arena__block_size) {
+		lock_guard<mutex> lock(pool__m);
+		vector<uint8_t *> &pooled = _pooled_blocks();
+		if (!pooled.empty()) {
+			uint8_t *block = pooled.back();
+			pooled.pop_back();
+			return block;
+		}
+	}
+	uint8_t *block = static_cast<uint8_t *>(malloc(size));
+	if (block == NULL) {
+		throw std::bad_alloc();
+	}
+	return block;
+}
+static void _recycle_block(uint8_t *block, size_t size)
+{
+	if (size == arena__block_size) {
+		lock_guard<mutex> lock(pool__m);
+		vector<uint8_t *> &pooled = _pooled_blocks();
+		if (pooled.size() < arena__max_pooled_blocks) {
+			pooled.push_back(block);
+			return;
+		}
+	}
+	free(block);
+}
+//
+// Imperatives
+void *Arena::allocate(size_t size, size_t alignment)
+{
+	if (size == 0) {
+		size = 1;
+	}
+	if (!this->blocks.empty()) {
+		Block &current = this->blocks.back();
+		uintptr_t begin = (uintptr_t)(current.bytes + current.used);
+		uintptr_t aligned = (begin + alignment - 1) & ~(uintptr_t)(alignment - 1);
+		size_t padding = (size_t)(aligned - begin);
+		if (current.size - current.used >= padding + size) {
+			current.used += padding + size;
+			this->bytes_allocated += size;
+			return (void *)aligned;
+		}
+	}
+	// a fresh block - malloc'd memory is aligned for any fundamental type
+	const size_t block_size = size > arena__block_size / 4 ? size : arena__block_size;
+	Block block{ _acquire_block(block_size), block_size, size };
+	if (block_size != arena__block_size && !this->blocks.empty()) {
+		// keep bumping the partly used block; the dedicated one goes underneath it
+		this->blocks.insert(this->blocks.end() - 1, block);
+	} else {
+		this->blocks.push_back(block);
+	}
+	this->bytes_allocated += size;
+	return block.bytes;
+}
+void Arena::reset()
+{
+	for (Block &block : this->blocks) {
+		memwipe(block.bytes, block.used);
+		_recycle_block(block.bytes, block.size);
+	}
+	this->blocks.clear();
+	this->bytes_allocated = 0;
+}
+//
+// Accessors
+size_t Arena::pooledBlocks()
+{
+	lock_guard<mutex> lock(pool__m);
+	return _pooled_blocks().size();
+}
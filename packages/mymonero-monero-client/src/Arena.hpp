@@ -0,0 +1,127 @@
+//
+//  Arena.hpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#ifndef Arena_hpp
+#define Arena_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+namespace Runtime
+{
+	using namespace std;
+	//
+	// A bump allocator for the key derivations which KeyImages::Deriver memoizes, over one send
+	// session or one WorkerPool chunk. Nothing is freed individually; reset() (or destruction)
+	// wipes every byte handed out - derivations are secret - and hands the blocks back.
+	//
+	// Only what is allocated through it is wiped. The scratch of transaction construction (ptree
+	// nodes, rct vectors, bulletproof temporaries) is allocated inside the core library, which
+	// can't be pointed at an arena, and is freed to the heap unwiped as before.
+	//
+	// Blocks are a fixed size and recycled through a shared pool rather than returned to
+	// malloc, so consecutive sessions reuse the same blocks instead of interleaving fresh
+	// allocations with longer-lived ones. Under emscripten's ALLOW_MEMORY_GROWTH the heap never
+	// shrinks, so that fragmentation would otherwise be permanent. Allocations larger than a
+	// quarter block get a block of their own, which is freed on reset rather than pooled.
+	//
+	// Not thread-safe: an arena belongs to one session, or to one WorkerPool chunk; only the
+	// shared pool is locked.
+	//
+	static const size_t arena__block_size = 64 * 1024;
+	static const size_t arena__max_pooled_blocks = 64; // 4 MiB kept for reuse at most
+	//
+	class Arena
+	{
+	public:
+		//
+		// Lifecycle - Init
+		Arena() : bytes_allocated(0) {}
+		~Arena() { this->reset(); }
+		Arena(const Arena &) = delete;
+		Arena &operator=(const Arena &) = delete;
+		//
+		// Imperatives
+		void *allocate(size_t size, size_t alignment);
+		void reset(); // invalidates everything allocated
+		//
+		// Accessors
+		size_t bytesAllocated() const { return this->bytes_allocated; }
+		static size_t pooledBlocks(); // idle in the shared pool
+	private:
+		struct Block
+		{
+			uint8_t *bytes;
+			size_t size;
+			size_t used;
+		};
+		vector<Block> blocks; // the last is the one being bumped
+		size_t bytes_allocated;
+	};
+	//
+	// An std allocator over an Arena, or over the heap when constructed without one, so that a
+	// container can take an arena only where the caller has one to give.
+	template <typename T>
+	class ArenaAllocator
+	{
+	public:
+		typedef T value_type;
+		//
+		ArenaAllocator(Arena *arena = NULL) noexcept : arena(arena) {}
+		template <typename U>
+		ArenaAllocator(const ArenaAllocator<U> &other) noexcept : arena(other.arena) {}
+		//
+		T *allocate(size_t n)
+		{
+			if (this->arena == NULL) {
+				return static_cast<T *>(::operator new(n * sizeof(T)));
+			}
+			return static_cast<T *>(this->arena->allocate(n * sizeof(T), alignof(T)));
+		}
+		void deallocate(T *p, size_t) noexcept
+		{
+			if (this->arena == NULL) {
+				::operator delete(p);
+			} // else reclaimed at the arena's reset
+		}
+		//
+		Arena *arena;
+	};
+	template <typename T, typename U>
+	bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) { return a.arena == b.arena; }
+	template <typename T, typename U>
+	bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) { return a.arena != b.arena; }
+}
+
+#endif /* Arena_hpp */
@@ -0,0 +1,119 @@
+//
+//  FeeMatrix.cpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#include "FeeMatrix.hpp"
+//
+#include <mutex>
+#include "monero_fee_utils.hpp"
+#include "monero_fork_rules.hpp"
+#include "monero_transfer_utils.hpp"
+//
+using namespace std;
+using namespace Fees;
+//
+// ForkFeeRules
+const ForkFeeRules &ForkFeeRules::for_fork(uint8_t fork_version)
+{
+	static mutex m;
+	static ForkFeeRules rules[256];
+	static bool is_computed[256] = {};
+	lock_guard<mutex> lock(m);
+	if (!is_computed[fork_version]) {
+		monero_fork_rules::use_fork_rules_fn_type use_fork_rules = monero_fork_rules::make_use_fork_rules_fn(fork_version);
+		ForkFeeRules &computed = rules[fork_version];
+		computed.bulletproof = use_fork_rules(monero_fee_utils::get_bulletproof_fork(), 0);
+		computed.clsag = use_fork_rules(monero_fee_utils::get_clsag_fork(), 0);
+		computed.bulletproof_plus = use_fork_rules(monero_fee_utils::get_bulletproof_plus_fork(), 0);
+		computed.use_view_tags = use_fork_rules(monero_fee_utils::get_view_tag_fork(), 0);
+		int fee_algorithm = monero_fee_utils::get_fee_algorithm(use_fork_rules);
+		for (uint32_t priority = 1; priority <= fee_matrix__n_priorities; ++priority) {
+			computed.fee_multipliers[priority - 1] = monero_fee_utils::get_fee_multiplier(
+				priority,
+				monero_fee_utils::default_priority(),
+				fee_algorithm,
+				use_fork_rules
+			);
+		}
+		is_computed[fork_version] = true;
+	}
+	return rules[fork_version];
+}
+//
+// FeeMatrixShape
+bool FeeMatrixShape::is_valid() const
+{
+	return !this->fork_versions.empty()
+		&& this->max_inputs >= 1 && this->max_inputs <= fee_matrix__max_inputs
+		&& this->max_outputs >= 1 && this->max_outputs <= fee_matrix__max_outputs;
+}
+//
+// Imperatives
+size_t Fees::fee_matrix_index(const FeeMatrixShape &shape, size_t fork_index, uint32_t priority, size_t n_inputs, size_t n_outputs)
+{
+	return ((fork_index * fee_matrix__n_priorities + (priority - 1)) * shape.max_inputs + (n_inputs - 1)) * shape.max_outputs + (n_outputs - 1);
+}
+void Fees::fill_fee_matrix(
+	uint64_t fee_per_b,
+	uint64_t fee_quantization_mask,
+	const FeeMatrixShape &shape,
+	vector<uint64_t> &out__fees
+) {
+	out__fees.assign(shape.count(), 0);
+	uint64_t base_fee = monero_fee_utils::get_base_fee(fee_per_b);
+	int mixin = (int)monero_transfer_utils::fixed_mixinsize();
+	for (size_t fork_index = 0; fork_index < shape.fork_versions.size(); ++fork_index) {
+		const ForkFeeRules &rules = ForkFeeRules::for_fork(shape.fork_versions[fork_index]);
+		for (size_t n_inputs = 1; n_inputs <= shape.max_inputs; ++n_inputs) {
+			for (size_t n_outputs = 1; n_outputs <= shape.max_outputs; ++n_outputs) {
+				uint64_t weight = monero_fee_utils::estimate_tx_weight(
+					true/*use_rct*/,
+					(int)n_inputs,
+					mixin,
+					(int)n_outputs,
+					shape.extra_size,
+					rules.bulletproof,
+					rules.clsag,
+					rules.bulletproof_plus,
+					rules.use_view_tags
+				);
+				for (uint32_t priority = 1; priority <= fee_matrix__n_priorities; ++priority) {
+					out__fees[fee_matrix_index(shape, fork_index, priority, n_inputs, n_outputs)] = monero_fee_utils::calculate_fee_from_weight(
+						base_fee,
+						weight,
+						rules.fee_multipliers[priority - 1],
+						fee_quantization_mask
+					);
+				}
+			}
+		}
+	}
+}
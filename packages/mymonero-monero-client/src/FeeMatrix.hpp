@@ -0,0 +1,89 @@
+//
+//  FeeMatrix.hpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#ifndef FeeMatrix_hpp
+#define FeeMatrix_hpp
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace Fees
+{
+	using namespace std;
+	//
+	// Fees for a whole range of transaction shapes at once, for fee quotes and batch planning.
+	// Every entry is what send_step1 would charge a transaction of that shape: the per-byte
+	// fee of monero_fee_utils::estimate_tx_weight, quantized by the fee mask.
+	//
+	static const uint32_t fee_matrix__n_priorities = 4; // priorities 1 through 4
+	static const size_t fee_matrix__max_inputs = 1024;
+	static const size_t fee_matrix__max_outputs = 16; // the consensus limit
+	//
+	struct ForkFeeRules
+	{ // everything a fee depends on under one fork version besides the transaction's shape
+		bool bulletproof;
+		bool clsag;
+		bool bulletproof_plus;
+		bool use_view_tags;
+		uint64_t fee_multipliers[fee_matrix__n_priorities]; // by priority - 1
+		//
+		// Computed on first use of each fork version and kept; fork version 0 is the latest,
+		// as for estimateTxFee
+		static const ForkFeeRules &for_fork(uint8_t fork_version);
+	};
+	//
+	struct FeeMatrixShape
+	{
+		vector<uint8_t> fork_versions;
+		size_t max_inputs; // n_inputs runs from 1 through max_inputs
+		size_t max_outputs; // n_outputs runs from 1 through max_outputs, change included
+		size_t extra_size; // tx extra bytes, e.g. 0, or 11 for an encrypted payment id
+		//
+		size_t count() const { return this->fork_versions.size() * fee_matrix__n_priorities * this->max_inputs * this->max_outputs; }
+		bool is_valid() const;
+	};
+	//
+	// Fills out__fees with count() fees, nested fork version (in the given order), priority,
+	// n_inputs, n_outputs - so n_outputs varies fastest. A transaction's weight doesn't
+	// depend on its priority, so it's estimated once per shape and fork version.
+	void fill_fee_matrix(
+		uint64_t fee_per_b,
+		uint64_t fee_quantization_mask,
+		const FeeMatrixShape &shape,
+		vector<uint64_t> &out__fees
+	);
+	// The index of a fee within a filled matrix
+	size_t fee_matrix_index(const FeeMatrixShape &shape, size_t fork_index, uint32_t priority, size_t n_inputs, size_t n_outputs);
+}
+
+#endif /* FeeMatrix_hpp */
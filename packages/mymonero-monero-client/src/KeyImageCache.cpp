@@ -0,0 +1,230 @@
+//
+//  KeyImageCache.cpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+#include "KeyImageCache.hpp"
+//
+#include <algorithm>
+#include <cstring>
+#include "hash.h"
+//
+using namespace std;
+using namespace KeyImages;
+//
+// Constants
+static const char snapshot__magic[4] = { 'M', 'M', 'K', 'I' };
+static const uint32_t snapshot__version = 1;
+static const size_t snapshot__header_size = sizeof(snapshot__magic) + sizeof(uint32_t) + sizeof(uint64_t);
+static const size_t snapshot__entry_size = sizeof(crypto::hash) + sizeof(crypto::key_image);
+//
+// Accessory functions
+static void _append_le(string &dst, uint64_t value, size_t n_bytes)
+{
+	for (size_t i = 0; i < n_bytes; ++i) {
+		dst.push_back((char)((value >> (8 * i)) & 0xff));
+	}
+}
+static uint64_t _read_le(const char *src, size_t n_bytes)
+{
+	uint64_t value = 0;
+	for (size_t i = 0; i < n_bytes; ++i) {
+		value |= (uint64_t)(uint8_t)src[i] << (8 * i);
+	}
+	return value;
+}
+//
+// Lifecycle - Init
+Cache::Cache(size_t max_bytes)
+	: n_entries(0)
+{
+	size_t max_size = 1;
+	while (max_size * 2 * sizeof(Entry) <= max_bytes) {
+		max_size *= 2;
+	}
+	if (max_size < max_probe_length) {
+		max_size = max_probe_length;
+	}
+	this->entries__max_size = max_size;
+	this->entries.resize(min(max_size, (size_t)initial_capacity)); // value-initialized, i.e. empty
+}
+//
+// Accessors
+crypto::hash Cache::_key_for(
+	const crypto::public_key &pub_spendKey,
+	const crypto::public_key &tx_pub_key,
+	uint64_t out_index
+) {
+	char buf[sizeof(crypto::public_key) * 2 + sizeof(uint64_t)];
+	memcpy(buf, &pub_spendKey, sizeof(crypto::public_key));
+	memcpy(buf + sizeof(crypto::public_key), &tx_pub_key, sizeof(crypto::public_key));
+	for (size_t i = 0; i < sizeof(uint64_t); ++i) {
+		buf[sizeof(crypto::public_key) * 2 + i] = (char)((out_index >> (8 * i)) & 0xff);
+	}
+	return crypto::cn_fast_hash(buf, sizeof(buf));
+}
+bool Cache::_is_empty(const Entry &entry)
+{
+	return entry.key == crypto::null_hash;
+}
+size_t Cache::_home_slot_for(const crypto::hash &key) const
+{ // the key is already a uniformly distributed hash so its leading bytes serve as the slot hash
+	return (size_t)_read_le(key.data, sizeof(uint64_t)) & (this->entries.size() - 1);
+}
+bool Cache::get(
+	const crypto::public_key &pub_spendKey,
+	const crypto::public_key &tx_pub_key,
+	uint64_t out_index,
+	crypto::key_image &out__key_image
+) const {
+	crypto::hash key = _key_for(pub_spendKey, tx_pub_key, out_index);
+	size_t mask = this->entries.size() - 1;
+	size_t home = this->_home_slot_for(key);
+	for (size_t i = 0; i < max_probe_length; ++i) {
+		const Entry &entry = this->entries[(home + i) & mask];
+		if (_is_empty(entry)) {
+			return false;
+		}
+		if (entry.key == key) {
+			out__key_image = entry.value;
+			return true;
+		}
+	}
+	return false;
+}
+//
+// Imperatives
+void Cache::put(
+	const crypto::public_key &pub_spendKey,
+	const crypto::public_key &tx_pub_key,
+	uint64_t out_index,
+	const crypto::key_image &key_image
+) {
+	this->_put(_key_for(pub_spendKey, tx_pub_key, out_index), key_image);
+}
+void Cache::_put(const crypto::hash &key, const crypto::key_image &value)
+{
+	if (this->entries.size() < this->entries__max_size && (this->n_entries + 1) * 4 > this->entries.size() * 3) {
+		this->_grow(); // past 3/4 full
+	}
+	while (!this->_try_insert(key, value)) {
+		if (this->entries.size() >= this->entries__max_size) {
+			this->_replace_home_slot(key, value);
+			return;
+		}
+		this->_grow();
+	}
+}
+bool Cache::_try_insert(const crypto::hash &key, const crypto::key_image &value)
+{
+	size_t mask = this->entries.size() - 1;
+	size_t home = this->_home_slot_for(key);
+	for (size_t i = 0; i < max_probe_length; ++i) {
+		Entry &entry = this->entries[(home + i) & mask];
+		if (_is_empty(entry)) {
+			entry.key = key;
+			entry.value = value;
+			this->n_entries += 1;
+			return true;
+		}
+		if (entry.key == key) {
+			entry.value = value;
+			return true;
+		}
+	}
+	return false;
+}
+void Cache::_replace_home_slot(const crypto::hash &key, const crypto::key_image &value)
+{ // as slots are never emptied individually this can't break the probe chain of any other entry
+	Entry &evicted = this->entries[this->_home_slot_for(key)];
+	evicted.key = key;
+	evicted.value = value;
+}
+void Cache::_grow()
+{
+	vector<Entry> previous(this->entries.size() * 2);
+	previous.swap(this->entries);
+	this->n_entries = 0;
+	for (const Entry &entry : previous) {
+		if (!_is_empty(entry) && !this->_try_insert(entry.key, entry.value)) {
+			this->_replace_home_slot(entry.key, entry.value); // not expected at half the load
+		}
+	}
+}
+void Cache::clear()
+{
+	for (Entry &entry : this->entries) {
+		entry.key = crypto::null_hash;
+	}
+	this->n_entries = 0;
+}
+//
+// Imperatives - Persistence
+string Cache::snapshot() const
+{
+	string snapshot;
+	snapshot.reserve(snapshot__header_size + this->n_entries * snapshot__entry_size);
+	snapshot.append(snapshot__magic, sizeof(snapshot__magic));
+	_append_le(snapshot, snapshot__version, sizeof(uint32_t));
+	_append_le(snapshot, this->n_entries, sizeof(uint64_t));
+	for (const Entry &entry : this->entries) {
+		if (_is_empty(entry)) {
+			continue;
+		}
+		snapshot.append(entry.key.data, sizeof(entry.key.data));
+		snapshot.append((const char *)&entry.value, sizeof(entry.value));
+	}
+	return snapshot;
+}
+bool Cache::load_snapshot(const string &snapshot)
+{
+	if (snapshot.size() < snapshot__header_size
+		|| memcmp(snapshot.data(), snapshot__magic, sizeof(snapshot__magic)) != 0
+		|| _read_le(snapshot.data() + sizeof(snapshot__magic), sizeof(uint32_t)) != snapshot__version) {
+		return false;
+	}
+	uint64_t n = _read_le(snapshot.data() + sizeof(snapshot__magic) + sizeof(uint32_t), sizeof(uint64_t));
+	if ((snapshot.size() - snapshot__header_size) / snapshot__entry_size != n
+		|| (snapshot.size() - snapshot__header_size) % snapshot__entry_size != 0) {
+		return false;
+	}
+	const char *cursor = snapshot.data() + snapshot__header_size;
+	for (uint64_t i = 0; i < n; ++i) {
+		crypto::hash key;
+		crypto::key_image value;
+		memcpy(key.data, cursor, sizeof(key.data));
+		memcpy(&value, cursor + sizeof(key.data), sizeof(value));
+		cursor += snapshot__entry_size;
+		if (key == crypto::null_hash) {
+			continue;
+		}
+		this->_put(key, value);
+	}
+	return true;
+}
@@ -0,0 +1,112 @@
+//
+//  KeyImageCache.hpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#ifndef KeyImageCache_hpp
+#define KeyImageCache_hpp
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "crypto.h"
+
+namespace KeyImages
+{
+	using namespace std;
+	//
+	// A bounded cache of key images keyed by (pub_spendKey, tx_pub_key, out_index).
+	//
+	// Entries are fixed-size: a 32-byte hash of the lookup tuple and the 32-byte key image, stored
+	// in an open-addressing table which starts at initial_capacity and doubles, as it fills, up to
+	// the cap given at init by max_bytes. Lookups and inserts probe at most max_probe_length slots;
+	// once at the cap, an insert which finds no free slot in that window replaces the entry at the
+	// home slot, so the table never grows past it.
+	//
+	// The occupied entries can be written to and read back from a compact binary snapshot.
+	//
+	class Cache
+	{
+	public:
+		static const size_t default_max_bytes = 4 * 1024 * 1024;
+		static const size_t max_probe_length = 16;
+		static const size_t initial_capacity = 256;
+		//
+		// Lifecycle - Init
+		Cache(size_t max_bytes = default_max_bytes);
+		//
+		// Accessors
+		bool get(
+			const crypto::public_key &pub_spendKey,
+			const crypto::public_key &tx_pub_key,
+			uint64_t out_index,
+			crypto::key_image &out__key_image
+		) const;
+		size_t size() const { return this->n_entries; }
+		size_t capacity() const { return this->entries.size(); }
+		size_t max_capacity() const { return this->entries__max_size; }
+		//
+		// Imperatives
+		void put(
+			const crypto::public_key &pub_spendKey,
+			const crypto::public_key &tx_pub_key,
+			uint64_t out_index,
+			const crypto::key_image &key_image
+		);
+		void clear();
+		//
+		// Imperatives - Persistence
+		string snapshot() const;
+		bool load_snapshot(const string &snapshot); // merges into the current entries; false on a malformed snapshot
+	private:
+		struct Entry
+		{
+			crypto::hash key; // all-zero when the slot is empty
+			crypto::key_image value;
+		};
+		vector<Entry> entries; // power-of-two sized
+		size_t entries__max_size; // power of two
+		size_t n_entries;
+		//
+		static crypto::hash _key_for(
+			const crypto::public_key &pub_spendKey,
+			const crypto::public_key &tx_pub_key,
+			uint64_t out_index
+		);
+		static bool _is_empty(const Entry &entry);
+		size_t _home_slot_for(const crypto::hash &key) const;
+		void _put(const crypto::hash &key, const crypto::key_image &value);
+		bool _try_insert(const crypto::hash &key, const crypto::key_image &value); // false if the probe window is full
+		void _replace_home_slot(const crypto::hash &key, const crypto::key_image &value);
+		void _grow();
+	};
+}
+
+#endif /* KeyImageCache_hpp */
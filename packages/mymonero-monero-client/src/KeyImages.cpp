@@ -0,0 +1,119 @@
+//
+//  KeyImages.cpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+#include "KeyImages.hpp"
+//
+#include <atomic>
+#include "WorkerPool.hpp"
+//
+using namespace std;
+using namespace boost;
+using namespace KeyImages;
+//
+// Lifecycle - Init
+Deriver::Deriver(
+	const crypto::secret_key &sec_viewKey,
+	const crypto::secret_key &sec_spendKey,
+	Runtime::Arena *arena
+) : sec_viewKey(sec_viewKey),
+	sec_spendKey(sec_spendKey),
+	derivations_by_tx_pub_key(0, std::hash<crypto::public_key>(), std::equal_to<crypto::public_key>(), Runtime::ArenaAllocator<DerivationsMap::value_type>(arena))
+{
+}
+//
+// Imperatives
+bool Deriver::_derivation_for(const crypto::public_key &tx_pub_key, crypto::key_derivation &out__derivation)
+{
+	auto found = this->derivations_by_tx_pub_key.find(tx_pub_key);
+	if (found != this->derivations_by_tx_pub_key.end()) {
+		out__derivation = found->second;
+		return true;
+	}
+	if (!crypto::generate_key_derivation(tx_pub_key, this->sec_viewKey, out__derivation)) {
+		return false;
+	}
+	this->derivations_by_tx_pub_key.emplace(tx_pub_key, out__derivation);
+	//
+	return true;
+}
+bool Deriver::key_image(
+	const crypto::public_key &tx_pub_key,
+	uint64_t out_index,
+	crypto::key_image &out__key_image
+) {
+	crypto::key_derivation derivation;
+	if (!this->_derivation_for(tx_pub_key, derivation)) {
+		return false;
+	}
+	crypto::secret_key in_ephemeral__sec;
+	crypto::derive_secret_key(derivation, out_index, this->sec_spendKey, in_ephemeral__sec);
+	crypto::public_key in_ephemeral__pub;
+	if (!crypto::secret_key_to_public_key(in_ephemeral__sec, in_ephemeral__pub)) { // (Hs(8aR||i) + b)G == Hs(8aR||i)G + B
+		return false;
+	}
+	crypto::generate_key_image(in_ephemeral__pub, in_ephemeral__sec, out__key_image);
+	//
+	return true;
+}
+optional<size_t> Deriver::key_images(
+	const vector<OutputRef> &outputs,
+	vector<crypto::key_image> &out__key_images
+) {
+	out__key_images.resize(outputs.size());
+	Runtime::WorkerPool &pool = Runtime::WorkerPool::shared();
+	if (pool.concurrency() == 1 || outputs.size() < key_images__parallel_grain * 2) {
+		for (size_t i = 0; i < outputs.size(); ++i) {
+			if (!this->key_image(outputs[i].tx_pub_key, outputs[i].out_index, out__key_images[i])) {
+				return i;
+			}
+		}
+		return none;
+	}
+	// Each chunk memoizes into its own Deriver; outputs of one tx tend to be adjacent, so little
+	// is lost versus sharing this->derivations_by_tx_pub_key across threads. Its derivations go
+	// into an arena of its own, declared first so that it wipes them after the map is destroyed.
+	atomic<size_t> first_failed_index(outputs.size());
+	pool.parallel_for(outputs.size(), key_images__parallel_grain, [&](size_t begin, size_t end) {
+		Runtime::Arena chunk_arena;
+		Deriver chunk_deriver(this->sec_viewKey, this->sec_spendKey, &chunk_arena);
+		for (size_t i = begin; i < end; ++i) {
+			if (!chunk_deriver.key_image(outputs[i].tx_pub_key, outputs[i].out_index, out__key_images[i])) {
+				size_t current = first_failed_index.load();
+				while (i < current && !first_failed_index.compare_exchange_weak(current, i)) {}
+				return;
+			}
+		}
+	});
+	if (first_failed_index.load() != outputs.size()) {
+		return first_failed_index.load();
+	}
+	return none;
+}
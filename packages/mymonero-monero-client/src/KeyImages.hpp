@@ -0,0 +1,105 @@
+//
+//  KeyImages.hpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#ifndef KeyImages_hpp
+#define KeyImages_hpp
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <boost/optional/optional.hpp>
+#include "crypto.h"
+#include "Arena.hpp"
+
+namespace KeyImages
+{
+	using namespace std;
+	using namespace boost;
+	//
+	// Accessory Types
+	struct OutputRef
+	{
+		crypto::public_key tx_pub_key;
+		uint64_t out_index;
+	};
+	//
+	// Outputs per WorkerPool chunk in Deriver::key_images - a few ms of scalarmults each
+	static const size_t key_images__parallel_grain = 64;
+	//
+	// Derives key images for many outputs belonging to one wallet.
+	//
+	// The wallet keys are parsed once at init and the key derivation for each tx_pub_key is
+	// memoized, so outputs which share a transaction only pay for one view-key scalarmult. The
+	// one-time public key is computed from the derived secret with a single fixed-base scalarmult
+	// rather than derive_public_key's fixed-base + decompress + add of the public spend key.
+	//
+	class Deriver
+	{
+	public:
+		//
+		// Lifecycle - Init
+		Deriver(
+			const crypto::secret_key &sec_viewKey,
+			const crypto::secret_key &sec_spendKey,
+			Runtime::Arena *arena = NULL // for the memoized derivations, which must not outlive it
+		);
+		//
+		// Imperatives
+		bool key_image(
+			const crypto::public_key &tx_pub_key,
+			uint64_t out_index,
+			crypto::key_image &out__key_image
+		);
+		// fills out__key_images in input order, spread over the shared WorkerPool for large batches;
+		// returns the index of the first output which failed, if any
+		optional<size_t> key_images(
+			const vector<OutputRef> &outputs,
+			vector<crypto::key_image> &out__key_images
+		);
+		void clear_derivations_cache() { this->derivations_by_tx_pub_key.clear(); }
+	private:
+		crypto::secret_key sec_viewKey;
+		crypto::secret_key sec_spendKey;
+		typedef unordered_map<
+			crypto::public_key,
+			crypto::key_derivation,
+			std::hash<crypto::public_key>,
+			std::equal_to<crypto::public_key>,
+			Runtime::ArenaAllocator<pair<const crypto::public_key, crypto::key_derivation>>
+		> DerivationsMap;
+		DerivationsMap derivations_by_tx_pub_key;
+		//
+		bool _derivation_for(const crypto::public_key &tx_pub_key, crypto::key_derivation &out__derivation);
+	};
+}
+
+#endif /* KeyImages_hpp */
@@ -0,0 +1,124 @@
+//
+//  OutputIndex.cpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#include "OutputIndex.hpp"
+//
+using namespace std;
+using namespace Outputs;
+//
+// Accessory functions
+static bool _is_covered(uint64_t total, uint64_t amount, uint64_t reserve)
+{
+	return amount <= UINT64_MAX - reserve && total >= amount + reserve;
+}
+//
+// Imperatives
+void Index::add(SpendableOutput output)
+{
+	this->remove(output.public_key);
+	string public_key = output.public_key;
+	uint64_t amount = output.amount;
+	OutputsByAmount::iterator it = this->outputs_by_amount.emplace(amount, std::move(output));
+	this->outputs_by_public_key[std::move(public_key)] = it;
+	this->_balance += amount;
+}
+bool Index::remove(const string &public_key)
+{
+	auto found = this->outputs_by_public_key.find(public_key);
+	if (found == this->outputs_by_public_key.end()) {
+		return false;
+	}
+	this->_balance -= found->second->first;
+	this->outputs_by_amount.erase(found->second);
+	this->outputs_by_public_key.erase(found);
+	return true;
+}
+void Index::clear()
+{
+	this->outputs_by_public_key.clear();
+	this->outputs_by_amount.clear();
+	this->_balance = 0;
+}
+void Index::select(
+	SelectionStrategy strategy,
+	uint64_t amount,
+	const FeeReserveFn &reserve,
+	vector<SpendableOutput> &out__outputs
+) const {
+	const size_t first_out = out__outputs.size();
+	uint64_t total = 0;
+	size_t n_taken = 0;
+	OutputsByAmount::const_iterator smallest_not_taken = this->outputs_by_amount.begin();
+	if (strategy == consolidateDust) {
+		while (smallest_not_taken != this->outputs_by_amount.end() && n_taken < consolidate__max_inputs) {
+			total += smallest_not_taken->first;
+			out__outputs.push_back(smallest_not_taken->second);
+			n_taken += 1;
+			++smallest_not_taken;
+		}
+		if (_is_covered(total, amount, reserve(n_taken))) {
+			return;
+		}
+	} else {
+		uint64_t single_reserve = reserve(1);
+		if (amount <= UINT64_MAX - single_reserve) {
+			auto single = this->outputs_by_amount.lower_bound(amount + single_reserve);
+			if (single != this->outputs_by_amount.end()) {
+				out__outputs.push_back(single->second);
+				return;
+			}
+		}
+	}
+	// the largest remaining, down to the smallest taken above
+	for (auto it = this->outputs_by_amount.rbegin(); it != this->outputs_by_amount.rend(); ++it) {
+		if (it.base() == smallest_not_taken) {
+			break;
+		}
+		if (_is_covered(total, amount, reserve(n_taken))) {
+			break;
+		}
+		total += it->first;
+		out__outputs.push_back(it->second);
+		n_taken += 1;
+	}
+	if (!_is_covered(total, amount, reserve(n_taken))) { // send_step1 reports the shortfall as usual
+		out__outputs.resize(first_out);
+		this->all(out__outputs);
+	}
+}
+void Index::all(vector<SpendableOutput> &out__outputs) const
+{
+	out__outputs.reserve(out__outputs.size() + this->outputs_by_amount.size());
+	for (const auto &entry : this->outputs_by_amount) {
+		out__outputs.push_back(entry.second);
+	}
+}
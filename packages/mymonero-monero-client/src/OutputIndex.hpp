@@ -0,0 +1,96 @@
+//
+//  OutputIndex.hpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#ifndef OutputIndex_hpp
+#define OutputIndex_hpp
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include "monero_send_routine.hpp"
+
+namespace Outputs
+{
+	using namespace std;
+	using monero_transfer_utils::SpendableOutput;
+	//
+	// Accessory Types
+	enum SelectionStrategy
+	{
+		minimizeInputs = 0, // the smallest single output which covers the send, else the largest outputs
+		consolidateDust = 1 // the smallest outputs first, up to consolidate__max_inputs, then the largest
+	};
+	static const size_t consolidate__max_inputs = 32;
+	//
+	// The fee to reserve for a transaction of n_inputs inputs
+	typedef function<uint64_t(size_t n_inputs)> FeeReserveFn;
+	//
+	// A wallet's unspent outputs ordered by amount, so that a send can pick the few it needs in
+	// O(log n) rather than scanning, re-sorting and re-decoding all of them. Outputs are added
+	// as they're received and removed as they're spent, by public key; adding an output which
+	// is already indexed replaces it.
+	//
+	class Index
+	{
+	public:
+		//
+		// Imperatives
+		void add(SpendableOutput output);
+		bool remove(const string &public_key);
+		void clear();
+		//
+		// Appends outputs which cover amount plus reserve(number of outputs) to out__outputs, or
+		// every output when they can't. With reserve pessimistic, send_step1 finds what it needs
+		// among them however the fee converges.
+		void select(
+			SelectionStrategy strategy,
+			uint64_t amount,
+			const FeeReserveFn &reserve,
+			vector<SpendableOutput> &out__outputs
+		) const;
+		void all(vector<SpendableOutput> &out__outputs) const;
+		//
+		// Accessors
+		size_t size() const { return this->outputs_by_amount.size(); }
+		uint64_t balance() const { return this->_balance; }
+	private:
+		typedef multimap<uint64_t, SpendableOutput> OutputsByAmount;
+		OutputsByAmount outputs_by_amount;
+		unordered_map<string, OutputsByAmount::iterator> outputs_by_public_key;
+		uint64_t _balance = 0;
+	};
+}
+
+#endif /* OutputIndex_hpp */
@@ -0,0 +1,128 @@
+//
+//  OutputScanner.cpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+//
+#include "OutputScanner.hpp"
+//
+#include <cstring>
+#include "ringct/rctOps.h"
+#include "WorkerPool.hpp"
+//
+using namespace std;
+using namespace boost;
+using namespace OutputScanning;
+//
+// Imperatives
+void Scanner::scan(const vector<Transaction> &transactions, vector<OwnedOutput> &out__owned)
+{
+	// one slot per transaction, which stays unallocated for the common case of no owned outputs
+	vector<vector<OwnedOutput>> owned_by_tx(transactions.size());
+	Runtime::WorkerPool::shared().parallel_for(transactions.size(), scan__parallel_grain, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			this->_scan_transaction(transactions[i], i, owned_by_tx[i]);
+		}
+	});
+	for (vector<OwnedOutput> &owned : owned_by_tx) {
+		out__owned.insert(out__owned.end(), owned.begin(), owned.end());
+	}
+}
+void Scanner::_scan_transaction(const Transaction &transaction, size_t tx_index, vector<OwnedOutput> &out__owned) const
+{
+	const crypto::secret_key &sec_viewKey = this->context.keys().sec_viewKey;
+	crypto::key_derivation derivation;
+	bool has_derivation = crypto::generate_key_derivation(transaction.tx_pub_key, sec_viewKey, derivation);
+	for (size_t i = 0; i < transaction.outputs.size(); ++i) {
+		OwnedOutput owned;
+		bool is_owned = has_derivation && this->_try_output(transaction.outputs[i], i, derivation, owned);
+		if (!is_owned && i < transaction.additional_pub_keys.size()) { // only derived once the main key has missed
+			crypto::key_derivation additional_derivation;
+			is_owned = crypto::generate_key_derivation(transaction.additional_pub_keys[i], sec_viewKey, additional_derivation)
+				&& this->_try_output(transaction.outputs[i], i, additional_derivation, owned);
+		}
+		if (is_owned) {
+			owned.tx_index = tx_index;
+			out__owned.push_back(owned);
+		}
+	}
+}
+bool Scanner::_try_output(
+	const TransactionOutput &output,
+	size_t output_index,
+	const crypto::key_derivation &derivation,
+	OwnedOutput &out__owned
+) const {
+	if (output.view_tag != none) {
+		crypto::view_tag view_tag;
+		crypto::derive_view_tag(derivation, output_index, view_tag);
+		if (memcmp(&view_tag, &(*output.view_tag), sizeof(view_tag)) != 0) {
+			return false;
+		}
+	}
+	crypto::public_key derived_public_key;
+	if (!this->context.derive_output_public_key(derivation, output_index, derived_public_key)
+		|| derived_public_key != output.public_key) {
+		return false;
+	}
+	out__owned.output_index = output_index;
+	out__owned.public_key = output.public_key;
+	out__owned.derivation = derivation;
+	if (output.encrypted_amount == none) {
+		out__owned.amount = output.amount;
+		out__owned.mask = rct::identity();
+		return true;
+	}
+	crypto::ec_scalar shared_scalar;
+	crypto::derivation_to_scalar(derivation, output_index, shared_scalar);
+	rct::key shared_secret;
+	memcpy(shared_secret.bytes, &shared_scalar, sizeof(shared_secret.bytes));
+	rct::ecdhTuple ecdh_info;
+	ecdh_info.mask = rct::zero();
+	ecdh_info.amount = *output.encrypted_amount;
+	rct::ecdhDecode(ecdh_info, shared_secret, true);
+	out__owned.amount = rct::h2d(ecdh_info.amount);
+	out__owned.mask = ecdh_info.mask;
+	if (output.commitment != none && !rct::equalKeys(rct::commit(out__owned.amount, out__owned.mask), *output.commitment)) {
+		return false; // an amount we'd be unable to spend
+	}
+	return true;
+}
+bool Scanner::key_image(const OwnedOutput &output, crypto::key_image &out__key_image) const
+{
+	crypto::secret_key in_ephemeral__sec;
+	crypto::derive_secret_key(output.derivation, output.output_index, this->context.keys().sec_spendKey, in_ephemeral__sec);
+	crypto::public_key in_ephemeral__pub;
+	if (!crypto::secret_key_to_public_key(in_ephemeral__sec, in_ephemeral__pub)) {
+		return false;
+	}
+	crypto::generate_key_image(in_ephemeral__pub, in_ephemeral__sec, out__key_image);
+	//
+	return true;
+}
@@ -0,0 +1,110 @@
+//
+//  OutputScanner.hpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#ifndef OutputScanner_hpp
+#define OutputScanner_hpp
+
+#include <vector>
+#include <boost/optional/optional.hpp>
+#include "crypto.h"
+#include "ringct/rctTypes.h"
+#include "WalletContext.hpp"
+
+namespace OutputScanning
+{
+	using namespace std;
+	using namespace boost;
+	//
+	// Accessory Types
+	struct TransactionOutput
+	{
+		crypto::public_key public_key;
+		optional<crypto::view_tag> view_tag; // from v15; lets most foreign outputs be rejected with one hash
+		optional<rct::key> commitment; // RingCT outputs; checked against the decrypted amount
+		optional<rct::key> encrypted_amount; // RingCT v2 ecdhInfo amount - only the first 8 bytes are used
+		uint64_t amount; // in the clear, for pre-RingCT and coinbase outputs
+	};
+	struct Transaction
+	{
+		crypto::public_key tx_pub_key;
+		vector<crypto::public_key> additional_pub_keys; // one per output, or empty
+		vector<TransactionOutput> outputs;
+	};
+	struct OwnedOutput
+	{
+		size_t tx_index; // into the scanned transactions
+		size_t output_index;
+		crypto::public_key public_key;
+		uint64_t amount;
+		rct::key mask; // commitment mask; identity for outputs with a cleartext amount
+		crypto::key_derivation derivation; // kept so the key image needn't redo the view-key scalarmult
+	};
+	//
+	// Outputs per WorkerPool chunk in Scanner::scan, counting by transaction
+	static const size_t scan__parallel_grain = 32;
+	//
+	// Finds the outputs which belong to a wallet's primary address.
+	//
+	// Versus calling generate_key_derivation + derive_public_key for each output:
+	// - the derivation is computed once per tx public key, not once per output
+	// - the view tag, when present, rejects ~255/256 of foreign outputs before any scalarmult
+	// - the spend key addend is precomputed by the Wallet::Context, so nothing is decompressed
+	// - transactions are spread over the shared WorkerPool
+	//
+	// Key images are not derived while scanning; call key_image for the outputs which need one.
+	//
+	class Scanner
+	{
+	public:
+		//
+		// Lifecycle - Init
+		Scanner(const Wallet::Context &context) : context(context) {}
+		//
+		// Imperatives
+		// Appends the owned outputs in transaction and output order. Transactions with invalid
+		// public keys are skipped, as are outputs whose amount does not open their commitment.
+		void scan(const vector<Transaction> &transactions, vector<OwnedOutput> &out__owned);
+		bool key_image(const OwnedOutput &output, crypto::key_image &out__key_image) const;
+	private:
+		const Wallet::Context &context;
+		//
+		void _scan_transaction(const Transaction &transaction, size_t tx_index, vector<OwnedOutput> &out__owned) const;
+		bool _try_output(
+			const TransactionOutput &output,
+			size_t output_index,
+			const crypto::key_derivation &derivation,
+			OwnedOutput &out__owned
+		) const;
+	};
+}
+
+#endif /* OutputScanner_hpp */
@@ -0,0 +1,404 @@
+//
+//  SendFundsBatchController.cpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#include "SendFundsBatchController.hpp"
+//
+#include <algorithm>
+//
+#include "serial_bridge_utils.hpp"
+#include "StreamingJSON.hpp"
+#include "AddressDecoding.hpp"
+#include "WorkerPool.hpp"
+//
+using namespace std;
+using namespace boost;
+using namespace SendFunds;
+using namespace serial_bridge_utils;
+//
+// Constants - transaction weight estimates at ring size 16, rounded up (CLSAG, bulletproofs+
+// including the clawback, view tags)
+static const uint64_t batch__base_weight = 1500;
+static const uint64_t batch__input_weight = 800;
+static const uint64_t batch__output_weight = 1000;
+static const uint64_t batch__priority_multipliers[] = { 1, 5, 25, 1000 }; // the largest of any fee algorithm
+//
+// Planning
+uint64_t BatchFeeModel::reserve(size_t n_inputs, size_t n_outputs) const
+{
+	size_t priority_index = this->priority < 1 ? 0 : std::min<size_t>(this->priority, 4) - 1;
+	uint64_t weight = batch__base_weight + n_inputs * batch__input_weight + n_outputs * batch__output_weight;
+	return this->fee_per_b * batch__priority_multipliers[priority_index] * weight + this->fee_per_o * n_outputs;
+}
+static vector<size_t> _indices_by_amount_descending(const vector<uint64_t> &amounts)
+{
+	vector<size_t> indices(amounts.size());
+	for (size_t i = 0; i < indices.size(); ++i) {
+		indices[i] = i;
+	}
+	std::stable_sort(indices.begin(), indices.end(), [&amounts](size_t a, size_t b) {
+		return amounts[a] > amounts[b];
+	});
+	return indices;
+}
+optional<string> SendFunds::plan_batch_payout(
+	const vector<uint64_t> &sending_amounts,
+	const vector<bool> &is_integrated,
+	const vector<uint64_t> &output_amounts,
+	const BatchFeeModel &fees,
+	vector<PlannedTransaction> &out__plan
+) {
+	out__plan.clear();
+	if (sending_amounts.empty()) {
+		return string("No destinations provided");
+	}
+	// Destinations - the fewest groups within the output limit which have one integrated
+	// address at most
+	size_t n_integrated = (size_t)std::count(is_integrated.begin(), is_integrated.end(), true);
+	size_t n_groups = std::max(
+		(sending_amounts.size() + batch__max_destinations_per_tx - 1) / batch__max_destinations_per_tx,
+		n_integrated
+	);
+	vector<vector<size_t>> groups(n_groups);
+	size_t next_group = 0;
+	for (size_t i = 0; i < sending_amounts.size(); ++i) {
+		if (is_integrated[i]) {
+			groups[next_group++].push_back(i);
+		}
+	}
+	next_group = 0;
+	for (size_t i = 0; i < sending_amounts.size(); ++i) {
+		if (is_integrated[i]) {
+			continue;
+		}
+		while (groups[next_group].size() >= batch__max_destinations_per_tx) {
+			next_group += 1;
+		}
+		groups[next_group].push_back(i);
+	}
+	// Inputs - largest first, so that each transaction spends as few as possible. A group which
+	// can't be funded within the input limit is halved and the halves funded separately.
+	vector<size_t> outputs_by_amount = _indices_by_amount_descending(output_amounts);
+	size_t next_output = 0;
+	for (size_t g = 0; g < groups.size(); ++g) {
+		uint64_t needed = 0;
+		for (size_t i : groups[g]) {
+			if (sending_amounts[i] > UINT64_MAX - needed) {
+				return string("Output amount overflow");
+			}
+			needed += sending_amounts[i];
+		}
+		const size_t n_outputs = groups[g].size() + 1; // plus change
+		const size_t first_output = next_output;
+		uint64_t total = 0;
+		auto is_funded = [&]() {
+			uint64_t reserve = fees.reserve(next_output - first_output, n_outputs);
+			return needed <= UINT64_MAX - reserve && total >= needed + reserve;
+		};
+		while (!is_funded() && next_output < outputs_by_amount.size() && next_output - first_output < batch__max_inputs_per_tx) {
+			total += output_amounts[outputs_by_amount[next_output]];
+			next_output += 1;
+		}
+		if (is_funded()) {
+			PlannedTransaction planned;
+			planned.destination_indices = groups[g];
+			planned.output_indices.assign(outputs_by_amount.begin() + first_output, outputs_by_amount.begin() + next_output);
+			out__plan.push_back(std::move(planned));
+			continue;
+		}
+		if (next_output - first_output < batch__max_inputs_per_tx) {
+			return string("Spendable balance too low");
+		}
+		if (groups[g].size() == 1) {
+			return string("A destination needs more inputs than fit in one transaction");
+		}
+		next_output = first_output;
+		vector<size_t> second_half(groups[g].begin() + groups[g].size() / 2, groups[g].end());
+		groups[g].resize(groups[g].size() / 2);
+		groups.insert(groups.begin() + g + 1, std::move(second_half));
+		g -= 1; // and again with the first half
+	}
+	//
+	return boost::none;
+}
+optional<string> SendFunds::plan_batch_sweep(const vector<uint64_t> &output_amounts, vector<PlannedTransaction> &out__plan)
+{
+	out__plan.clear();
+	if (output_amounts.empty()) {
+		return string("Spendable balance too low");
+	}
+	// dealt round-robin by amount, so that no transaction is left with only dust
+	size_t n_transactions = (output_amounts.size() + batch__max_inputs_per_tx - 1) / batch__max_inputs_per_tx;
+	out__plan.resize(n_transactions);
+	vector<size_t> outputs_by_amount = _indices_by_amount_descending(output_amounts);
+	for (size_t i = 0; i < outputs_by_amount.size(); ++i) {
+		out__plan[i % n_transactions].output_indices.push_back(outputs_by_amount[i]);
+	}
+	for (PlannedTransaction &planned : out__plan) {
+		planned.destination_indices.push_back(0);
+	}
+	//
+	return boost::none;
+}
+//
+// Lifecycle - Init
+BatchSubmissionController::BatchSubmissionController(Parameters parameters)
+	: did_fail(false)
+{
+	parameters.collect_metrics = false;
+	this->funding.reset(new FormSubmissionController(std::move(parameters)));
+}
+//
+// Accessors
+bool BatchSubmissionController::isAwaitingRandomOuts() const
+{
+	if (this->did_fail) {
+		return false;
+	}
+	for (const auto &transaction : this->transactions) {
+		if (transaction->isAwaitingRandomOuts()) {
+			return true;
+		}
+	}
+	return false;
+}
+//
+// Imperatives
+string BatchSubmissionController::_error_ret_json(const string &err_msg)
+{
+	this->did_fail = true;
+	return error_ret_json_from_message(err_msg);
+}
+string BatchSubmissionController::_failed_ret_json(string ret_json)
+{
+	this->did_fail = true;
+	return ret_json;
+}
+string BatchSubmissionController::_random_outs_request_json()
+{
+	size_t n_amounts = 0;
+	optional<size_t> count;
+	this->requested__n_amounts.assign(this->transactions.size(), 0);
+	for (size_t i = 0; i < this->transactions.size(); ++i) {
+		if (!this->transactions[i]->isAwaitingRandomOuts()) {
+			continue;
+		}
+		const LightwalletAPI_Req_GetRandomOuts &req_params = this->transactions[i]->randomOutsRequest();
+		if (count != boost::none && *count != req_params.count) {
+			return this->_error_ret_json("Transactions of a batch must use the same ring size");
+		}
+		count = req_params.count;
+		this->requested__n_amounts[i] = req_params.amounts.size();
+		n_amounts += req_params.amounts.size();
+	}
+	StreamingJSON::Writer writer(64 + n_amounts * 24);
+	writer.begin_object();
+	writer.key("amounts").begin_array();
+	for (size_t i = 0; i < this->transactions.size(); ++i) {
+		if (this->requested__n_amounts[i] == 0) {
+			continue;
+		}
+		for (const string &amount_string : this->transactions[i]->randomOutsRequest().amounts) {
+			writer.string_value(amount_string);
+		}
+	}
+	writer.end_array();
+	writer.key("count").uint_string_value(count != boost::none ? *count : 0);
+	if (!this->session_id_string.empty()) {
+		writer.key("session_id").string_value(this->session_id_string);
+	}
+	writer.end_object();
+
+	return writer.take();
+}
+string BatchSubmissionController::_signed_txs_json()
+{
+	size_t size = 64;
+	for (const string &signed_tx_json : this->signed_tx_jsons) {
+		size += signed_tx_json.size() + 1;
+	}
+	StreamingJSON::Writer writer(size);
+	writer.begin_object();
+	writer.key("transactions").begin_array();
+	for (const string &signed_tx_json : this->signed_tx_jsons) {
+		writer.raw_value(signed_tx_json.data(), signed_tx_json.data() + signed_tx_json.size());
+	}
+	writer.end_array();
+	writer.end_object();
+
+	return writer.take();
+}
+//
+// Imperatives - Runtime
+string BatchSubmissionController::prepare()
+{
+	const Parameters &parameters = this->funding->parameters;
+	if (parameters.manuallyEnteredPaymentID != boost::none && !parameters.manuallyEnteredPaymentID->empty()) {
+		return this->_error_ret_json("Payment IDs aren't supported in batch sends; use integrated addresses");
+	}
+	if (parameters.send_amount_strings.size() != parameters.enteredAddressValues.size()) {
+		return this->_error_ret_json("Amounts don't match recipients.");
+	}
+	if (parameters.is_sweeping && parameters.enteredAddressValues.size() != 1) {
+		return this->_error_ret_json("Only one recipient allowed when sweeping.");
+	}
+	vector<bool> is_integrated;
+	is_integrated.reserve(parameters.enteredAddressValues.size());
+	for (const string &address : parameters.enteredAddressValues) {
+		cryptonote::address_parse_info info;
+		if (!Addresses::DecodeCache::shared().decode(address, parameters.nettype, info)) {
+			return this->_error_ret_json("Invalid address");
+		}
+		is_integrated.push_back(info.has_payment_id);
+	}
+	vector<uint64_t> sending_amounts;
+	if (!parameters.is_sweeping) {
+		sending_amounts.reserve(parameters.send_amount_strings.size());
+		for (const string &amount_string : parameters.send_amount_strings) {
+			uint64_t amount = 0;
+			if (!cryptonote::parse_amount(amount, amount_string)) {
+				return this->_error_ret_json("Cannot parse amount.");
+			}
+			if (amount == 0) {
+				return this->_error_ret_json("Amount cannot be zero.");
+			}
+			sending_amounts.push_back(amount);
+		}
+	}
+	if (!this->funding->cb_I__got_unspent_outs(this->funding->parameters.unspentOuts)) {
+		return this->_error_ret_json(this->funding->failureMessage());
+	}
+	const vector<SpendableOutput> &unspent_outs = this->funding->unspentOutputs();
+	vector<uint64_t> output_amounts;
+	output_amounts.reserve(unspent_outs.size());
+	for (const SpendableOutput &output : unspent_outs) {
+		output_amounts.push_back(output.amount);
+	}
+	vector<PlannedTransaction> plan;
+	optional<string> err_msg;
+	if (parameters.is_sweeping) {
+		err_msg = plan_batch_sweep(output_amounts, plan);
+	} else {
+		BatchFeeModel fees{ this->funding->feePerByte(), this->funding->feePerOutput(), parameters.priority };
+		err_msg = plan_batch_payout(sending_amounts, is_integrated, output_amounts, fees, plan);
+	}
+	if (err_msg != boost::none) {
+		return this->_error_ret_json(*err_msg);
+	}
+	this->transactions.reserve(plan.size());
+	for (const PlannedTransaction &planned : plan) {
+		Parameters share{};
+		share.is_sweeping = parameters.is_sweeping;
+		share.priority = parameters.priority;
+		share.nettype = parameters.nettype;
+		share.from_address_string = parameters.from_address_string;
+		share.sec_viewKey_string = parameters.sec_viewKey_string;
+		share.sec_spendKey_string = parameters.sec_spendKey_string;
+		share.pub_spendKey_string = parameters.pub_spendKey_string;
+		share.account_keys = parameters.account_keys;
+		share.verify_before_return = parameters.verify_before_return;
+		for (size_t i : planned.destination_indices) {
+			share.enteredAddressValues.push_back(parameters.enteredAddressValues[i]);
+			share.send_amount_strings.push_back(parameters.send_amount_strings[i]);
+		}
+		vector<SpendableOutput> share_outputs;
+		share_outputs.reserve(planned.output_indices.size());
+		for (size_t i : planned.output_indices) {
+			share_outputs.push_back(unspent_outs[i]);
+		}
+		this->transactions.emplace_back(new FormSubmissionController(std::move(share)));
+		this->transactions.back()->defers_verification = true;
+		string ret_json = this->transactions.back()->prepare_share(*this->funding, std::move(share_outputs));
+		if (this->transactions.back()->didFail()) {
+			return this->_failed_ret_json(std::move(ret_json));
+		}
+	}
+	this->signed_tx_jsons.assign(this->transactions.size(), string());
+
+	return this->_random_outs_request_json();
+}
+string BatchSubmissionController::handle(const vector<RandomAmountOutputs> &mix_outs)
+{
+	if (!this->isAwaitingRandomOuts()) {
+		return this->_error_ret_json("Not expecting random outs");
+	}
+	vector<size_t> awaiting;
+	vector<size_t> offsets;
+	size_t n_amounts = 0;
+	for (size_t i = 0; i < this->transactions.size(); ++i) {
+		if (this->requested__n_amounts[i] != 0 || this->transactions[i]->isAwaitingRandomOuts()) {
+			awaiting.push_back(i);
+			offsets.push_back(n_amounts);
+			n_amounts += this->requested__n_amounts[i];
+		}
+	}
+	if (mix_outs.size() != n_amounts) {
+		return this->_error_ret_json("Wrong number of mix outputs provided");
+	}
+	// the transactions are independent, so they're signed in parallel
+	vector<string> ret_jsons(awaiting.size());
+	Runtime::WorkerPool::shared().parallel_for(awaiting.size(), 1, [&](size_t begin, size_t end) {
+		for (size_t j = begin; j < end; ++j) {
+			size_t i = awaiting[j];
+			vector<RandomAmountOutputs> share_mix_outs(
+				mix_outs.begin() + offsets[j],
+				mix_outs.begin() + offsets[j] + this->requested__n_amounts[i]
+			);
+			ret_jsons[j] = this->transactions[i]->handle(share_mix_outs);
+		}
+	});
+	for (size_t j = 0; j < awaiting.size(); ++j) {
+		size_t i = awaiting[j];
+		if (this->transactions[i]->didFail()) {
+			return this->_failed_ret_json(std::move(ret_jsons[j]));
+		}
+		if (!this->transactions[i]->isAwaitingRandomOuts()) {
+			this->signed_tx_jsons[i] = std::move(ret_jsons[j]);
+		}
+	}
+	if (this->isAwaitingRandomOuts()) { // some transactions' fees converged on more inputs
+		return this->_random_outs_request_json();
+	}
+	this->requested__n_amounts.assign(this->transactions.size(), 0);
+	if (this->funding->parameters.verify_before_return) { // one batch of range proofs for the whole payout
+		vector<const SignedTransaction *> signed_txs;
+		signed_txs.reserve(this->transactions.size());
+		for (const unique_ptr<FormSubmissionController> &transaction : this->transactions) {
+			signed_txs.push_back(transaction->signedTransaction());
+		}
+		optional<string> err_msg = verify_signed_transactions(signed_txs);
+		if (err_msg != boost::none) {
+			return this->_error_ret_json("Signed transactions failed verification: " + *err_msg);
+		}
+	}
+
+	return this->_signed_txs_json();
+}
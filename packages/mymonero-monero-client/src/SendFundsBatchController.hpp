@@ -0,0 +1,118 @@
+//
+//  SendFundsBatchController.hpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#ifndef SendFundsBatchController_hpp
+#define SendFundsBatchController_hpp
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <boost/optional/optional.hpp>
+#include "SendFundsFormSubmissionController.hpp"
+
+namespace SendFunds
+{
+	using namespace std;
+	using namespace boost;
+	//
+	// Batch sends - a payout to more destinations than fit in one transaction, or a sweep of more
+	// outputs than fit in one, is planned up front into the fewest transactions which are each
+	// within the limits below, rather than failing with transactionTooBig. Every transaction of the
+	// batch is its own FormSubmissionController spending a disjoint share of the wallet's outputs.
+	//
+	// Limits
+	static const size_t batch__max_destinations_per_tx = 15; // 16 outputs per bulletproof, less change
+	static const size_t batch__max_inputs_per_tx = 120; // ~100 kB at ring size 16, well under the weight limit
+	//
+	// Planning
+	struct BatchFeeModel
+	{ // deliberately pessimistic; a share only has to fund what step1 will actually charge
+		uint64_t fee_per_b;
+		uint64_t fee_per_o;
+		uint32_t priority;
+		//
+		uint64_t reserve(size_t n_inputs, size_t n_outputs) const;
+	};
+	struct PlannedTransaction
+	{
+		vector<size_t> destination_indices;
+		vector<size_t> output_indices; // into the wallet's unspent outputs
+	};
+	// Returns the error, if any. At most one integrated address goes in each transaction.
+	optional<string> plan_batch_payout(
+		const vector<uint64_t> &sending_amounts,
+		const vector<bool> &is_integrated,
+		const vector<uint64_t> &output_amounts,
+		const BatchFeeModel &fees,
+		vector<PlannedTransaction> &out__plan
+	);
+	optional<string> plan_batch_sweep(const vector<uint64_t> &output_amounts, vector<PlannedTransaction> &out__plan);
+	//
+	// Controllers
+	class BatchSubmissionController
+	{
+	public:
+		//
+		// Lifecycle - Init
+		BatchSubmissionController(Parameters parameters);
+		//
+		// Set by the bridge which owns this controller; echoed back in random outs requests
+		string session_id_string;
+		//
+		// Imperatives - Runtime
+		// prepare() and handle() return the same documents as FormSubmissionController's, except
+		// that one random outs request covers every transaction which is waiting for decoys and
+		// the final document is { transactions: [ <signed tx document>, ... ] }
+		string prepare();
+		string handle(const vector<RandomAmountOutputs> &mix_outs);
+		//
+		// Accessors
+		bool didFail() const { return this->did_fail; }
+		bool isAwaitingRandomOuts() const;
+	private:
+		//
+		// Properties - Instance members
+		unique_ptr<FormSubmissionController> funding; // decodes the wallet's outputs once, for every share
+		vector<unique_ptr<FormSubmissionController>> transactions;
+		vector<size_t> requested__n_amounts; // per transaction, its part of the outstanding request
+		vector<string> signed_tx_jsons;
+		bool did_fail;
+		//
+		// Imperatives
+		string _error_ret_json(const string &err_msg);
+		string _failed_ret_json(string ret_json); // a transaction's own error document
+		string _random_outs_request_json();
+		string _signed_txs_json();
+	};
+}
+
+#endif /* SendFundsBatchController_hpp */
@@ -38,40 +38,142 @@
 #include "monero_paymentID_utils.hpp"
 #include "monero_send_routine.hpp"
 #include "serial_bridge_utils.hpp"
+#include "KeyImages.hpp"
+#include "StreamingJSON.hpp"
+#include "AddressDecoding.hpp"
+#include "SendFundsBatchController.hpp"
 using namespace monero_send_routine;
 using namespace monero_transfer_utils;
 using namespace SendFunds;
 using namespace serial_bridge_utils;
 
+#include <algorithm>
 #include <boost/optional/optional_io.hpp>
-#include <boost/property_tree/ptree.hpp>
-#include <boost/property_tree/json_parser.hpp>
+#include "memwipe.h"
 using namespace boost;
 
-string FormSubmissionController::handle(const property_tree::ptree res)
+static void _wipe(string &str)
 {
-	this->randomOuts = res;
+	if (!str.empty()) {
+		memwipe(&str[0], str.size());
+	}
+}
+FormSubmissionController::~FormSubmissionController()
+{ // crypto::secret_keys scrub themselves; these strings don't
+	_wipe(this->parameters.sec_viewKey_string);
+	_wipe(this->parameters.sec_spendKey_string);
+	if (this->step2_retVals__tx_key_string != boost::none) {
+		_wipe(*this->step2_retVals__tx_key_string);
+	}
+}
 
-	const bool step2 = this->cb_II__got_random_outs(this->randomOuts);
-	if (!step2) {
-	 	return error_ret_json_from_message(this->failureReason);
+bool SendFunds::find_spent_outputs(KeyImages::Deriver &deriver, const vector<UnspentOutput> &outputs, vector<bool> &out__is_spent)
+{
+	out__is_spent.assign(outputs.size(), false);
+	vector<KeyImages::OutputRef> to_check;
+	vector<size_t> to_check__output_indices;
+	for (size_t i = 0; i < outputs.size(); ++i) {
+		if (outputs[i].spend_key_images.empty()) {
+			continue;
+		}
+		KeyImages::OutputRef ref;
+		if (!epee::string_tools::hex_to_pod(outputs[i].spendable.tx_pub_key, ref.tx_pub_key)) {
+			return false;
+		}
+		ref.out_index = outputs[i].spendable.index;
+		to_check.push_back(ref);
+		to_check__output_indices.push_back(i);
+	}
+	vector<crypto::key_image> key_images;
+	if (deriver.key_images(to_check, key_images) != boost::none) {
+		return false;
+	}
+	for (size_t j = 0; j < to_check.size(); ++j) {
+		const vector<crypto::key_image> &candidates = outputs[to_check__output_indices[j]].spend_key_images;
+		out__is_spent[to_check__output_indices[j]] = std::find(candidates.begin(), candidates.end(), key_images[j]) != candidates.end();
 	}
-	return this->cb_III__submitted_tx();
+
+	return true;
 }
 
-string FormSubmissionController::prepare()
+string FormSubmissionController::_error_ret_json(const string &err_msg)
+{
+	this->did_fail = true;
+	SendFundsMetrics::count(SendFundsMetrics::failed);
+	return error_ret_json_from_message(err_msg);
+}
+
+string FormSubmissionController::_random_outs_request_json(const LightwalletAPI_Req_GetRandomOuts &req_params)
+{
+	this->random_outs_request = req_params;
+	SendFundsMetrics::Stopwatch stopwatch;
+	StreamingJSON::Writer writer(64 + req_params.amounts.size() * 24);
+	writer.begin_object();
+	writer.key("amounts").begin_array();
+	for (const string &amount_string : req_params.amounts) {
+		writer.string_value(amount_string);
+	}
+	writer.end_array();
+	writer.key("count").uint_string_value(req_params.count);
+	if (!this->session_id_string.empty()) {
+		writer.key("session_id").string_value(this->session_id_string);
+	}
+	this->metrics.record(stopwatch, SendFundsMetrics::serializeResponse);
+	this->metrics.write(writer);
+	writer.end_object();
+
+	return writer.take();
+}
+
+string FormSubmissionController::handle(const vector<RandomAmountOutputs> &mix_outs)
 {
-	using namespace std;
-	using namespace boost;
+	if (this->valsState != WAIT_FOR_STEP2) {
+		return this->_error_ret_json("Not expecting random outs");
+	}
+	const vector<RandomAmountOutputs> no_mix_outs;
+	const vector<RandomAmountOutputs> *attempt_mix_outs = &mix_outs;
+	while (true) {
+		this->must_reconstruct = false;
+		const bool step2 = this->cb_II__got_random_outs(*attempt_mix_outs);
+		if (step2) {
+			this->valsState = WAIT_FOR_FINISH;
+			if (this->signed_transaction != boost::none && !this->defers_verification) {
+				SendFundsMetrics::Stopwatch verify_stopwatch;
+				optional<string> err_msg = verify_signed_transactions({ &*this->signed_transaction });
+				this->metrics.record(verify_stopwatch, SendFundsMetrics::verifyTransaction);
+				if (err_msg != boost::none) {
+					return this->_error_ret_json("Signed transaction failed verification: " + *err_msg);
+				}
+			}
+			return this->cb_III__submitted_tx();
+		}
+		if (!this->must_reconstruct) {
+			return this->_error_ret_json(this->failureReason);
+		}
+		// cb_II has re-run step1 at the fee actually needed; inputs carried over from the last
+		// attempt keep their decoys, so only newly selected inputs need a trip to the server
+		auto req_params = new__req_params__get_random_outs(
+			this->step1_retVals__using_outs,
+			this->prior_attempt_unspent_outs_to_mix_outs
+		);
+		if (!req_params.amounts.empty()) {
+			this->valsState = WAIT_FOR_STEP2;
+			return this->_random_outs_request_json(req_params);
+		}
+		attempt_mix_outs = &no_mix_outs;
+	}
+}
 
+optional<string> FormSubmissionController::_set_up_destinations()
+{ // returns the error, if any
 	this->sending_amounts.clear();
  	if (this->parameters.send_amount_strings.size() != this->parameters.enteredAddressValues.size()) {
- 		return error_ret_json_from_message("Amounts don't match recipients.");
+ 		return string("Amounts don't match recipients.");
  	}
 
 	if (this->parameters.is_sweeping) {
 		if (this->parameters.enteredAddressValues.size() != 1) {
- 			return error_ret_json_from_message("Only one recipient allowed when sweeping.");
+ 			return string("Only one recipient allowed when sweeping.");
  		}
                 this->sending_amounts.push_back(0);
 	} else {
@@ -79,10 +181,10 @@ string FormSubmissionController::prepare()
  		for (const auto& amount : this->parameters.send_amount_strings) {
  			uint64_t parsed_amount;
  			if (!cryptonote::parse_amount(parsed_amount, amount)) {
- 				return error_ret_json_from_message("Cannot parse amount.");
+ 				return string("Cannot parse amount.");
  			}
  			if (parsed_amount == 0) {
- 				return error_ret_json_from_message("Amount cannot be zero.");
+ 				return string("Amount cannot be zero.");
  			}
  			this->sending_amounts.push_back(parsed_amount);
 		}
@@ -100,36 +202,36 @@ string FormSubmissionController::prepare()
  	this->to_address_strings.clear();
  	this->to_address_strings.reserve(this->parameters.enteredAddressValues.size());
  	for (string& xmrAddress_toDecode : this->parameters.enteredAddressValues) {
- 		auto decode_retVals = monero::address_utils::decodedAddress(xmrAddress_toDecode, this->parameters.nettype);
- 		if (decode_retVals.did_error) {
- 			return error_ret_json_from_message("Invalid address");
+ 		cryptonote::address_parse_info decoded_info; // through the shared cache, as payouts tend to repeat recipients
+ 		if (!Addresses::DecodeCache::shared().decode(xmrAddress_toDecode, this->parameters.nettype, decoded_info)) {
+ 			return string("Invalid address");
  		}
 		// since we may have a payment ID here (which may also have been entered manually), validate
 		if (monero_paymentID_utils::is_a_valid_or_not_a_payment_id(paymentID_toUseOrToNilIfIntegrated) == false) { // convenience function - will be true if nil pid
-			return error_ret_json_from_message("PID is not valid");
+			return string("PID is not valid");
 		}
-		if (decode_retVals.paymentID_string != boost::none) { // is integrated address!
+		if (decoded_info.has_payment_id) { // is integrated address!
 			this->to_address_strings.emplace_back(std::move(xmrAddress_toDecode));
 			if (this->isXMRAddressIntegrated) {
-				return error_ret_json_from_message("Only one integrated address allowed per transaction");
+				return string("Only one integrated address allowed per transaction");
 			}
 			this->payment_id_string = boost::none;
 			this->isXMRAddressIntegrated = true;
-			this->integratedAddressPIDForDisplay = *decode_retVals.paymentID_string;
+			this->integratedAddressPIDForDisplay = epee::string_tools::pod_to_hex(decoded_info.payment_id);
 		}
-		else if (paymentID_toUseOrToNilIfIntegrated != boost::none && !paymentID_toUseOrToNilIfIntegrated->empty() && !decode_retVals.isSubaddress && 
+		else if (paymentID_toUseOrToNilIfIntegrated != boost::none && !paymentID_toUseOrToNilIfIntegrated->empty() && !decoded_info.is_subaddress && 
                          paymentID_toUseOrToNilIfIntegrated->size() == monero_paymentID_utils::payment_id_length__short) {  // no subaddress, short pid provided, will make integrated address
-				THROW_WALLET_EXCEPTION_IF(decode_retVals.isSubaddress, error::wallet_internal_error, "Expected !decode_retVals.isSubaddress"); // just an extra safety measure
+				THROW_WALLET_EXCEPTION_IF(decoded_info.is_subaddress, error::wallet_internal_error, "Expected !decoded_info.is_subaddress"); // just an extra safety measure
 				optional<string> fabricated_integratedAddress_orNone = monero::address_utils::new_integratedAddrFromStdAddr( // construct integrated address
 					xmrAddress_toDecode, // the monero one
 					*paymentID_toUseOrToNilIfIntegrated, // short pid
 					this->parameters.nettype
 				);
 				if (fabricated_integratedAddress_orNone == boost::none) {
-					return error_ret_json_from_message("Could not construct integrated address");
+					return string("Could not construct integrated address");
 				}
 				if (this->isXMRAddressIntegrated) {
-                                	return error_ret_json_from_message("Only one integrated address allowed per transaction");
+                                	return string("Only one integrated address allowed per transaction");
                         	}
 				this->to_address_strings.emplace_back(*fabricated_integratedAddress_orNone);
 				this->payment_id_string = boost::none; // must now zero this or Send will throw a "pid must be blank with integrated addr"
@@ -145,42 +247,71 @@ string FormSubmissionController::prepare()
 		} 
  	}
 
+	return boost::none;
+}
+
+string FormSubmissionController::prepare()
+{
+	optional<string> err_msg = this->_set_up_destinations();
+	if (err_msg != boost::none) {
+		return this->_error_ret_json(*err_msg);
+	}
+	SendFundsMetrics::Stopwatch decrypt_stopwatch;
 	const bool step1 = this->cb_I__got_unspent_outs(this->parameters.unspentOuts);
+	this->metrics.record(decrypt_stopwatch, SendFundsMetrics::decryptOutputs);
 	if (!step1) {
-		return error_ret_json_from_message(this->failureReason);
+		return this->_error_ret_json(this->failureReason);
 	}
 
+	return this->_begin_construction();
+}
+
+string FormSubmissionController::prepare_share(const FormSubmissionController &funding, vector<SpendableOutput> outputs)
+{
+	optional<string> err_msg = this->_set_up_destinations();
+	if (err_msg != boost::none) {
+		return this->_error_ret_json(*err_msg);
+	}
+	this->unspent_outs = std::move(outputs);
+	this->fee_per_b = funding.fee_per_b;
+	this->fee_per_o = funding.fee_per_o;
+	this->fee_mask = funding.fee_mask;
+	this->use_fork_rules = funding.use_fork_rules;
+	//
+	this->prior_attempt_size_calcd_fee = boost::none;
+	this->prior_attempt_unspent_outs_to_mix_outs = boost::none;
+	this->constructionAttempt = 0;
+	this->metrics.attempt = 0;
+
+	return this->_begin_construction();
+}
+
+string FormSubmissionController::_begin_construction()
+{
 	const bool reenter = this->_reenterable_construct_and_send_tx();
 	if (!reenter) {
-		return error_ret_json_from_message(this->failureReason);
+		return this->_error_ret_json(this->failureReason);
 	}
 	auto req_params = new__req_params__get_random_outs(
 		this->step1_retVals__using_outs, // use the one on the heap, since we've moved the one from step1_retVals
 		this->prior_attempt_unspent_outs_to_mix_outs // mix out used in prior tx construction attempts
   	);
-	//this->randomOuts = this->get_random_outs(req_params);
-	boost::property_tree::ptree req_params_root;
-		boost::property_tree::ptree amounts_ptree;
-		BOOST_FOREACH(const string &amount_string, req_params.amounts)
-		{
-			property_tree::ptree amount_child;
-			amount_child.put("", amount_string);
-			amounts_ptree.push_back(std::make_pair("", amount_child));
-		}
-		req_params_root.add_child("amounts", amounts_ptree);
-		req_params_root.put("count", req_params.count);
-		stringstream req_params_ss;
-		boost::property_tree::write_json(req_params_ss, req_params_root, false/*pretty*/);
+	this->valsState = WAIT_FOR_STEP2;
+	SendFundsMetrics::count(SendFundsMetrics::prepared);
 
-	return req_params_ss.str().c_str();
+	return this->_random_outs_request_json(req_params);
 }
 
-bool FormSubmissionController::cb_I__got_unspent_outs(const optional<property_tree::ptree> &res)
+bool FormSubmissionController::cb_I__got_unspent_outs(UnspentOuts &res)
 {
 	crypto::secret_key sec_viewKey{};
 	crypto::secret_key sec_spendKey{};
 	crypto::public_key pub_spendKey{};
-	{
+	if (this->parameters.account_keys != boost::none) {
+		sec_viewKey = this->parameters.account_keys->sec_viewKey;
+		sec_spendKey = this->parameters.account_keys->sec_spendKey;
+		pub_spendKey = this->parameters.account_keys->pub_spendKey;
+	} else {
 		bool r = false;
 		r = epee::string_tools::hex_to_pod(this->parameters.sec_viewKey_string, sec_viewKey);
 		if (!r) {
@@ -198,8 +329,8 @@ bool FormSubmissionController::cb_I__got_unspent_outs(const optional<property_tr
 			return false;
 		}
 	}
-	auto parsed_res = new__parsed_res__get_unspent_outs(
-		res.get(),
+	auto parsed_res = new__parsed_res__get_unspent_outs( // only the fee and fork fields - the outputs were decoded by the bridge
+		res.fields,
 		sec_viewKey,
 		sec_spendKey,
 		pub_spendKey
@@ -208,20 +339,56 @@ bool FormSubmissionController::cb_I__got_unspent_outs(const optional<property_tr
 		this->failureReason = std::move(*(parsed_res.err_msg));
 		return false;
 	}
-	this->unspent_outs = std::move(*(parsed_res.unspent_outs));
+	vector<bool> is_spent;
+	bool did_find_spent_outputs = false;
+	{
+		KeyImages::Deriver deriver(sec_viewKey, sec_spendKey, &this->arena);
+		did_find_spent_outputs = find_spent_outputs(deriver, res.outputs, is_spent);
+	}
+	this->arena.reset(); // the derivations are done with; wipe them now rather than at the end of the session
+	if (!did_find_spent_outputs) {
+		this->failureReason = "Unable to generate key image";
+		return false;
+	}
+	this->unspent_outs.clear();
+	this->unspent_outs.reserve(res.outputs.size());
+	for (size_t i = 0; i < res.outputs.size(); ++i) {
+		if (!is_spent[i]) {
+			this->unspent_outs.push_back(std::move(res.outputs[i].spendable));
+		}
+	}
+	res.outputs.clear();
+	res.outputs.shrink_to_fit();
 	this->fee_per_b = *(parsed_res.fee_per_byte);
 	this->fee_per_o = *(parsed_res.fee_per_output);
 	this->fee_mask = *(parsed_res.quantization_mask);
 	this->use_fork_rules = monero_fork_rules::make_use_fork_rules_fn(parsed_res.fork_version);
+	if (this->parameters.select_unspent_outs) {
+		uint64_t amount = 0;
+		for (uint64_t sending_amount : this->sending_amounts) {
+			amount = sending_amount > UINT64_MAX - amount ? UINT64_MAX : amount + sending_amount;
+		}
+		const BatchFeeModel fees{ this->fee_per_b, this->fee_per_o, this->parameters.priority };
+		const size_t n_outputs = this->to_address_strings.size() + 1; // plus change
+		optional<string> err_msg = this->parameters.select_unspent_outs(amount, [&fees, n_outputs](size_t n_inputs) {
+			return fees.reserve(n_inputs, n_outputs);
+		}, this->unspent_outs);
+		if (err_msg != boost::none) {
+			this->failureReason = std::move(*err_msg);
+			return false;
+		}
+	}
 	//
 	this->prior_attempt_size_calcd_fee = boost::none;
   	this->prior_attempt_unspent_outs_to_mix_outs = boost::none;
 	this->constructionAttempt = 0;
+	this->metrics.attempt = 0;
 
 	return true;
 }
 bool FormSubmissionController::_reenterable_construct_and_send_tx()
 {
+	SendFundsMetrics::Stopwatch stopwatch;
 	Send_Step1_RetVals step1_retVals;
 	monero_transfer_utils::send_step1__prepare_params_for_get_decoys(
 		step1_retVals,
@@ -240,6 +407,7 @@ bool FormSubmissionController::_reenterable_construct_and_send_tx()
 		// ^- and this will be 'none' as initial value
     this->prior_attempt_unspent_outs_to_mix_outs // on re-entry, re-use the same outs and requested decoys, in order to land on the correct calculated fee
 	);
+	this->metrics.record(stopwatch, SendFundsMetrics::selectOutputs);
 	if (step1_retVals.errCode != noError) {
 		this->failureReason = "Not enough spendables";
 		return false;
@@ -257,26 +425,18 @@ bool FormSubmissionController::_reenterable_construct_and_send_tx()
 	
 	return true;
 }
-bool FormSubmissionController::cb_II__got_random_outs(const optional<property_tree::ptree> &res) {
-	auto parsed_res = res ? new__parsed_res__get_random_outs(res.get()) : LightwalletAPI_Res_GetRandomOuts{ boost::none/*err_msg*/, vector<RandomAmountOutputs>{}/*mix_outs*/ };
-	if (parsed_res.err_msg != boost::none) {
-		this->failureReason = std::move(*(parsed_res.err_msg));
-		return false;
-	}
-	if (parsed_res.err_msg != boost::none) {
-		this->failureReason = "Expected non-0 using_outs";
-		return false;
-	}
-
+bool FormSubmissionController::cb_II__got_random_outs(const vector<RandomAmountOutputs> &mix_outs) {
+	SendFundsMetrics::Stopwatch tie_stopwatch;
   Tie_Outs_to_Mix_Outs_RetVals tie_outs_to_mix_outs_retVals;
 	monero_transfer_utils::pre_step2_tie_unspent_outs_to_mix_outs_for_all_future_tx_attempts(
 		tie_outs_to_mix_outs_retVals,
 		//
 		this->step1_retVals__using_outs,
-		*(parsed_res.mix_outs),
+		mix_outs,
 		//
 		this->prior_attempt_unspent_outs_to_mix_outs
 	);
+	this->metrics.record(tie_stopwatch, SendFundsMetrics::tieOutsToMixOuts);
 	if (tie_outs_to_mix_outs_retVals.errCode != noError) {
     this->failureReason = "Cant tie unspent outs to mix outs";
 		return false;
@@ -285,6 +445,7 @@ bool FormSubmissionController::cb_II__got_random_outs(const optional<property_tr
 	const vector<uint64_t> &sending_amounts = this->parameters.is_sweeping ?
 		vector<uint64_t>{*this->step1_retVals__final_total_wo_fee}
  		: this->sending_amounts;
+	SendFundsMetrics::Stopwatch sign_stopwatch;
 	Send_Step2_RetVals step2_retVals;
 	uint64_t unlock_time = 0; // hard-coded for now since we don't ever expose it, presently
 	monero_transfer_utils::send_step2__try_create_transaction(
@@ -308,6 +469,7 @@ bool FormSubmissionController::cb_II__got_random_outs(const optional<property_tr
 		unlock_time,
 		this->parameters.nettype
 	);
+	this->metrics.record(sign_stopwatch, SendFundsMetrics::signTransaction);
 	if (step2_retVals.errCode != noError) {
 		switch (step2_retVals.errCode) {
             		case noError:
@@ -397,6 +559,8 @@ bool FormSubmissionController::cb_II__got_random_outs(const optional<property_tr
 		this->valsState = WAIT_FOR_STEP1; // must reset this
 		//
 		this->constructionAttempt += 1; // increment for re-entry
+		this->metrics.attempt = (uint32_t)this->constructionAttempt;
+		SendFundsMetrics::count(SendFundsMetrics::reconstructed);
 		this->prior_attempt_size_calcd_fee = step2_retVals.fee_actually_needed; // -> reconstruction attempt's step1's prior_attempt_size_calcd_fee
 		this->prior_attempt_unspent_outs_to_mix_outs = tie_outs_to_mix_outs_retVals.prior_attempt_unspent_outs_to_mix_outs_new;
 		// reset step1 vals for correctness: (otherwise we end up, for example, with duplicate outs added)
@@ -411,7 +575,10 @@ bool FormSubmissionController::cb_II__got_random_outs(const optional<property_tr
 		this->step2_retVals__tx_key_string = boost::none;
 		this->step2_retVals__tx_pub_key_string = boost::none;
 		//
-		_reenterable_construct_and_send_tx();
+		if (!this->_reenterable_construct_and_send_tx()) {
+			return false;
+		}
+		this->must_reconstruct = true; // handle() picks it up from here
 		return false;
 	}
 	// move step2 vals onto heap for later:
@@ -419,6 +586,13 @@ bool FormSubmissionController::cb_II__got_random_outs(const optional<property_tr
 	this->step2_retVals__tx_hash_string = *(step2_retVals.tx_hash_string);
 	this->step2_retVals__tx_key_string = *(step2_retVals.tx_key_string);
 	this->step2_retVals__tx_pub_key_string = *(step2_retVals.tx_pub_key_string);
+	if (this->parameters.verify_before_return) {
+		this->signed_transaction = SignedTransaction{
+			*this->step2_retVals__signed_serialized_tx_string,
+			this->step1_retVals__using_outs,
+			std::move(tie_outs_to_mix_outs_retVals.mix_outs)
+		};
+	}
 
 	return true;
 }
@@ -438,14 +612,16 @@ string FormSubmissionController::cb_III__submitted_tx()
 	// success_retVals.integratedAddressPIDForDisplay = this->integratedAddressPIDForDisplay;
 	// XXX success_retVals.target_address = this->to_address_string;
 
-	boost::property_tree::ptree root;
-	root.put("used_fee", std::move(RetVals_Transforms::str_from(*(this->step1_retVals__using_fee))));  // NOTE: not the same thing as step2_retVals.fee_actually_needed
-	root.put("total_sent", std::move(RetVals_Transforms::str_from(*(this->step1_retVals__final_total_wo_fee) + *(this->step1_retVals__using_fee))));
-	root.put("mixin", *(this->step1_retVals__mixin)); // this is a uint32 so it can be sent in JSON
-	root.put("serialized_signed_tx", std::move(*(this->step2_retVals__signed_serialized_tx_string)));
-	root.put("tx_hash", std::move(*(this->step2_retVals__tx_hash_string)));
-	root.put("tx_key", std::move(*(this->step2_retVals__tx_key_string)));
-	root.put("tx_pub_key", std::move(*(this->step2_retVals__tx_pub_key_string)));
+	SendFundsMetrics::Stopwatch stopwatch;
+	StreamingJSON::Writer writer(this->step2_retVals__signed_serialized_tx_string->size() + 1024);
+	writer.begin_object();
+	writer.key("used_fee").uint_string_value(*(this->step1_retVals__using_fee)); // NOTE: not the same thing as step2_retVals.fee_actually_needed
+	writer.key("total_sent").uint_string_value(*(this->step1_retVals__final_total_wo_fee) + *(this->step1_retVals__using_fee));
+	writer.key("mixin").uint_string_value(*(this->step1_retVals__mixin));
+	writer.key("serialized_signed_tx").string_value(*(this->step2_retVals__signed_serialized_tx_string));
+	writer.key("tx_hash").string_value(*(this->step2_retVals__tx_hash_string));
+	writer.key("tx_key").string_value(*(this->step2_retVals__tx_key_string));
+	writer.key("tx_pub_key").string_value(*(this->step2_retVals__tx_pub_key_string));
 	string target_address_str;
 	size_t nTargAddrs = this->to_address_strings.size();
         for (size_t i = 0; i < nTargAddrs; ++i){
@@ -467,12 +643,16 @@ string FormSubmissionController::cb_III__submitted_tx()
 			}
 		}
 	}
-	root.put("target_address", target_address_str); 
-	root.put("final_total_wo_fee", std::move(RetVals_Transforms::str_from(*(this->step1_retVals__final_total_wo_fee))));
-	root.put("isXMRAddressIntegrated", std::move(RetVals_Transforms::str_from(this-isXMRAddressIntegrated)));
+	writer.key("target_address").string_value(target_address_str);
+	writer.key("final_total_wo_fee").uint_string_value(*(this->step1_retVals__final_total_wo_fee));
+	writer.key("isXMRAddressIntegrated").bool_string_value(this->isXMRAddressIntegrated);
 	if (this->integratedAddressPIDForDisplay) {
-		root.put("integratedAddressPIDForDisplay", std::move(*(this->integratedAddressPIDForDisplay)));
+		writer.key("integratedAddressPIDForDisplay").string_value(*(this->integratedAddressPIDForDisplay));
 	}
+	this->metrics.record(stopwatch, SendFundsMetrics::serializeResponse);
+	this->metrics.write(writer);
+	writer.end_object();
+	SendFundsMetrics::count(SendFundsMetrics::signed_tx);
 
-	return ret_json_from_root(root).c_str();
+	return writer.take();
 }
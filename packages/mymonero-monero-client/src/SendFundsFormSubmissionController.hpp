@@ -39,9 +39,14 @@
 #include <memory>
 #include <boost/optional/optional.hpp>
 #include <boost/locale.hpp>
+#include <boost/property_tree/ptree.hpp>
 #include "cryptonote_config.h"
 #include "monero_send_routine.hpp"
 #include "monero_fork_rules.hpp"
+#include "SendFundsMetrics.hpp"
+#include "Arena.hpp"
+#include "WalletContext.hpp"
+#include "TransactionVerification.hpp"
 
 namespace SendFunds
 {
@@ -110,6 +115,20 @@ namespace SendFunds
 		string tx_key_string; // this includes additional_tx_keys
 		string tx_pub_key_string; // from get_tx_pub_key_from_extra()
 	};
+	struct UnspentOutput
+	{
+		SpendableOutput spendable;
+		vector<crypto::key_image> spend_key_images; // candidates reported by the server; checked against our own key image in cb_I
+	};
+	struct UnspentOuts
+	{
+		property_tree::ptree fields; // the get_unspent_outs response minus its outputs, i.e. fee and fork fields
+		vector<UnspentOutput> outputs;
+	};
+	// Flags the outputs which have spend candidates and are really spent, by the wallet's own key
+	// image - derived as one batch, which runs on the WorkerPool when large. The server can't tell
+	// whether a candidate spend is ours. Returns false if a key image can't be derived.
+	bool find_spent_outputs(KeyImages::Deriver &deriver, const vector<UnspentOutput> &outputs, vector<bool> &out__is_spent);
 	struct Parameters
 	{
 		vector<string> send_amount_strings;
@@ -121,11 +140,18 @@ namespace SendFunds
 		string sec_viewKey_string;
 		string sec_spendKey_string;
 		string pub_spendKey_string;
+		optional<Wallet::AccountKeys> account_keys; // parsed already, when the send came through a wallet context
+		// Set when the send spends from a wallet context's output index rather than unspentOuts.outputs.
+		// cb_I calls it once the fees are known, with the amount to send and the fee to reserve. Returns the error, if any.
+		std::function<optional<string>(uint64_t amount, const Outputs::FeeReserveFn &reserve, vector<SpendableOutput> &out__outputs)> select_unspent_outs;
 		//
 		vector<string> enteredAddressValues;
 		//
 		optional<string> manuallyEnteredPaymentID;
-		property_tree::ptree unspentOuts;
+		UnspentOuts unspentOuts;
+		//
+		bool collect_metrics; // responses carry a metrics object with per-phase timings
+		bool verify_before_return; // the signed transaction is verified before it is returned; see verify_signed_transactions
 	};
 	//
 	// Controllers
@@ -136,13 +162,29 @@ namespace SendFunds
 		// Lifecycle - Init
 		FormSubmissionController(Parameters parameters)
 		{
-			this->parameters = parameters;
+			this->parameters = std::move(parameters);
 			this->valsState = WAIT_FOR_HANDLE;
+			this->did_fail = false;
+			this->must_reconstruct = false;
+			this->defers_verification = false;
+			this->metrics.enabled = this->parameters.collect_metrics;
 		}
+		~FormSubmissionController(); // wipes the secrets held as hex
+		FormSubmissionController(const FormSubmissionController &) = delete;
+		FormSubmissionController &operator=(const FormSubmissionController &) = delete;
 		//
 		// Constructor args
 		Parameters parameters;
 		//
+		// Set by the bridge which owns this controller; echoed back by prepare()
+		string session_id_string;
+		//
+		// Per-phase samples of this send; the bridge records parseArgs
+		SendFundsMetrics::Recorder metrics;
+		//
+		// Set by a batch, which verifies all of its transactions together rather than each in handle()
+		bool defers_verification;
+		//
 		// Remaining initialization args
 		std::function<void(void)> get_unspent_outs;
 		std::function<void(void)> get_random_outs;
@@ -150,25 +192,42 @@ namespace SendFunds
 		std::function<void(void)> authenticate_fn;
 		//
 		// Imperatives - Runtime
-		string handle(const property_tree::ptree res);
+		// Returns the signed tx, an error, or - when fee convergence selected inputs which have no
+		// decoys yet - another random outs request to be answered with a further call to handle()
+		string handle(const vector<RandomAmountOutputs> &mix_outs);
 		string prepare();
+		// As prepare(), for one transaction of a batch send: spends only `outputs`, which the batch
+		// took from `funding`'s already decoded unspent outputs, at `funding`'s fees
+		string prepare_share(const FormSubmissionController &funding, vector<SpendableOutput> outputs);
 		// void cb__authentication(bool did_pass/*false means canceled*/);
-		bool cb_I__got_unspent_outs(const optional<property_tree::ptree> &res);
-		bool cb_II__got_random_outs(const optional<property_tree::ptree> &res);
+		bool cb_I__got_unspent_outs(UnspentOuts &res); // consumes res.outputs
+		bool cb_II__got_random_outs(const vector<RandomAmountOutputs> &mix_outs);
 		string cb_III__submitted_tx();
+		//
+		// Accessors
+		bool didFail() const { return this->did_fail; }
+		bool isAwaitingRandomOuts() const { return this->valsState == WAIT_FOR_STEP2 && !this->did_fail; }
+		const LightwalletAPI_Req_GetRandomOuts &randomOutsRequest() const { return this->random_outs_request; } // the last one returned
+		const string &failureMessage() const { return this->failureReason; }
+		const vector<SpendableOutput> &unspentOutputs() const { return this->unspent_outs; } // after cb_I, less those already spent
+		uint64_t feePerByte() const { return this->fee_per_b; }
+		uint64_t feePerOutput() const { return this->fee_per_o; }
+		const SignedTransaction *signedTransaction() const { return this->signed_transaction ? &*this->signed_transaction : NULL; } // with verify_before_return, once signed
 	private:
 		//
 		// Properties - Instance members
 		// - state
 		_Send_Task_ValsState valsState;
 		string failureReason;
+		bool did_fail;
+		bool must_reconstruct; // set by cb_II when the fee it signed with was too low
 		// - from setup
-		property_tree::ptree randomOuts;
 		vector<uint64_t> sending_amounts;
  		vector<string> to_address_strings;
 		optional<string> payment_id_string;
 		bool isXMRAddressIntegrated;
 		optional<string> integratedAddressPIDForDisplay;
+		LightwalletAPI_Req_GetRandomOuts random_outs_request;
 		// - from cb_i
 		vector<SpendableOutput> unspent_outs;
 		uint64_t fee_per_b;
@@ -190,8 +249,15 @@ namespace SendFunds
 		optional<string> step2_retVals__tx_hash_string;
 		optional<string> step2_retVals__tx_key_string;
 		optional<string> step2_retVals__tx_pub_key_string;
+		optional<SignedTransaction> signed_transaction; // with its rings, for verify_before_return
+		// - the key derivations of cb_I's spent check; wiped on reset. The core's construction scratch isn't routed here
+		Runtime::Arena arena;
 		//
 		// Imperatives
+		string _error_ret_json(const string &err_msg);
+		string _random_outs_request_json(const LightwalletAPI_Req_GetRandomOuts &req_params);
+		optional<string> _set_up_destinations();
+		string _begin_construction();
 		void _proceedTo_authOrSendTransaction();
 		bool _reenterable_construct_and_send_tx();
 	};
@@ -0,0 +1,208 @@
+//
+//  SendFundsMetrics.cpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+//
+#include "SendFundsMetrics.hpp"
+//
+#include <atomic>
+#if defined(__EMSCRIPTEN__) || defined(__GLIBC__)
+#include <malloc.h>
+#endif
+//
+using namespace std;
+using namespace SendFundsMetrics;
+//
+// Runtime - Counters
+struct PhaseTotals
+{
+	std::atomic<uint64_t> count;
+	std::atomic<uint64_t> total_ns;
+	std::atomic<uint64_t> max_ns;
+};
+static PhaseTotals phase_totals[phase_count];
+static std::atomic<uint64_t> event_totals[event_count];
+static std::atomic<uint64_t> sampled_peak_in_use_bytes(0);
+//
+// Accessory functions
+static void _store_max(std::atomic<uint64_t> &target, uint64_t value)
+{
+	uint64_t current = target.load(std::memory_order_relaxed);
+	while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+	}
+}
+static const char *_event_name(Event event)
+{
+	switch (event) {
+		case prepared:
+			return "prepared";
+		case signed_tx:
+			return "signed";
+		case reconstructed:
+			return "reconstructed";
+		case failed:
+			return "failed";
+		case event_count:
+			break;
+	}
+	return "unknown";
+}
+//
+// Accessors
+const char *SendFundsMetrics::phase_name(Phase phase)
+{
+	switch (phase) {
+		case parseArgs:
+			return "parseArgs";
+		case decryptOutputs:
+			return "decryptOutputs";
+		case selectOutputs:
+			return "selectOutputs";
+		case tieOutsToMixOuts:
+			return "tieOutsToMixOuts";
+		case signTransaction:
+			return "signTransaction";
+		case verifyTransaction:
+			return "verifyTransaction";
+		case serializeResponse:
+			return "serializeResponse";
+		case phase_count:
+			break;
+	}
+	return "unknown";
+}
+HeapStats SendFundsMetrics::heap_stats()
+{
+	HeapStats stats{};
+#if defined(__EMSCRIPTEN__)
+	struct mallinfo info = mallinfo();
+	stats.in_use_bytes = (uint64_t)info.uordblks;
+	stats.peak_bytes = (uint64_t)info.usmblks;
+#elif defined(__GLIBC__)
+#if __GLIBC_PREREQ(2, 33)
+	struct mallinfo2 info = mallinfo2();
+#else
+	struct mallinfo info = mallinfo();
+#endif
+	stats.in_use_bytes = (uint64_t)info.uordblks + (uint64_t)info.hblkhd; // arena + mmapped chunks
+	_store_max(sampled_peak_in_use_bytes, stats.in_use_bytes);
+	stats.peak_bytes = sampled_peak_in_use_bytes.load(std::memory_order_relaxed);
+#endif
+	return stats;
+}
+uint64_t Stopwatch::elapsed_ns() const
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - this->start
+	).count();
+}
+//
+// Imperatives - Recorder
+void Recorder::record(const Stopwatch &stopwatch, Phase phase)
+{
+	uint64_t wall_ns = stopwatch.elapsed_ns();
+	PhaseTotals &totals = phase_totals[phase];
+	totals.count.fetch_add(1, std::memory_order_relaxed);
+	totals.total_ns.fetch_add(wall_ns, std::memory_order_relaxed);
+	_store_max(totals.max_ns, wall_ns);
+	if (!this->enabled) {
+		return; // heap_stats walks the allocator's bins - too slow for every send
+	}
+	Sample sample;
+	sample.phase = phase;
+	sample.attempt = this->attempt;
+	sample.wall_ns = wall_ns;
+	sample.heap = heap_stats();
+	this->samples.push_back(sample);
+}
+void Recorder::write(StreamingJSON::Writer &writer) const
+{
+	if (!this->enabled) {
+		return;
+	}
+	uint64_t total_ns = 0;
+	writer.key("metrics").begin_object();
+	writer.key("phases").begin_array();
+	for (const Sample &sample : this->samples) {
+		total_ns += sample.wall_ns;
+		writer.begin_object();
+		writer.key("phase").string_value(phase_name(sample.phase));
+		writer.key("attempt").uint_string_value(sample.attempt);
+		writer.key("wall_ns").uint_string_value(sample.wall_ns);
+		writer.key("heap_in_use_bytes").uint_string_value(sample.heap.in_use_bytes);
+		writer.key("heap_peak_bytes").uint_string_value(sample.heap.peak_bytes);
+		writer.end_object();
+	}
+	writer.end_array();
+	writer.key("total_wall_ns").uint_string_value(total_ns);
+	writer.end_object();
+}
+//
+// Imperatives - Counters
+void SendFundsMetrics::count(Event event)
+{
+	event_totals[event].fetch_add(1, std::memory_order_relaxed);
+}
+string SendFundsMetrics::counters_json()
+{
+	StreamingJSON::Writer writer(1024);
+	writer.begin_object();
+	for (int event = 0; event < event_count; ++event) {
+		writer.key(_event_name((Event)event)).uint_string_value(event_totals[event].load(std::memory_order_relaxed));
+	}
+	writer.key("phases").begin_object();
+	for (int phase = 0; phase < phase_count; ++phase) {
+		const PhaseTotals &totals = phase_totals[phase];
+		writer.key(phase_name((Phase)phase)).begin_object();
+		writer.key("count").uint_string_value(totals.count.load(std::memory_order_relaxed));
+		writer.key("total_ns").uint_string_value(totals.total_ns.load(std::memory_order_relaxed));
+		writer.key("max_ns").uint_string_value(totals.max_ns.load(std::memory_order_relaxed));
+		writer.end_object();
+	}
+	writer.end_object();
+	HeapStats heap = heap_stats();
+	writer.key("heap_in_use_bytes").uint_string_value(heap.in_use_bytes);
+	writer.key("heap_peak_bytes").uint_string_value(heap.peak_bytes);
+	writer.end_object();
+
+	return writer.take();
+}
+void SendFundsMetrics::reset_counters()
+{
+	for (PhaseTotals &totals : phase_totals) {
+		totals.count.store(0, std::memory_order_relaxed);
+		totals.total_ns.store(0, std::memory_order_relaxed);
+		totals.max_ns.store(0, std::memory_order_relaxed);
+	}
+	for (std::atomic<uint64_t> &total : event_totals) {
+		total.store(0, std::memory_order_relaxed);
+	}
+	sampled_peak_in_use_bytes.store(0, std::memory_order_relaxed);
+}
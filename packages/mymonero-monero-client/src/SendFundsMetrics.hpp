@@ -0,0 +1,117 @@
+//
+//  SendFundsMetrics.hpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#ifndef SendFundsMetrics_hpp
+#define SendFundsMetrics_hpp
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include "StreamingJSON.hpp"
+
+namespace SendFundsMetrics
+{
+	using namespace std;
+	//
+	// Accessory Types
+	//
+	// Finer-grained than SendFunds::ProcessStep, which they break down as noted
+	enum Phase
+	{
+		parseArgs = 0, // request decoding in the bridge - JSON or wire format
+		decryptOutputs = 1, // cb_I - fee fields and key images of candidate-spent outputs (fetchingLatestBalance)
+		selectOutputs = 2, // send_step1 (calculatingFee)
+		tieOutsToMixOuts = 3, // pre_step2 (fetchingDecoyOutputs)
+		signTransaction = 4, // send_step2 (constructingTransaction)
+		verifyTransaction = 5, // verify_before_return's check of the signed transaction
+		serializeResponse = 6, // writing the response document, up to its metrics object
+		phase_count = 7
+	};
+	const char *phase_name(Phase phase);
+	//
+	struct HeapStats
+	{
+		uint64_t in_use_bytes;
+		uint64_t peak_bytes; // dlmalloc's footprint high-water mark under emscripten; elsewhere the highest in_use_bytes sampled
+	};
+	HeapStats heap_stats(); // zeros where the allocator can't report
+	//
+	struct Sample
+	{
+		Phase phase;
+		uint32_t attempt; // fee reconstruction attempt, 0 for the first construction
+		uint64_t wall_ns;
+		HeapStats heap; // at the end of the phase
+	};
+	//
+	// Times one phase from construction
+	class Stopwatch
+	{
+	public:
+		Stopwatch() : start(std::chrono::steady_clock::now()) {}
+		uint64_t elapsed_ns() const;
+	private:
+		std::chrono::steady_clock::time_point start;
+	};
+	//
+	// Samples of one send session. The wall time of every phase is added into the process-wide
+	// counters; the heap is only sampled, and the samples kept and written into responses, when the
+	// request asked.
+	class Recorder
+	{
+	public:
+		bool enabled = false;
+		uint32_t attempt = 0; // kept in step with the controller's constructionAttempt
+		//
+		// Imperatives
+		void record(const Stopwatch &stopwatch, Phase phase);
+		void write(StreamingJSON::Writer &writer) const; // a "metrics" member, when enabled
+	private:
+		vector<Sample> samples;
+	};
+	//
+	// Cumulative counters
+	enum Event
+	{
+		prepared = 0,
+		signed_tx = 1,
+		reconstructed = 2,
+		failed = 3,
+		event_count = 4
+	};
+	void count(Event event);
+	string counters_json(); // since start or the last reset
+	void reset_counters();
+}
+
+#endif /* SendFundsMetrics_hpp */
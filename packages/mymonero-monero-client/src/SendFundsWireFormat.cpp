@@ -0,0 +1,204 @@
+//
+//  SendFundsWireFormat.cpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+#include "SendFundsWireFormat.hpp"
+//
+#include <cstring>
+//
+using namespace std;
+using namespace SendFunds;
+//
+// Accessory types
+class _ByteReader
+{ // bounds-checked little-endian cursor
+public:
+	_ByteReader(const uint8_t *data, size_t size) : cursor(data), end(data + size) {}
+	//
+	size_t remaining() const { return (size_t)(this->end - this->cursor); }
+	bool has(size_t n) const { return this->remaining() >= n; }
+	bool has(uint32_t n_records, size_t record_size) const
+	{ // divides rather than multiplies, since n_records * record_size can wrap a 32-bit size_t
+		return n_records <= this->remaining() / record_size;
+	}
+	const uint8_t *take(size_t n)
+	{ // callers check has(n) first
+		const uint8_t *at = this->cursor;
+		this->cursor += n;
+		return at;
+	}
+	uint32_t u32()
+	{
+		const uint8_t *p = this->take(4);
+		return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+	}
+	uint64_t u64()
+	{
+		uint64_t lo = this->u32();
+		uint64_t hi = this->u32();
+		return lo | (hi << 32);
+	}
+	bool at_end() const { return this->cursor == this->end; }
+private:
+	const uint8_t *cursor;
+	const uint8_t *end;
+};
+//
+// Accessory functions
+static void _assign_hex(string &dst, const uint8_t *bytes, size_t n)
+{ // core's SpendableOutput/RandomAmountOutput keep keys as hex
+	static const char hex_digits[] = "0123456789abcdef";
+	dst.resize(n * 2);
+	for (size_t i = 0; i < n; ++i) {
+		dst[i * 2] = hex_digits[bytes[i] >> 4];
+		dst[i * 2 + 1] = hex_digits[bytes[i] & 0xf];
+	}
+}
+static bool _read_header(_ByteReader &reader, const char *magic, uint32_t &out__count, string &out__err_msg)
+{
+	if (!reader.has(SendFundsWireFormat::header_size) || memcmp(reader.take(4), magic, 4) != 0) {
+		out__err_msg = string("Expected ") + magic + " buffer";
+		return false;
+	}
+	if (reader.u32() != SendFundsWireFormat::version) {
+		out__err_msg = string("Unsupported ") + magic + " version";
+		return false;
+	}
+	out__count = reader.u32();
+	reader.u32(); // reserved
+	return true;
+}
+//
+// Imperatives
+bool SendFundsWireFormat::read_unspent_outputs(
+	const uint8_t *data, size_t size,
+	vector<UnspentOutput> &out__outputs,
+	string &out__err_msg
+) {
+	_ByteReader reader(data, size);
+	uint32_t n_outputs = 0;
+	if (!_read_header(reader, "MMUO", n_outputs, out__err_msg)) {
+		return false;
+	}
+	if (n_outputs > size / unspent_output_size) { // before reserving
+		out__err_msg = "Truncated unspent outputs";
+		return false;
+	}
+	out__outputs.reserve(out__outputs.size() + n_outputs);
+	for (uint32_t i = 0; i < n_outputs; ++i) {
+		if (!reader.has(unspent_output_size)) {
+			out__err_msg = "Truncated unspent outputs";
+			return false;
+		}
+		out__outputs.emplace_back();
+		UnspentOutput &output = out__outputs.back();
+		output.spendable.amount = reader.u64();
+		output.spendable.global_index = reader.u64();
+		output.spendable.index = reader.u64();
+		_assign_hex(output.spendable.public_key, reader.take(32), 32);
+		_assign_hex(output.spendable.tx_pub_key, reader.take(32), 32);
+		uint32_t rct_size = reader.u32();
+		uint32_t n_spend_key_images = reader.u32();
+		const uint8_t *rct = reader.take(rct_capacity);
+		if (rct_size > rct_capacity) {
+			out__err_msg = "Invalid rct size";
+			return false;
+		}
+		if (rct_size != 0) {
+			output.spendable.rct = string();
+			_assign_hex(*output.spendable.rct, rct, rct_size);
+		}
+		if (!reader.has(n_spend_key_images, sizeof(crypto::key_image))) {
+			out__err_msg = "Truncated spend key images";
+			return false;
+		}
+		output.spend_key_images.resize(n_spend_key_images);
+		if (n_spend_key_images != 0) {
+			memcpy(output.spend_key_images.data(), reader.take(n_spend_key_images * sizeof(crypto::key_image)), n_spend_key_images * sizeof(crypto::key_image));
+		}
+	}
+	if (!reader.at_end()) {
+		out__err_msg = "Unexpected trailing bytes after unspent outputs";
+		return false;
+	}
+	return true;
+}
+bool SendFundsWireFormat::read_random_outs(
+	const uint8_t *data, size_t size,
+	vector<RandomAmountOutputs> &out__mix_outs,
+	string &out__err_msg
+) {
+	_ByteReader reader(data, size);
+	uint32_t n_amounts = 0;
+	if (!_read_header(reader, "MMRO", n_amounts, out__err_msg)) {
+		return false;
+	}
+	if (n_amounts > size / random_amount_size) {
+		out__err_msg = "Truncated random outs";
+		return false;
+	}
+	out__mix_outs.reserve(out__mix_outs.size() + n_amounts);
+	for (uint32_t i = 0; i < n_amounts; ++i) {
+		if (!reader.has(random_amount_size)) {
+			out__err_msg = "Truncated random outs";
+			return false;
+		}
+		RandomAmountOutputs amountAndOuts{};
+		amountAndOuts.amount = reader.u64();
+		uint32_t n_outputs = reader.u32();
+		reader.u32(); // reserved
+		if (!reader.has(n_outputs, random_output_size)) {
+			out__err_msg = "Truncated random outs";
+			return false;
+		}
+		amountAndOuts.outputs.resize(n_outputs);
+		for (RandomAmountOutput &amountOutput : amountAndOuts.outputs) {
+			amountOutput.global_index = reader.u64();
+			_assign_hex(amountOutput.public_key, reader.take(32), 32);
+			uint32_t rct_size = reader.u32();
+			reader.u32(); // reserved
+			const uint8_t *rct = reader.take(rct_capacity);
+			if (rct_size > rct_capacity) {
+				out__err_msg = "Invalid rct size";
+				return false;
+			}
+			if (rct_size != 0) {
+				amountOutput.rct = string();
+				_assign_hex(*amountOutput.rct, rct, rct_size);
+			}
+		}
+		out__mix_outs.push_back(std::move(amountAndOuts));
+	}
+	if (!reader.at_end()) {
+		out__err_msg = "Unexpected trailing bytes after random outs";
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,84 @@
+//
+//  SendFundsWireFormat.hpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#ifndef SendFundsWireFormat_hpp
+#define SendFundsWireFormat_hpp
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "SendFundsFormSubmissionController.hpp"
+
+namespace SendFundsWireFormat
+{
+	using namespace std;
+	using namespace SendFunds;
+	//
+	// Binary alternative to the JSON unspentOuts/amount_outs documents, written by WireFormat.js
+	// straight into WASM linear memory (or a native buffer). All integers are little-endian and
+	// every record has a fixed width, so neither side does any text parsing.
+	//
+	// Unspent outputs
+	//   header  "MMUO" | u32 version | u32 n_outputs | u32 reserved                        16 bytes
+	//   output  u64 amount | u64 global_index | u64 index | public_key[32] | tx_pub_key[32]
+	//           | u32 rct_size | u32 n_spend_key_images | rct[96] (zero padded)          192 bytes
+	//           followed by n_spend_key_images * key_image[32]
+	//
+	// Random outs
+	//   header  "MMRO" | u32 version | u32 n_amounts | u32 reserved                        16 bytes
+	//   amount  u64 amount | u32 n_outputs | u32 reserved                                 16 bytes
+	//           followed by n_outputs of
+	//   output  u64 global_index | public_key[32] | u32 rct_size | u32 reserved | rct[96] 144 bytes
+	//
+	// rct_size is 0 when the output has no rct field.
+	//
+	static const uint32_t version = 1;
+	static const size_t header_size = 16;
+	static const size_t rct_capacity = 96;
+	static const size_t unspent_output_size = 192;
+	static const size_t random_amount_size = 16;
+	static const size_t random_output_size = 144;
+	//
+	// Imperatives - these return false and set out__err_msg when the buffer is malformed
+	bool read_unspent_outputs(
+		const uint8_t *data, size_t size,
+		vector<UnspentOutput> &out__outputs,
+		string &out__err_msg
+	);
+	bool read_random_outs(
+		const uint8_t *data, size_t size,
+		vector<RandomAmountOutputs> &out__mix_outs,
+		string &out__err_msg
+	);
+}
+
+#endif /* SendFundsWireFormat_hpp */
@@ -0,0 +1,243 @@
+//
+//  SlotRegistry.hpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#ifndef SlotRegistry_hpp
+#define SlotRegistry_hpp
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <boost/optional/optional.hpp>
+
+namespace Runtime
+{
+	using namespace std;
+	//
+	// A fixed-capacity table of values which are constructed in place in preallocated slots
+	// and addressed by opaque handles. A handle packs the slot index with the slot's generation
+	// so that a stale handle (released or evicted) can never resolve to a newer occupant.
+	//
+	// Values which are not touched for `ttl` are evicted when space is needed. A value which is
+	// checked out (see Checkout) is never evicted. A handle is checked out by one user at a time;
+	// a second Checkout of it fails, with is_busy() telling it apart from a stale handle.
+	//
+	typedef uint64_t SlotHandle;
+	static const SlotHandle invalid_slot_handle = 0;
+	//
+	template <typename T>
+	class SlotRegistry
+	{
+	public:
+		//
+		// Lifecycle - Init
+		SlotRegistry(size_t capacity, chrono::milliseconds ttl)
+			: slots(capacity), ttl(ttl)
+		{
+			free_slot_indices.reserve(capacity);
+			for (size_t i = capacity; i > 0; --i) { // so that slot 0 is used first
+				free_slot_indices.push_back((uint32_t)(i - 1));
+			}
+		}
+		SlotRegistry(const SlotRegistry &) = delete;
+		SlotRegistry &operator=(const SlotRegistry &) = delete;
+		//
+		// Imperatives
+		template <typename... Args>
+		SlotHandle emplace(Args&&... args)
+		{ // returns invalid_slot_handle when the table is full even after evicting expired values
+			lock_guard<mutex> lock(this->m);
+			if (this->free_slot_indices.empty()) {
+				this->_evict_expired();
+				if (this->free_slot_indices.empty()) {
+					return invalid_slot_handle;
+				}
+			}
+			uint32_t index = this->free_slot_indices.back();
+			this->free_slot_indices.pop_back();
+			Slot &slot = this->slots[index];
+			slot.value.emplace(std::forward<Args>(args)...);
+			slot.generation += 1;
+			if (slot.generation == 0) { // never 0, so that no live handle equals invalid_slot_handle
+				slot.generation = 1;
+			}
+			slot.checked_out = false;
+			slot.release_pending = false;
+			slot.last_used = chrono::steady_clock::now();
+			//
+			return ((SlotHandle)slot.generation << 32) | index;
+		}
+		bool release(SlotHandle handle)
+		{
+			lock_guard<mutex> lock(this->m);
+			Slot *slot = this->_slot_for(handle);
+			if (slot == NULL) {
+				return false;
+			}
+			if (slot->checked_out) { // deferred until the current user checks it back in
+				slot->release_pending = true;
+				return true;
+			}
+			this->_release(*slot, (uint32_t)(handle & 0xffffffff));
+			return true;
+		}
+		size_t evict_expired()
+		{
+			lock_guard<mutex> lock(this->m);
+			return this->_evict_expired();
+		}
+		size_t size() const
+		{
+			lock_guard<mutex> lock(this->m);
+			return this->slots.size() - this->free_slot_indices.size();
+		}
+		//
+		// Scoped access - keeps the value from being evicted while in use
+		class Checkout
+		{
+		public:
+			Checkout(SlotRegistry &registry, SlotHandle handle)
+				: registry(registry), handle(handle), is_busy_(false), value(registry._check_out(handle, is_busy_)) {}
+			~Checkout()
+			{
+				if (this->value != NULL) {
+					this->registry._check_in(this->handle);
+				}
+			}
+			Checkout(const Checkout &) = delete;
+			Checkout &operator=(const Checkout &) = delete;
+			//
+			T *get() const { return this->value; }
+			T *operator->() const { return this->value; }
+			explicit operator bool() const { return this->value != NULL; }
+			bool is_busy() const { return this->is_busy_; } // failed as another user has the value checked out
+		private:
+			SlotRegistry &registry;
+			SlotHandle handle;
+			bool is_busy_;
+			T *value;
+		};
+		//
+		// Accessors - Handle <-> JSON-safe string
+		static string string_from(SlotHandle handle)
+		{
+			return std::to_string(handle);
+		}
+		static SlotHandle handle_from(const string &str)
+		{
+			try {
+				return (SlotHandle)stoull(str);
+			} catch (...) {
+				return invalid_slot_handle;
+			}
+		}
+	private:
+		struct Slot
+		{
+			boost::optional<T> value;
+			uint32_t generation = 0;
+			bool checked_out = false;
+			bool release_pending = false;
+			chrono::steady_clock::time_point last_used;
+		};
+		//
+		mutable mutex m;
+		vector<Slot> slots; // sized once at init and never reallocated
+		vector<uint32_t> free_slot_indices;
+		chrono::milliseconds ttl;
+		//
+		Slot *_slot_for(SlotHandle handle)
+		{
+			uint32_t index = (uint32_t)(handle & 0xffffffff);
+			uint32_t generation = (uint32_t)(handle >> 32);
+			if (index >= this->slots.size()) {
+				return NULL;
+			}
+			Slot &slot = this->slots[index];
+			if (slot.value == boost::none || slot.generation != generation) {
+				return NULL;
+			}
+			return &slot;
+		}
+		void _release(Slot &slot, uint32_t index)
+		{
+			slot.value = boost::none; // destroys in place; the slot's storage is reused by the next emplace
+			slot.checked_out = false;
+			slot.release_pending = false;
+			this->free_slot_indices.push_back(index);
+		}
+		size_t _evict_expired()
+		{
+			auto now = chrono::steady_clock::now();
+			size_t n_evicted = 0;
+			for (size_t i = 0; i < this->slots.size(); ++i) {
+				Slot &slot = this->slots[i];
+				if (slot.value != boost::none && !slot.checked_out && now - slot.last_used > this->ttl) {
+					this->_release(slot, (uint32_t)i);
+					n_evicted += 1;
+				}
+			}
+			return n_evicted;
+		}
+		T *_check_out(SlotHandle handle, bool &out__is_busy)
+		{
+			lock_guard<mutex> lock(this->m);
+			Slot *slot = this->_slot_for(handle);
+			if (slot == NULL || slot->release_pending) {
+				return NULL;
+			}
+			if (slot->checked_out) {
+				out__is_busy = true;
+				return NULL;
+			}
+			slot->checked_out = true;
+			slot->last_used = chrono::steady_clock::now();
+			return &(*slot->value);
+		}
+		void _check_in(SlotHandle handle)
+		{
+			lock_guard<mutex> lock(this->m);
+			Slot *slot = this->_slot_for(handle);
+			if (slot == NULL) {
+				return;
+			}
+			slot->checked_out = false;
+			slot->last_used = chrono::steady_clock::now();
+			if (slot->release_pending) {
+				this->_release(*slot, (uint32_t)(handle & 0xffffffff));
+			}
+		}
+	};
+}
+
+#endif /* SlotRegistry_hpp */
@@ -0,0 +1,509 @@
+//
+//  StreamingJSON.cpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+#include "StreamingJSON.hpp"
+//
+using namespace std;
+using namespace StreamingJSON;
+//
+// Accessory functions
+static int _hex_nibble(char c)
+{
+	if (c >= '0' && c <= '9') {
+		return c - '0';
+	}
+	if (c >= 'a' && c <= 'f') {
+		return c - 'a' + 10;
+	}
+	if (c >= 'A' && c <= 'F') {
+		return c - 'A' + 10;
+	}
+	return -1;
+}
+static void _append_utf8(string &dst, uint32_t code_point)
+{
+	if (code_point < 0x80) {
+		dst.push_back((char)code_point);
+	} else if (code_point < 0x800) {
+		dst.push_back((char)(0xc0 | (code_point >> 6)));
+		dst.push_back((char)(0x80 | (code_point & 0x3f)));
+	} else if (code_point < 0x10000) {
+		dst.push_back((char)(0xe0 | (code_point >> 12)));
+		dst.push_back((char)(0x80 | ((code_point >> 6) & 0x3f)));
+		dst.push_back((char)(0x80 | (code_point & 0x3f)));
+	} else {
+		dst.push_back((char)(0xf0 | (code_point >> 18)));
+		dst.push_back((char)(0x80 | ((code_point >> 12) & 0x3f)));
+		dst.push_back((char)(0x80 | ((code_point >> 6) & 0x3f)));
+		dst.push_back((char)(0x80 | (code_point & 0x3f)));
+	}
+}
+//
+// Reader - Accessors
+void Reader::fail(const string &msg) const
+{
+	throw ParseError("JSON parse error at offset " + std::to_string(this->offset()) + ": " + msg);
+}
+void Reader::_skip_ws()
+{
+	while (this->cursor != this->end) {
+		char c = *this->cursor;
+		if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+			break;
+		}
+		++this->cursor;
+	}
+}
+char Reader::_peek_char()
+{
+	this->_skip_ws();
+	if (this->cursor == this->end) {
+		this->fail("unexpected end of input");
+	}
+	return *this->cursor;
+}
+ValueType Reader::peek()
+{
+	switch (this->_peek_char()) {
+		case 'n':
+			return null_type;
+		case 't':
+		case 'f':
+			return bool_type;
+		case '"':
+			return string_type;
+		case '[':
+			return array_type;
+		case '{':
+			return object_type;
+		default:
+			return number_type;
+	}
+}
+void Reader::_expect(char c)
+{
+	if (this->_peek_char() != c) {
+		this->fail(string("expected '") + c + "'");
+	}
+	++this->cursor;
+}
+void Reader::_expect_literal(const char *literal)
+{
+	size_t length = strlen(literal);
+	this->_skip_ws();
+	if ((size_t)(this->end - this->cursor) < length || memcmp(this->cursor, literal, length) != 0) {
+		this->fail(string("expected ") + literal);
+	}
+	this->cursor += length;
+}
+//
+// Reader - Structure
+void Reader::begin_object()
+{
+	this->_expect('{');
+	this->is_at_first_member = true;
+}
+bool Reader::next_key(string &out__key)
+{
+	if (!this->_next_member('}')) {
+		return false;
+	}
+	if (this->_peek_char() != '"') {
+		this->fail("expected member name");
+	}
+	this->read_string(out__key);
+	this->_expect(':');
+	return true;
+}
+void Reader::begin_array()
+{
+	this->_expect('[');
+	this->is_at_first_member = true;
+}
+bool Reader::next_element()
+{
+	return this->_next_member(']');
+}
+bool Reader::_next_member(char closing)
+{ // a single flag is enough: nothing is read between begin_object/begin_array and the first next_key/next_element
+	char c = this->_peek_char();
+	bool is_first = this->is_at_first_member;
+	this->is_at_first_member = false;
+	if (c == closing) {
+		++this->cursor;
+		return false;
+	}
+	if (!is_first) {
+		if (c != ',') {
+			this->fail(string("expected ',' or '") + closing + "'");
+		}
+		++this->cursor;
+	}
+	return true;
+}
+void Reader::expect_end()
+{
+	this->_skip_ws();
+	if (this->cursor != this->end) {
+		this->fail("unexpected trailing characters");
+	}
+}
+//
+// Reader - Values
+void Reader::_read_string_contents(string &out__str)
+{ // cursor is just past the opening quote
+	const char *quote = (const char *)memchr(this->cursor, '"', (size_t)(this->end - this->cursor));
+	if (quote != NULL && memchr(this->cursor, '\\', (size_t)(quote - this->cursor)) == NULL) {
+		out__str.assign(this->cursor, quote); // no escapes, as with nearly every key and hex string
+		this->cursor = quote + 1;
+		return;
+	}
+	out__str.clear();
+	const char *run_begin = this->cursor;
+	while (true) {
+		if (this->cursor == this->end) {
+			this->fail("unterminated string");
+		}
+		char c = *this->cursor;
+		if (c == '"') {
+			out__str.append(run_begin, this->cursor);
+			++this->cursor;
+			return;
+		}
+		if (c != '\\') {
+			++this->cursor;
+			continue;
+		}
+		out__str.append(run_begin, this->cursor);
+		++this->cursor;
+		if (this->cursor == this->end) {
+			this->fail("unterminated escape");
+		}
+		char escaped = *this->cursor++;
+		switch (escaped) {
+			case '"': out__str.push_back('"'); break;
+			case '\\': out__str.push_back('\\'); break;
+			case '/': out__str.push_back('/'); break;
+			case 'b': out__str.push_back('\b'); break;
+			case 'f': out__str.push_back('\f'); break;
+			case 'n': out__str.push_back('\n'); break;
+			case 'r': out__str.push_back('\r'); break;
+			case 't': out__str.push_back('\t'); break;
+			case 'u': {
+				uint32_t code_point = 0;
+				for (int pass = 0; pass < 2; ++pass) {
+					if (this->end - this->cursor < 4) {
+						this->fail("truncated unicode escape");
+					}
+					uint32_t unit = 0;
+					for (int i = 0; i < 4; ++i) {
+						int nibble = _hex_nibble(*this->cursor++);
+						if (nibble < 0) {
+							this->fail("invalid unicode escape");
+						}
+						unit = (unit << 4) | (uint32_t)nibble;
+					}
+					if (pass == 0 && unit >= 0xd800 && unit <= 0xdbff) { // high surrogate - expect the low half
+						if (this->end - this->cursor < 6 || this->cursor[0] != '\\' || this->cursor[1] != 'u') {
+							this->fail("unpaired surrogate");
+						}
+						this->cursor += 2;
+						code_point = unit;
+						continue;
+					}
+					code_point = pass == 0 ? unit : 0x10000 + ((code_point - 0xd800) << 10) + (unit - 0xdc00);
+					break;
+				}
+				_append_utf8(out__str, code_point);
+				break;
+			}
+			default:
+				this->fail("invalid escape");
+		}
+		run_begin = this->cursor;
+	}
+}
+void Reader::read_string(string &out__str)
+{
+	this->_expect('"');
+	this->_read_string_contents(out__str);
+}
+void Reader::_skip_number()
+{
+	const char *number_begin = this->cursor;
+	while (this->cursor != this->end) {
+		char c = *this->cursor;
+		if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E') {
+			++this->cursor;
+			continue;
+		}
+		break;
+	}
+	if (this->cursor == number_begin) {
+		this->fail("expected a value");
+	}
+}
+void Reader::read_scalar_text(string &out__text)
+{
+	switch (this->peek()) {
+		case string_type:
+			this->read_string(out__text);
+			return;
+		case number_type: {
+			const char *number_begin = this->cursor;
+			this->_skip_number();
+			out__text.assign(number_begin, this->cursor);
+			return;
+		}
+		case bool_type:
+			out__text = this->read_bool() ? "true" : "false";
+			return;
+		default:
+			this->fail("expected a scalar value");
+	}
+}
+uint64_t Reader::read_uint64()
+{
+	bool is_quoted = this->_peek_char() == '"';
+	if (is_quoted) {
+		++this->cursor;
+	}
+	const char *digits_begin = this->cursor;
+	uint64_t value = 0;
+	while (this->cursor != this->end && *this->cursor >= '0' && *this->cursor <= '9') {
+		uint64_t digit = (uint64_t)(*this->cursor - '0');
+		if (value > (UINT64_MAX - digit) / 10) {
+			this->fail("integer out of range");
+		}
+		value = value * 10 + digit;
+		++this->cursor;
+	}
+	if (this->cursor == digits_begin) {
+		this->fail("expected an unsigned integer");
+	}
+	if (is_quoted) {
+		this->_expect('"');
+	}
+	return value;
+}
+bool Reader::read_bool()
+{
+	char c = this->_peek_char();
+	if (c == 't') {
+		this->_expect_literal("true");
+		return true;
+	}
+	if (c == 'f') {
+		this->_expect_literal("false");
+		return false;
+	}
+	if (c == '"') {
+		string text;
+		this->read_string(text);
+		if (text == "true") {
+			return true;
+		}
+		if (text == "false") {
+			return false;
+		}
+	}
+	this->fail("expected a boolean");
+}
+bool Reader::read_null()
+{
+	if (this->_peek_char() != 'n') {
+		return false;
+	}
+	this->_expect_literal("null");
+	return true;
+}
+void Reader::_read_hex(unsigned char *dst, size_t n_bytes)
+{
+	this->_expect('"');
+	if ((size_t)(this->end - this->cursor) < n_bytes * 2 + 1) {
+		this->fail("hex string too short");
+	}
+	for (size_t i = 0; i < n_bytes; ++i) {
+		int hi = _hex_nibble(this->cursor[0]);
+		int lo = _hex_nibble(this->cursor[1]);
+		if (hi < 0 || lo < 0) {
+			this->fail("invalid hex");
+		}
+		dst[i] = (unsigned char)((hi << 4) | lo);
+		this->cursor += 2;
+	}
+	if (*this->cursor != '"') {
+		this->fail("hex string has unexpected length");
+	}
+	++this->cursor;
+}
+void Reader::_skip_string()
+{ // cursor is just past the opening quote
+	const char *string_begin = this->cursor;
+	while (true) {
+		const char *quote = (const char *)memchr(this->cursor, '"', (size_t)(this->end - this->cursor));
+		if (quote == NULL) {
+			this->cursor = this->end;
+			this->fail("unterminated string");
+		}
+		this->cursor = quote + 1;
+		size_t n_backslashes = 0;
+		while (quote - n_backslashes != string_begin && quote[-1 - (ptrdiff_t)n_backslashes] == '\\') {
+			++n_backslashes;
+		}
+		if (n_backslashes % 2 == 0) {
+			return; // not itself escaped
+		}
+	}
+}
+bool Reader::_skip_next_key()
+{
+	if (!this->_next_member('}')) {
+		return false;
+	}
+	if (this->_peek_char() != '"') {
+		this->fail("expected member name");
+	}
+	++this->cursor;
+	this->_skip_string();
+	this->_expect(':');
+	return true;
+}
+void Reader::skip_value()
+{
+	switch (this->peek()) {
+		case null_type:
+			this->_expect_literal("null");
+			return;
+		case bool_type:
+			this->read_bool();
+			return;
+		case number_type:
+			this->_skip_number();
+			return;
+		case string_type:
+			++this->cursor;
+			this->_skip_string();
+			return;
+		case array_type:
+			this->begin_array();
+			while (this->next_element()) {
+				this->skip_value();
+			}
+			return;
+		case object_type:
+			this->begin_object();
+			while (this->_skip_next_key()) {
+				this->skip_value();
+			}
+			return;
+	}
+}
+void Reader::read_raw_value(const char *&out__begin, const char *&out__end)
+{
+	this->_skip_ws();
+	out__begin = this->cursor;
+	this->skip_value();
+	out__end = this->cursor;
+}
+//
+// Writer
+Writer &Writer::key(const char *key)
+{
+	this->string_value(key);
+	this->out.push_back(':');
+	this->needs_comma = false;
+	return *this;
+}
+Writer &Writer::key(const string &key)
+{
+	this->string_value(key);
+	this->out.push_back(':');
+	this->needs_comma = false;
+	return *this;
+}
+Writer &Writer::string_value(const char *str, size_t length)
+{
+	static const char hex_digits[] = "0123456789abcdef";
+	this->_will_write_value();
+	this->out.push_back('"');
+	const char *run_begin = str;
+	const char *str_end = str + length;
+	for (const char *p = str; p != str_end; ++p) {
+		unsigned char c = (unsigned char)*p;
+		if (c >= 0x20 && c != '"' && c != '\\') {
+			continue;
+		}
+		this->out.append(run_begin, p);
+		this->out.push_back('\\');
+		switch (c) {
+			case '"': this->out.push_back('"'); break;
+			case '\\': this->out.push_back('\\'); break;
+			case '\n': this->out.push_back('n'); break;
+			case '\r': this->out.push_back('r'); break;
+			case '\t': this->out.push_back('t'); break;
+			default:
+				this->out.append("u00");
+				this->out.push_back(hex_digits[c >> 4]);
+				this->out.push_back(hex_digits[c & 0xf]);
+		}
+		run_begin = p + 1;
+	}
+	this->out.append(run_begin, str_end);
+	this->out.push_back('"');
+	return *this;
+}
+Writer &Writer::uint_string_value(uint64_t value)
+{
+	char buf[21];
+	char *p = buf + sizeof(buf);
+	do {
+		*--p = (char)('0' + value % 10);
+		value /= 10;
+	} while (value != 0);
+	return this->string_value(p, (size_t)(buf + sizeof(buf) - p));
+}
+Writer &Writer::uint_value(uint64_t value)
+{
+	char buf[21];
+	char *p = buf + sizeof(buf);
+	do {
+		*--p = (char)('0' + value % 10);
+		value /= 10;
+	} while (value != 0);
+	return this->raw_value(p, buf + sizeof(buf));
+}
+Writer &Writer::raw_value(const char *begin, const char *end)
+{
+	this->_will_write_value();
+	this->out.append(begin, end);
+	return *this;
+}
@@ -0,0 +1,164 @@
+//
+//  StreamingJSON.hpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#ifndef StreamingJSON_hpp
+#define StreamingJSON_hpp
+
+#include <string>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+
+namespace StreamingJSON
+{
+	using namespace std;
+	//
+	// Allocation-light JSON for the bridge's hot paths, in place of boost::property_tree.
+	//
+	// Reader is a pull parser over a caller-owned buffer: the caller walks the document with
+	// begin_object/next_key and begin_array/next_element and decodes each value straight into
+	// its typed destination. Nothing is materialized which the caller doesn't ask for.
+	//
+	// Writer appends to a single string. Like property_tree's write_json, which the bridge's
+	// JS callers were written against, it writes scalars as JSON strings unless asked otherwise.
+	//
+	class ParseError : public std::runtime_error
+	{
+	public:
+		ParseError(const string &msg) : std::runtime_error(msg) {}
+	};
+	//
+	enum ValueType
+	{
+		null_type,
+		bool_type,
+		number_type,
+		string_type,
+		array_type,
+		object_type
+	};
+	//
+	class Reader
+	{
+	public:
+		//
+		// Lifecycle - Init
+		Reader(const char *begin, const char *end) : cursor(begin), begin(begin), end(end), is_at_first_member(false) {}
+		Reader(const string &str) : Reader(str.data(), str.data() + str.size()) {}
+		//
+		// Accessors
+		ValueType peek();
+		size_t offset() const { return (size_t)(this->cursor - this->begin); }
+		const char *position() { this->_skip_ws(); return this->cursor; } // where the next value starts, or just past the last
+		//
+		// Imperatives - Structure
+		void begin_object();
+		bool next_key(string &out__key); // false, having consumed '}', when there are no more members
+		void begin_array();
+		bool next_element(); // false, having consumed ']', when there are no more elements
+		void expect_end(); // only trailing whitespace may remain
+		//
+		// Imperatives - Values
+		void read_string(string &out__str);
+		void read_scalar_text(string &out__text); // string contents, or the literal text of a number/bool
+		uint64_t read_uint64(); // a JSON number or a numeric string
+		bool read_bool(); // true/false, or "true"/"false"
+		bool read_null(); // consumes and returns true when the value is null
+		template <typename POD>
+		void read_hex_pod(POD &out__pod)
+		{ // hex string decoded straight into the POD's bytes
+			this->_read_hex((unsigned char *)&out__pod, sizeof(POD));
+		}
+		void skip_value();
+		void read_raw_value(const char *&out__begin, const char *&out__end); // exact source text of the next value
+		//
+		[[noreturn]] void fail(const string &msg) const;
+	private:
+		const char *cursor;
+		const char *begin;
+		const char *end;
+		bool is_at_first_member; // just past an opening brace or bracket, where no ',' comes first
+		//
+		void _skip_ws();
+		char _peek_char();
+		void _expect(char c);
+		void _expect_literal(const char *literal);
+		void _read_string_contents(string &out__str);
+		void _skip_string();
+		bool _next_member(char closing); // false, having consumed closing, when there are no more members
+		bool _skip_next_key(); // next_key without decoding the key
+		void _skip_number();
+		void _read_hex(unsigned char *dst, size_t n_bytes);
+	};
+	//
+	class Writer
+	{
+	public:
+		//
+		// Lifecycle - Init
+		Writer(size_t reserve = 256) : needs_comma(false) { this->out.reserve(reserve); }
+		//
+		// Imperatives - Structure
+		Writer &begin_object() { this->_will_write_value(); this->out.push_back('{'); this->needs_comma = false; return *this; }
+		Writer &end_object() { this->out.push_back('}'); this->needs_comma = true; return *this; }
+		Writer &begin_array() { this->_will_write_value(); this->out.push_back('['); this->needs_comma = false; return *this; }
+		Writer &end_array() { this->out.push_back(']'); this->needs_comma = true; return *this; }
+		Writer &key(const char *key);
+		Writer &key(const string &key);
+		//
+		// Imperatives - Values
+		Writer &string_value(const char *str, size_t length);
+		Writer &string_value(const string &str) { return this->string_value(str.data(), str.size()); }
+		Writer &string_value(const char *str) { return this->string_value(str, strlen(str)); }
+		Writer &uint_string_value(uint64_t value); // written as a string, e.g. "16", for JS callers which parse these
+		Writer &uint_value(uint64_t value); // written as a JSON number, for values JS callers use as numbers
+		Writer &bool_string_value(bool value) { return this->string_value(value ? "true" : "false"); }
+		Writer &raw_value(const char *begin, const char *end); // pre-serialized JSON, e.g. from Reader::read_raw_value
+		//
+		// Accessors
+		const string &str() const { return this->out; }
+		string take() { return std::move(this->out); }
+	private:
+		string out;
+		bool needs_comma;
+		//
+		void _will_write_value()
+		{
+			if (this->needs_comma) {
+				this->out.push_back(',');
+			}
+			this->needs_comma = true;
+		}
+	};
+}
+
+#endif /* StreamingJSON_hpp */
@@ -0,0 +1,327 @@
+//
+//  TransactionHistory.cpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+//
+#include "TransactionHistory.hpp"
+//
+#include <algorithm>
+#include <cstring>
+//
+#include "StreamingJSON.hpp"
+//
+using namespace std;
+using namespace boost;
+using namespace History;
+//
+// Constants
+static const size_t coin_unit_places = 12;
+//
+// Accessory functions - Parsing
+static uint64_t _read_uint64_or_zero(StreamingJSON::Reader &reader)
+{ // the server writes null for e.g. the height of a mempool tx
+	return reader.read_null() ? 0 : reader.read_uint64();
+}
+static void _read_spent_output(StreamingJSON::Reader &output_reader, string &key, SpentOutput &out)
+{
+	out.json_begin = output_reader.position();
+	bool has_tx_pub_key = false;
+	bool has_key_image = false;
+	out.output.out_index = 0;
+	out.amount = 0;
+	output_reader.begin_object();
+	while (output_reader.next_key(key)) {
+		if (key == "tx_pub_key") {
+			has_tx_pub_key = true;
+			output_reader.read_hex_pod(out.output.tx_pub_key);
+		} else if (key == "key_image") {
+			has_key_image = true;
+			output_reader.read_hex_pod(out.key_image);
+		} else if (key == "out_index") {
+			out.output.out_index = output_reader.read_uint64();
+		} else if (key == "amount") {
+			out.amount = _read_uint64_or_zero(output_reader);
+		} else {
+			output_reader.skip_value();
+		}
+	}
+	out.json_end = output_reader.position();
+	if (!has_tx_pub_key || !has_key_image) {
+		output_reader.fail("Expected tx_pub_key and key_image in each spent output");
+	}
+}
+static bool _read_transaction(StreamingJSON::Reader &tx_reader, string &key, const optional<uint64_t> &applied_height, Transaction &out)
+{ // false for a confirmed transaction at or below applied_height, whose members after its height are only skipped
+	out.json_begin = tx_reader.position();
+	out.id = 0;
+	out.height = 0;
+	out.mempool = false;
+	out.total_received = 0;
+	out.total_sent = 0;
+	out.has_total_sent = false;
+	out.has_spent_outputs = false;
+	out.has_short_payment_id = false;
+	out.rewritten_members.clear();
+	out.payment_id_member = none;
+	out.spent_outputs.clear();
+	tx_reader.begin_object();
+	const char *member_begin = out.json_begin;
+	bool is_applied = false;
+	while (tx_reader.next_key(key)) {
+		if (is_applied) {
+			tx_reader.skip_value();
+			continue;
+		}
+		bool is_rewritten = false;
+		if (key == "id") {
+			out.id = _read_uint64_or_zero(tx_reader);
+		} else if (key == "height") {
+			out.height = _read_uint64_or_zero(tx_reader); // 0 while in the mempool
+			is_applied = applied_height != none && out.height != 0 && out.height <= *applied_height;
+		} else if (key == "mempool") {
+			out.mempool = !tx_reader.read_null() && tx_reader.read_bool();
+		} else if (key == "total_received") {
+			out.total_received = _read_uint64_or_zero(tx_reader);
+		} else if (key == "total_sent") {
+			is_rewritten = true;
+			out.has_total_sent = true;
+			out.total_sent = _read_uint64_or_zero(tx_reader);
+		} else if (key == "payment_id") {
+			if (!tx_reader.read_null()) {
+				string payment_id;
+				tx_reader.read_scalar_text(payment_id);
+				out.has_short_payment_id = payment_id.size() == 16;
+			}
+		} else if (key == "spent_outputs") {
+			is_rewritten = true;
+			if (!tx_reader.read_null()) {
+				out.has_spent_outputs = true;
+				tx_reader.begin_array();
+				while (tx_reader.next_element()) {
+					out.spent_outputs.emplace_back();
+					_read_spent_output(tx_reader, key, out.spent_outputs.back());
+				}
+			}
+		} else {
+			is_rewritten = key == "amount" || key == "approx_float_amount";
+			tx_reader.skip_value();
+		}
+		const char *member_end = tx_reader.position();
+		if (is_rewritten) {
+			out.rewritten_members.push_back(MemberRange{ member_begin, member_end });
+		} else if (key == "payment_id") {
+			out.payment_id_member = MemberRange{ member_begin, member_end };
+		}
+		member_begin = member_end;
+	}
+	out.json_members_end = member_begin;
+	if (applied_height != none && !out.mempool && out.height <= *applied_height) {
+		is_applied = true; // e.g. a height of null on a confirmed transaction
+	}
+	return !is_applied;
+}
+//
+// Accessory functions - Writing
+static void _write_amount(StreamingJSON::Writer &writer, const Transaction &tx)
+{ // total_received - total_sent, which is negative for outgoing txs
+	if (tx.total_received >= tx.total_sent) {
+		writer.uint_string_value(tx.total_received - tx.total_sent);
+		return;
+	}
+	string amount = "-" + std::to_string(tx.total_sent - tx.total_received);
+	writer.string_value(amount);
+}
+static void _write_approx_float_amount(StreamingJSON::Writer &writer, const Transaction &tx)
+{ // the full decimal, which JSON.parse rounds exactly as parseFloat(formatMoney(amount)) does
+	bool is_negative = tx.total_received < tx.total_sent;
+	uint64_t units = is_negative ? tx.total_sent - tx.total_received : tx.total_received - tx.total_sent;
+	string digits = std::to_string(units);
+	if (digits.size() <= coin_unit_places) {
+		digits.insert(0, coin_unit_places + 1 - digits.size(), '0');
+	}
+	string decimal = is_negative ? "-" : "";
+	decimal.append(digits, 0, digits.size() - coin_unit_places);
+	decimal.push_back('.');
+	decimal.append(digits, digits.size() - coin_unit_places, coin_unit_places);
+	writer.raw_value(decimal.data(), decimal.data() + decimal.size());
+}
+static void _write_members(StreamingJSON::Writer &writer, const char *begin, const char *end)
+{ // members copied as they are, less the separator before the first
+	while (begin != end && (*begin == '{' || *begin == ',' || *begin == ' ' || *begin == '\t' || *begin == '\n' || *begin == '\r')) {
+		++begin;
+	}
+	if (begin != end) {
+		writer.raw_value(begin, end);
+	}
+}
+static void _write_transaction(StreamingJSON::Writer &writer, const Transaction &tx)
+{
+	vector<MemberRange> omitted_members = tx.rewritten_members;
+	if (tx.payment_id_member != none && tx.has_short_payment_id && tx.total_received < tx.total_sent) {
+		omitted_members.push_back(*tx.payment_id_member); // an outgoing tx's encrypted payment id
+	}
+	std::sort(omitted_members.begin(), omitted_members.end(), [](const MemberRange &a, const MemberRange &b) {
+		return a.begin < b.begin;
+	});
+	writer.begin_object();
+	const char *kept_begin = tx.json_begin;
+	for (const MemberRange &omitted : omitted_members) {
+		_write_members(writer, kept_begin, omitted.begin);
+		kept_begin = omitted.end;
+	}
+	_write_members(writer, kept_begin, tx.json_members_end);
+	if (tx.has_total_sent) {
+		writer.key("total_sent").uint_string_value(tx.total_sent);
+	}
+	if (tx.has_spent_outputs) {
+		writer.key("spent_outputs").begin_array();
+		for (const SpentOutput &spent_output : tx.spent_outputs) {
+			writer.raw_value(spent_output.json_begin, spent_output.json_end);
+		}
+		writer.end_array();
+	}
+	_write_amount(writer.key("amount"), tx);
+	_write_approx_float_amount(writer.key("approx_float_amount"), tx);
+	writer.end_object();
+}
+//
+// Imperatives
+void History::read_payload(const char *begin, const char *end, Payload &out__payload, optional<uint64_t> applied_height)
+{
+	out__payload.scanned_height = 0;
+	out__payload.scanned_block_height = 0;
+	out__payload.start_height = 0;
+	out__payload.transaction_height = 0;
+	out__payload.blockchain_height = 0;
+	out__payload.transactions.clear();
+	//
+	StreamingJSON::Reader reader(begin, end);
+	string key;
+	reader.begin_object();
+	while (reader.next_key(key)) {
+		if (key == "scanned_height") {
+			out__payload.scanned_height = _read_uint64_or_zero(reader);
+		} else if (key == "scanned_block_height") {
+			out__payload.scanned_block_height = _read_uint64_or_zero(reader);
+		} else if (key == "start_height") {
+			out__payload.start_height = _read_uint64_or_zero(reader);
+		} else if (key == "transaction_height") {
+			out__payload.transaction_height = _read_uint64_or_zero(reader);
+		} else if (key == "blockchain_height") {
+			out__payload.blockchain_height = _read_uint64_or_zero(reader);
+		} else if (key == "transactions") {
+			if (reader.read_null()) {
+				continue;
+			}
+			reader.begin_array();
+			Transaction tx;
+			while (reader.next_element()) {
+				if (_read_transaction(reader, key, applied_height, tx)) {
+					out__payload.transactions.push_back(std::move(tx));
+				}
+			}
+		} else {
+			reader.skip_value();
+		}
+	}
+	reader.expect_end();
+}
+void History::spent_output_refs(const Payload &payload, vector<KeyImages::OutputRef> &out__outputs)
+{
+	out__outputs.clear();
+	for (const Transaction &tx : payload.transactions) {
+		for (const SpentOutput &spent_output : tx.spent_outputs) {
+			out__outputs.push_back(spent_output.output);
+		}
+	}
+}
+optional<string> History::filter_owned(Payload &payload, const vector<crypto::key_image> &wallet_key_images)
+{
+	size_t next_key_image = 0;
+	size_t n_kept_txs = 0;
+	for (size_t i = 0; i < payload.transactions.size(); ++i) {
+		Transaction &tx = payload.transactions[i];
+		size_t n_kept_outputs = 0;
+		for (size_t j = 0; j < tx.spent_outputs.size(); ++j) {
+			if (next_key_image == wallet_key_images.size()) {
+				return string("Expected a key image for each spent output");
+			}
+			const SpentOutput &spent_output = tx.spent_outputs[j];
+			if (spent_output.key_image == wallet_key_images[next_key_image++]) {
+				tx.spent_outputs[n_kept_outputs++] = spent_output;
+				continue;
+			}
+			// a decoy in someone else's ring
+			if (spent_output.amount > tx.total_sent) {
+				return "Invalid total_sent of transaction " + std::to_string(tx.id);
+			}
+			tx.total_sent -= spent_output.amount;
+			tx.has_total_sent = true;
+		}
+		tx.spent_outputs.resize(n_kept_outputs);
+		if (tx.total_received == 0 && tx.total_sent == 0) {
+			continue; // not the wallet's
+		}
+		if (n_kept_txs != i) {
+			payload.transactions[n_kept_txs] = std::move(tx);
+		}
+		n_kept_txs++;
+	}
+	payload.transactions.resize(n_kept_txs);
+	std::stable_sort(payload.transactions.begin(), payload.transactions.end(), [](const Transaction &a, const Transaction &b) {
+		if (a.mempool != b.mempool) {
+			return a.mempool;
+		}
+		return a.id > b.id;
+	});
+	return none;
+}
+string History::write_history(const Payload &payload)
+{
+	size_t payload_size = 0;
+	for (const Transaction &tx : payload.transactions) {
+		payload_size += (size_t)(tx.json_members_end - tx.json_begin);
+	}
+	StreamingJSON::Writer writer(payload_size + payload.transactions.size() * 64 + 256);
+	writer.begin_object();
+	writer.key("account_scanned_height").uint_value(payload.scanned_height);
+	writer.key("account_scanned_block_height").uint_value(payload.scanned_block_height);
+	writer.key("account_scan_start_height").uint_value(payload.start_height);
+	writer.key("transaction_height").uint_value(payload.transaction_height);
+	writer.key("blockchain_height").uint_value(payload.blockchain_height);
+	writer.key("serialized_transactions").begin_array();
+	for (const Transaction &tx : payload.transactions) {
+		_write_transaction(writer, tx);
+	}
+	writer.end_array();
+	writer.end_object();
+	//
+	return writer.take();
+}
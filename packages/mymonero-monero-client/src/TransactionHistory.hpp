@@ -0,0 +1,114 @@
+//
+//  TransactionHistory.hpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#ifndef TransactionHistory_hpp
+#define TransactionHistory_hpp
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <boost/optional/optional.hpp>
+#include "crypto.h"
+#include "KeyImages.hpp"
+
+namespace History
+{
+	using namespace std;
+	using namespace boost;
+	//
+	// Accessory Types
+	struct SpentOutput
+	{
+		KeyImages::OutputRef output;
+		crypto::key_image key_image; // as reported by the server, which can't tell the wallet's outputs from decoys
+		uint64_t amount;
+		const char *json_begin; // the output's object within the payload
+		const char *json_end;
+	};
+	struct MemberRange
+	{ // a member of an object within the payload, from the ',' or '{' before it
+		const char *begin;
+		const char *end;
+	};
+	struct Transaction
+	{
+		const char *json_begin; // the transaction's object within the payload, at its '{'
+		const char *json_members_end; // at its '}'
+		vector<MemberRange> rewritten_members; // total_sent, spent_outputs, amount, approx_float_amount
+		optional<MemberRange> payment_id_member;
+		uint64_t id;
+		uint64_t height; // 0 while in the mempool
+		bool mempool;
+		uint64_t total_received;
+		uint64_t total_sent;
+		bool has_total_sent;
+		bool has_spent_outputs;
+		bool has_short_payment_id; // 16 hex, i.e. encrypted - which the server can't filter on outgoing txs
+		vector<SpentOutput> spent_outputs;
+	};
+	struct Payload
+	{ // a get_address_txs response
+		uint64_t scanned_height;
+		uint64_t scanned_block_height;
+		uint64_t start_height;
+		uint64_t transaction_height;
+		uint64_t blockchain_height;
+		vector<Transaction> transactions;
+	};
+	//
+	// A wallet's transaction history from a get_address_txs response, as Parsed_AddressTransactions
+	// of mymonero-response-parser-utils builds it - in one pass and with uint64_t amounts, rather than
+	// a JSBigInt per amount and a bridge call per spent output.
+	//
+	// Reads the response in a single pass. The payload points into [begin, end), which must
+	// outlive it. With applied_height, the confirmed transactions at or below it are read past
+	// and left out, as a refresh of Wallet::State needs. Throws StreamingJSON::ParseError.
+	void read_payload(const char *begin, const char *end, Payload &out__payload, optional<uint64_t> applied_height = none);
+	//
+	// The spent outputs of every transaction in order, for deriving their key images as one batch
+	void spent_output_refs(const Payload &payload, vector<KeyImages::OutputRef> &out__outputs);
+	//
+	// Drops the spent outputs whose key image isn't the wallet's - ring members of someone else's
+	// transaction - taking their amounts off total_sent, then the transactions which neither
+	// receive nor send, and orders the rest mempool first, then by id descending.
+	// wallet_key_images are in spent_output_refs order. Returns the error, if any
+	optional<string> filter_owned(Payload &payload, const vector<crypto::key_image> &wallet_key_images);
+	//
+	// { account_scanned_height, account_scanned_block_height, account_scan_start_height,
+	//   transaction_height, blockchain_height, serialized_transactions: [ ... ] }
+	// Each transaction is the server's, with the filtered spent_outputs and total_sent, the
+	// signed net amount, and approx_float_amount; an outgoing transaction's short payment_id
+	// is removed.
+	string write_history(const Payload &payload);
+}
+
+#endif /* TransactionHistory_hpp */
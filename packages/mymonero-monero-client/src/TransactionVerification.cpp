@@ -0,0 +1,189 @@
+//
+//  TransactionVerification.cpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#include "TransactionVerification.hpp"
+//
+#include <map>
+#include <utility>
+#include "string_tools.h"
+#include "cryptonote_format_utils.h"
+#include "device/device.hpp"
+#include "ringct/rctOps.h"
+#include "ringct/rctSigs.h"
+//
+#include "WorkerPool.hpp"
+//
+using namespace std;
+using namespace boost;
+using namespace SendFunds;
+//
+// Accessory Types
+typedef map<pair<uint64_t, uint64_t>, rct::ctkey> RingMembers; // by (input amount, global index)
+struct InputRef
+{
+	size_t transaction_index;
+	size_t input_index;
+};
+//
+// Accessory functions
+static bool _ring_member(const string &public_key, const optional<string> &rct, uint64_t amount, rct::ctkey &out__member)
+{ // as send_step2 builds its rings: the leading commitment of "rct", else a commitment to the amount in the clear
+	if (!epee::string_tools::hex_to_pod(public_key, out__member.dest)) {
+		return false;
+	}
+	if (rct == boost::none || rct->empty() || *rct == "coinbase") {
+		out__member.mask = rct::zeroCommit(amount);
+		return true;
+	}
+	return rct->size() >= 64 && epee::string_tools::hex_to_pod(rct->substr(0, 64), out__member.mask);
+}
+static optional<string> _ring_members(const SignedTransaction &signed_tx, RingMembers &out__members)
+{
+	if (signed_tx.mix_outs.size() != signed_tx.using_outs.size()) {
+		return string("Expected decoys for each input");
+	}
+	for (size_t i = 0; i < signed_tx.using_outs.size(); ++i) {
+		const SpendableOutput &using_out = signed_tx.using_outs[i];
+		uint64_t input_amount = using_out.rct != boost::none ? 0 : using_out.amount; // RingCT inputs are all of amount 0
+		rct::ctkey member;
+		if (!_ring_member(using_out.public_key, using_out.rct, using_out.amount, member)) {
+			return string("Invalid public key or commitment of a spent output");
+		}
+		out__members[make_pair(input_amount, using_out.global_index)] = member;
+		for (const RandomAmountOutput &mix_out : signed_tx.mix_outs[i]) {
+			if (!_ring_member(mix_out.public_key, mix_out.rct, using_out.amount, member)) {
+				return string("Invalid public key or commitment of a decoy");
+			}
+			out__members[make_pair(input_amount, mix_out.global_index)] = member;
+		}
+	}
+	return boost::none;
+}
+// Parses the transaction and fills in what a node derives rather than reads: the prefix hash,
+// key images, output keys, proof commitments and the rings
+static optional<string> _expanded_transaction(const SignedTransaction &signed_tx, cryptonote::transaction &out__tx)
+{
+	string blob;
+	if (!epee::string_tools::parse_hexstr_to_binbuff(signed_tx.serialized_signed_tx, blob)
+		|| !cryptonote::parse_and_validate_tx_from_blob(blob, out__tx)) {
+		return string("Unable to parse the signed transaction");
+	}
+	rct::rctSig &rv = out__tx.rct_signatures;
+	if (rv.type != rct::RCTTypeCLSAG && rv.type != rct::RCTTypeBulletproofPlus) {
+		return string("Unexpected signature type");
+	}
+	if (!cryptonote::expand_transaction_1(out__tx, false)
+		|| rv.p.CLSAGs.size() != out__tx.vin.size()
+		|| rv.p.pseudoOuts.size() != out__tx.vin.size()) {
+		return string("Malformed signatures");
+	}
+	RingMembers ring_members;
+	optional<string> err_msg = _ring_members(signed_tx, ring_members);
+	if (err_msg != boost::none) {
+		return err_msg;
+	}
+	rv.message = rct::hash2rct(cryptonote::get_transaction_prefix_hash(out__tx));
+	rv.mixRing.resize(out__tx.vin.size());
+	for (size_t n = 0; n < out__tx.vin.size(); ++n) {
+		const cryptonote::txin_to_key *input = boost::get<cryptonote::txin_to_key>(&out__tx.vin[n]);
+		if (input == NULL) {
+			return string("Unexpected input type");
+		}
+		rv.p.CLSAGs[n].I = rct::ki2rct(input->k_image);
+		rv.mixRing[n].clear();
+		for (uint64_t global_index : cryptonote::relative_output_offsets_to_absolute(input->key_offsets)) {
+			RingMembers::const_iterator member = ring_members.find(make_pair(input->amount, global_index));
+			if (member == ring_members.end()) {
+				return string("Ring member is not among the outputs it was signed with");
+			}
+			rv.mixRing[n].push_back(member->second);
+		}
+	}
+	return boost::none;
+}
+static string _named(const string &err_msg, size_t transaction_index, size_t n_transactions)
+{
+	if (n_transactions == 1) {
+		return err_msg;
+	}
+	return "Transaction " + std::to_string(transaction_index) + ": " + err_msg;
+}
+//
+// Imperatives
+optional<string> SendFunds::verify_signed_transactions(const vector<const SignedTransaction *> &transactions)
+{
+	const size_t n_transactions = transactions.size();
+	vector<cryptonote::transaction> txs(n_transactions);
+	vector<const rct::rctSig *> rct_sigs(n_transactions);
+	vector<rct::key> messages(n_transactions); // what each CLSAG signs
+	vector<InputRef> inputs;
+	for (size_t t = 0; t < n_transactions; ++t) {
+		optional<string> err_msg = _expanded_transaction(*transactions[t], txs[t]);
+		if (err_msg != boost::none) {
+			return _named(*err_msg, t, n_transactions);
+		}
+		rct_sigs[t] = &txs[t].rct_signatures;
+		messages[t] = rct::get_pre_mlsag_hash(txs[t].rct_signatures, hw::get_device("default"));
+		for (size_t n = 0; n < txs[t].vin.size(); ++n) {
+			inputs.push_back(InputRef{ t, n });
+		}
+	}
+	// Balance and range proofs - a failed batch is rechecked one by one only to name the culprit
+	if (!rct::verRctSemanticsSimple(rct_sigs)) {
+		for (size_t t = 0; t < n_transactions; ++t) {
+			if (!rct::verRctSemanticsSimple(*rct_sigs[t])) {
+				return _named("Invalid range proof or unbalanced amounts", t, n_transactions);
+			}
+		}
+		return string("Invalid range proof or unbalanced amounts");
+	}
+	// Ring signatures
+	vector<char> is_valid(inputs.size(), 0); // per-index slots
+	Runtime::WorkerPool::shared().parallel_for(inputs.size(), 1, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			const rct::rctSig &rv = txs[inputs[i].transaction_index].rct_signatures;
+			size_t n = inputs[i].input_index;
+			is_valid[i] = rct::verRctCLSAGSimple(
+				messages[inputs[i].transaction_index],
+				rv.p.CLSAGs[n],
+				rv.mixRing[n],
+				rv.p.pseudoOuts[n]
+			) ? 1 : 0;
+		}
+	});
+	for (size_t i = 0; i < inputs.size(); ++i) {
+		if (!is_valid[i]) {
+			return _named("Invalid ring signature of input " + std::to_string(inputs[i].input_index), inputs[i].transaction_index, n_transactions);
+		}
+	}
+	return boost::none;
+}
@@ -0,0 +1,63 @@
+//
+//  TransactionVerification.hpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#ifndef TransactionVerification_hpp
+#define TransactionVerification_hpp
+
+#include <string>
+#include <vector>
+#include <boost/optional/optional.hpp>
+#include "monero_send_routine.hpp"
+
+namespace SendFunds
+{
+	using namespace std;
+	using namespace boost;
+	using namespace monero_transfer_utils;
+	//
+	// Accessory Types
+	struct SignedTransaction
+	{
+		string serialized_signed_tx; // hex, as returned to the caller
+		vector<SpendableOutput> using_outs;
+		vector<vector<RandomAmountOutput>> mix_outs; // per using_out, the decoys it was signed with
+	};
+	//
+	// Checks signed transactions as a node would before relaying them - ring signatures, range
+	// proofs and balance - with the rings they were signed against standing in for the chain.
+	// The range proofs of every transaction are checked in one batch, i.e. one multiexp, and the
+	// CLSAGs of every input are spread over the WorkerPool. Returns the error, if any, naming the
+	// transaction when there are several.
+	optional<string> verify_signed_transactions(const vector<const SignedTransaction *> &transactions);
+}
+
+#endif /* TransactionVerification_hpp */
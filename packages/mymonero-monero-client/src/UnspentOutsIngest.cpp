@@ -0,0 +1,88 @@
+//
+//  UnspentOutsIngest.cpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#include "UnspentOutsIngest.hpp"
+//
+#include <algorithm>
+#include <iterator>
+//
+using namespace std;
+using namespace boost;
+using namespace SendFunds;
+//
+// Imperatives
+optional<string> UnspentOutsIngest::append(UnspentOuts &chunk)
+{
+	if (this->is_finished) {
+		return string("Unspent outputs were already finished");
+	}
+	vector<bool> is_spent;
+	bool r = find_spent_outputs(this->deriver, chunk.outputs, is_spent);
+	this->deriver.clear_derivations_cache(); // outputs of one tx arrive together; don't hold them all
+	if (!r) {
+		return string("Unable to generate key image");
+	}
+	this->outputs.reserve(this->outputs.size() + chunk.outputs.size());
+	for (size_t i = 0; i < chunk.outputs.size(); ++i) {
+		if (!is_spent[i]) {
+			this->outputs.emplace_back();
+			this->outputs.back().spendable = std::move(chunk.outputs[i].spendable);
+		}
+	}
+	chunk.outputs.clear();
+	for (const auto &field : chunk.fields) {
+		if (field.first != "outputs") {
+			this->fields.put(field.first, field.second.data());
+		}
+	}
+	//
+	return boost::none;
+}
+void UnspentOutsIngest::take(UnspentOuts &out__unspentOuts)
+{
+	for (const auto &field : this->fields) {
+		if (out__unspentOuts.fields.find(field.first) == out__unspentOuts.fields.not_found()) {
+			out__unspentOuts.fields.put(field.first, field.second.data());
+		}
+	}
+	if (out__unspentOuts.fields.find("outputs") == out__unspentOuts.fields.not_found()) {
+		out__unspentOuts.fields.put_child("outputs", property_tree::ptree()); // for new__parsed_res__get_unspent_outs
+	}
+	if (out__unspentOuts.outputs.empty()) {
+		out__unspentOuts.outputs = std::move(this->outputs);
+	} else {
+		out__unspentOuts.outputs.reserve(out__unspentOuts.outputs.size() + this->outputs.size());
+		std::move(this->outputs.begin(), this->outputs.end(), std::back_inserter(out__unspentOuts.outputs));
+	}
+	this->outputs.clear();
+	this->fields.clear();
+}
@@ -0,0 +1,82 @@
+//
+//  UnspentOutsIngest.hpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#ifndef UnspentOutsIngest_hpp
+#define UnspentOutsIngest_hpp
+
+#include <string>
+#include <vector>
+#include <boost/optional/optional.hpp>
+#include "KeyImages.hpp"
+#include "SendFundsFormSubmissionController.hpp"
+
+namespace SendFunds
+{
+	using namespace std;
+	using namespace boost;
+	//
+	// A get_unspent_outs response which arrives in chunks over several bridge calls - e.g. one
+	// per page as they're downloaded - so that no call has to copy or parse the whole of it.
+	//
+	// Each chunk's outputs are checked for spends as they're appended, with the same key image
+	// test as cb_I, and only the unspent ones are kept; the derivations are dropped after each
+	// chunk, so what's held between calls is the kept outputs alone. A finished ingest is then
+	// consumed by the prepare_send which names it, in place of (or in addition to) its
+	// unspentOuts.outputs.
+	//
+	class UnspentOutsIngest
+	{
+	public:
+		//
+		// Lifecycle - Init
+		UnspentOutsIngest(const KeyImages::Deriver &deriver) : deriver(deriver), is_finished(false) {}
+		UnspentOutsIngest(const UnspentOutsIngest &) = delete;
+		UnspentOutsIngest &operator=(const UnspentOutsIngest &) = delete;
+		//
+		// Imperatives
+		optional<string> append(UnspentOuts &chunk); // returns the error, if any; consumes chunk.outputs
+		void finish() { this->is_finished = true; }
+		// Appends the kept outputs to out__unspentOuts, and the fee and fork fields which it lacks
+		void take(UnspentOuts &out__unspentOuts);
+		//
+		// Accessors
+		bool isFinished() const { return this->is_finished; }
+		size_t size() const { return this->outputs.size(); }
+	private:
+		KeyImages::Deriver deriver;
+		property_tree::ptree fields; // of every chunk, later chunks' overriding
+		vector<UnspentOutput> outputs; // unspent, so their spend candidates are cleared
+		bool is_finished;
+	};
+}
+
+#endif /* UnspentOutsIngest_hpp */
@@ -1,5 +1,7 @@
 'use strict'
 
+const WireFormat = require('./WireFormat')
+
 class WABridge {
   constructor (module) {
     this.Module = module
@@ -27,76 +29,51 @@ class WABridge {
    * @param {string} options.nettype - The network name eg MAINNET.
    * @param {object} options.unspentOuts - List of unspent outs as well as per byte fee.
    * @param {randomOutsCallback} options.randomOutsCb - Used to fetch the random outs from the light wallet service.
+   * @param {boolean} options.useWireFormat - Pass outputs and decoys to WebAssembly in binary rather than JSON. Defaults to true when supported.
+   * @param {string} options.walletContext - A handle from openWalletContext, used in place of address and the keys.
+   * @param {boolean} options.collectMetrics - Add a metrics object with per-phase timings to the result.
+   * @param {boolean} options.verifyBeforeReturn - Verify the ring signatures, range proofs and balance of the
+   * signed transaction, against the outputs it was signed with, and throw rather than return it if they fail.
+   * @param {string} options.outputIndex - 'minimizeInputs' or 'consolidateDust': spend from the wallet context's
+   * output index (see outputIndexAdd) rather than options.unspentOuts.outputs, which may then be empty.
+   * @param {string} options.unspentOutsId - Finished unspent outputs from beginUnspentOuts or ingestUnspentOuts, in place of
+   * options.unspentOuts, which may then be left out. They are freed by the call.
    * @returns
    */
   async createTransaction (options) {
     const self = this
-    checkPriority(options.priority)
-    checkNetType(options.nettype)
-    if (options.privateViewKey.length !== 64) {
-      throw Error('Invalid privateViewKey length')
-    }
-    if (options.publicSpendKey.length !== 64) {
-      throw Error('Invalid publicSpendKey length')
-    }
-    if (options.privateSpendKey.length !== 64) {
-      throw Error('Invalid privateSpendKey length')
-    }
-    if (typeof options.randomOutsCb !== 'function') {
-      throw Error('Invalid randomsOutCB not a function')
-    }
-    if (!Array.isArray(options.destinations)) {
-      throw Error('Invalid destinations')
-    }
-    options.destinations.forEach(function (destination) {
-      if (!destination.hasOwnProperty('to_address') || !destination.hasOwnProperty('send_amount')) {
-        throw Error('Invalid destinations missing values')
-      }
-    })
-    if (options.shouldSweep) {
-      if (options.destinations.length !== 1) {
-        throw Error('Invalid number of destinations must be 1')
-      }
-      if (options.destinations[0].send_amount !== 0) {
-        throw Error('Invalid amount when sweeping amount must be 0')
-      }
-    }
-
-    // check if destinations is set correctly
-    const args =
-    {
-      destinations: options.destinations,
-      is_sweeping: options.shouldSweep,
-      from_address_string: options.address,
-      sec_viewKey_string: options.privateViewKey,
-      sec_spendKey_string: options.privateSpendKey,
-      pub_spendKey_string: options.publicSpendKey,
-      priority: '' + options.priority,
-      nettype_string: options.nettype,
-      manuallyEnteredPaymentID: options.paymentId,
-      unspentOuts: options.unspentOuts
-    }
-
-    if (options.paymentId === undefined) {
-      args.manuallyEnteredPaymentID = ''
-    }
+    const args = transactionArgs(options)
 
+    const useWireFormat = options.useWireFormat !== false && !options.outputIndex && !options.unspentOutsId && typeof this.Module.prepareTxWire === 'function' && WireFormat.isSupported()
+    let sessionId = null
     try {
       // WebAssembly keeps state between calls so we can prepare the tx before getting the random out and signing tx
-      const retString = this.Module.prepareTx(JSON.stringify(args, null, ''))
-      const ret = JSON.parse(retString)
+      const retString = useWireFormat ? this._prepareTxWire(args) : this.Module.prepareTx(JSON.stringify(args, null, ''))
+      let ret = JSON.parse(retString)
       // check for any errors passed back from WebAssembly
       if (ret.err_msg) {
         throw Error(ret.err_msg)
       }
-      // fetch random decoys
-      const randomOuts = await self._getRandomOuts(ret.amounts.length, options.randomOutsCb)
-      // send random decoys on and complete the tx creation
-      const retString2 = this.Module.createAndSignTx(JSON.stringify(randomOuts))
-      const rawTx = JSON.parse(retString2)
-      // check for any errors passed back from WebAssembly
-      if (rawTx.err_msg) {
-        throw Error(rawTx.err_msg)
+      sessionId = ret.session_id
+      let rawTx = null
+      while (rawTx === null) {
+        // fetch random decoys
+        const randomOuts = await self._getRandomOuts(ret.amounts.length, options.randomOutsCb)
+        // send random decoys on and complete the tx creation
+        const retString2 = useWireFormat ? this._createAndSignTxWire(sessionId, randomOuts) : this.Module.createAndSignTx(JSON.stringify(Object.assign({ session_id: sessionId }, randomOuts)))
+        const result = JSON.parse(retString2)
+        if (result.amounts !== undefined && !result.err_msg) {
+          // the fee converged on a larger input set - only the newly selected inputs need decoys
+          ret = result
+          continue
+        }
+        // signing or failing releases the send session
+        sessionId = null
+        // check for any errors passed back from WebAssembly
+        if (result.err_msg) {
+          throw Error(result.err_msg)
+        }
+        rawTx = result
       }
       // parse variables ruturned as strings
       rawTx.mixin = parseInt(rawTx.mixin)
@@ -104,6 +81,10 @@ class WABridge {
       
       return rawTx
     } catch (exception) {
+      if (sessionId !== null) {
+        // the send was abandoned before signing so free its state in WebAssembly
+        this.Module.releaseSendSession(sessionId)
+      }
       // check for exceptions thrown by WebAssembly that is only a pointer id
       // this is for missed exceptions we havent handled in the code and returned in the err_msg response
       if (!isNaN(exception)) {
@@ -114,6 +95,134 @@ class WABridge {
     }
   }
 
+  /**
+   * Creates as many transactions as a large payout or sweep needs, where createTransaction would
+   * fail with 'Transaction too big'. Destinations (or, when sweeping, the wallet's outputs) are split
+   * across the fewest transactions within the output and input limits, and the decoys for all of
+   * them are fetched with one randomOutsCb call.
+   * Takes the options of createTransaction, except that paymentId and useWireFormat aren't supported:
+   * pay payment ids to integrated addresses, of which each transaction takes one. With verifyBeforeReturn,
+   * the transactions are verified together, with the range proofs of all of them checked in one batch.
+   * @param {object} options - As for createTransaction.
+   * @returns {array} The signed transactions, each as returned by createTransaction.
+   */
+  async createTransactions (options) {
+    if (options.paymentId) {
+      throw Error('Payment IDs aren\'t supported in batch sends; use integrated addresses')
+    }
+    const args = transactionArgs(options)
+    delete args.metrics
+
+    let sessionId = null
+    try {
+      let ret = JSON.parse(this.Module.prepareBatchTx(JSON.stringify(args)))
+      if (ret.err_msg) {
+        throw Error(ret.err_msg)
+      }
+      sessionId = ret.session_id
+      while (ret.amounts !== undefined) {
+        const randomOuts = await this._getRandomOuts(ret.amounts.length, options.randomOutsCb)
+        ret = JSON.parse(this.Module.createAndSignBatchTx(JSON.stringify(Object.assign({ session_id: sessionId }, randomOuts))))
+        if (ret.err_msg) {
+          sessionId = null // failing releases the batch
+          throw Error(ret.err_msg)
+        }
+      }
+      sessionId = null
+      return ret.transactions.map(function (rawTx) {
+        rawTx.mixin = parseInt(rawTx.mixin)
+        rawTx.isXMRAddressIntegrated = rawTx.isXMRAddressIntegrated === 'true'
+        return rawTx
+      })
+    } catch (exception) {
+      if (sessionId !== null) {
+        this.Module.releaseBatchSendSession(sessionId)
+      }
+      if (!isNaN(exception)) {
+        throw Error(this.Module.getExceptionMessage(exception))
+      } else {
+        throw exception
+      }
+    }
+  }
+
+  /**
+   * Returns how createTransactions would split a batch, given only the amounts: the destinations and
+   * the wallet's outputs each transaction takes.
+   * @param {object} options
+   * @param {array} options.sendingAmounts - Amounts in atomic units, as strings, one per destination.
+   * @param {array} [options.isIntegrated] - Whether each destination is an integrated address.
+   * @param {array} options.outputAmounts - Amounts in atomic units, as strings, of the unspent outputs.
+   * @param {string} [options.feePerb] - Fee per byte, as from unspentOuts.per_byte_fee.
+   * @param {string} [options.feePerOutput] - Fee per output, as from unspentOuts.fee_per_output.
+   * @param {number} [options.priority] - 1 to 4.
+   * @param {boolean} [options.isSweeping]
+   * @returns {array} [{ destinationIndices, outputIndices }], one per transaction.
+   */
+  planTransactions (options) {
+    const args = {
+      sending_amounts: options.sendingAmounts || [],
+      is_integrated: options.isIntegrated || [],
+      output_amounts: options.outputAmounts,
+      fee_per_b: '' + (options.feePerb || 0),
+      fee_per_o: '' + (options.feePerOutput || 0),
+      priority: '' + (options.priority || 1),
+      is_sweeping: options.isSweeping === true
+    }
+    const ret = JSON.parse(this.Module.planBatchTx(JSON.stringify(args)))
+    if (ret.err_msg) {
+      throw Error(ret.err_msg)
+    }
+
+    return ret.transactions.map(function (planned) {
+      return { destinationIndices: planned.destination_indices, outputIndices: planned.output_indices }
+    })
+  }
+
+  /**
+   * Checks a signed transaction as verifyBeforeReturn does - ring signatures, range proofs and balance -
+   * e.g. one signed on another device, against the outputs and decoys it was signed with.
+   * @param {object} options
+   * @param {string} options.serializedSignedTx - As serialized_signed_tx of createTransaction's result.
+   * @param {array} options.usingOuts - The unspentOuts outputs it spends, in input order.
+   * @param {array} options.mixOuts - Per using out, the amount_outs entry of its decoys, as from randomOutsCb.
+   * @returns {boolean} True; a transaction which doesn't verify throws.
+   */
+  verifyTransaction (options) {
+    const args = {
+      serialized_signed_tx: options.serializedSignedTx,
+      using_outs: options.usingOuts,
+      mix_outs: options.mixOuts
+    }
+    const ret = JSON.parse(this.Module.verifyTx(JSON.stringify(args)))
+    if (ret.err_msg) {
+      throw Error(ret.err_msg)
+    }
+
+    return true
+  }
+
+  /**
+   * Returns cumulative timings of every send since the module was loaded.
+   * @returns {object} Counts of prepared, signed, reconstructed and failed sends, and per phase
+   * (parseArgs, decryptOutputs, selectOutputs, tieOutsToMixOuts, signTransaction, verifyTransaction, serializeResponse)
+   * the count, total_ns and max_ns, then the heap_in_use_bytes and heap_peak_bytes of now. All values are decimal strings.
+   */
+  sendMetrics () {
+    return JSON.parse(this.Module.sendMetrics())
+  }
+
+  /**
+   * Builds the generator and multiexp tables of the range proofs, which the first send would
+   * otherwise build while the user waits. The loader calls this unless options.warmUp is false.
+   * @param {boolean} inBackground - On the multi-threaded build, build them on a pthread and return
+   * at once; a send which starts meanwhile waits for them.
+   * @returns {boolean} true when this call started the warm-up, false when it already happened.
+   */
+  warmUpProofs (inBackground = false) {
+    return this.Module.warmUpProofs(inBackground === true)
+  }
+
   /**
    * Generates a random short payment id.
    * @returns {string} new 16 char short Payment id.
@@ -160,6 +269,483 @@ class WABridge {
     return ret.retVal
   }
 
+  /**
+   * Connects to the WASM to generate the Key Images of many outputs in one call.
+   * The wallet keys are parsed once and derivations are shared by outputs of the same transaction.
+   * @param {string} privateViewKey - The wallet private view key.
+   * @param {string} publicSpendKey - The spend public key.
+   * @param {string} privateSpendKey - The spend secret key.
+   * @param {array} outputs - List of { txPublicKey, outputIndex } objects.
+   * @returns {array} Returns the key images in the same order as outputs.
+   */
+  generateKeyImages (privateViewKey, publicSpendKey, privateSpendKey, outputs) {
+    if (!Array.isArray(outputs)) {
+      throw Error('Invalid outputs')
+    }
+    if (outputs.length === 0) {
+      return [] // before the key checks, as a view only wallet has no private spend key
+    }
+    if (privateViewKey.length !== 64) {
+      throw Error('Invalid privateViewKey length')
+    }
+    if (publicSpendKey.length !== 64) {
+      throw Error('Invalid publicSpendKey length')
+    }
+    if (privateSpendKey.length !== 64) {
+      throw Error('Invalid privateSpendKey length')
+    }
+    const args = {
+      sec_viewKey_string: privateViewKey,
+      pub_spendKey_string: publicSpendKey,
+      sec_spendKey_string: privateSpendKey,
+      outputs: outputs.map(function (output) {
+        if (typeof output.txPublicKey !== 'string' || output.txPublicKey.length !== 64) {
+          throw Error('Invalid txPublicKey length')
+        }
+        if (output.outputIndex === '' || output.outputIndex == null || isNaN(output.outputIndex)) {
+          throw Error('Invalid outputIndex is not a number')
+        }
+        return { tx_pub_key: output.txPublicKey, out_index: '' + output.outputIndex }
+      })
+    }
+    const retString = this.Module.generateKeyImages(JSON.stringify(args))
+    const ret = JSON.parse(retString)
+    if (ret.err_msg) {
+      throw Error(ret.err_msg)
+    }
+    const keyImages = new Array(outputs.length)
+    for (let i = 0; i < outputs.length; i++) {
+      keyImages[i] = ret.retVal.substr(i * 64, 64)
+    }
+
+    return keyImages
+  }
+
+  /**
+   * Returns the key image of an output from the wallet's key image cache inside the WASM,
+   * generating and caching it on a miss.
+   * @param {string} address - The wallet primary address the cache belongs to.
+   * @param {string} txPublicKey - The output public key.
+   * @param {string} privateViewKey - The wallet private view key.
+   * @param {string} publicSpendKey - The spend public key.
+   * @param {string} privateSpendKey - The spend secret key.
+   * @param {number} outputIndex - The output index within the transaction.
+   * @returns {string} Returns the key image.
+   */
+  cachedKeyImage (address, txPublicKey, privateViewKey, publicSpendKey, privateSpendKey, outputIndex) {
+    if (!address) {
+      throw Error('Invalid address')
+    }
+    if (outputIndex === '' || outputIndex == null || isNaN(outputIndex)) {
+      throw Error('Invalid outputIndex is not a number')
+    }
+    const retString = this.Module.cachedKeyImage(address, txPublicKey, privateViewKey, publicSpendKey, privateSpendKey, '' + outputIndex)
+    const ret = JSON.parse(retString)
+    if (ret.err_msg) {
+      throw Error(ret.err_msg)
+    }
+
+    return ret.retVal
+  }
+
+  /**
+   * Parses and validates a wallet's keys once, keeping them in WebAssembly for the calls which take a wallet context.
+   * Close the context when the wallet is removed from memory, which wipes the keys.
+   * @param {string} address - The wallet primary address.
+   * @param {string} privateViewKey - The wallet private view key.
+   * @param {string} privateSpendKey - The spend secret key.
+   * @param {string} nettype - The network name eg MAINNET.
+   * @returns {string} The wallet context handle.
+   */
+  openWalletContext (address, privateViewKey, privateSpendKey, nettype) {
+    checkNetType(nettype)
+    const retString = this.Module.openWalletContext(address, privateViewKey, privateSpendKey, nettype)
+    const ret = JSON.parse(retString)
+    if (ret.err_msg) {
+      throw Error(ret.err_msg)
+    }
+
+    return ret.retVal
+  }
+
+  /**
+   * Closes a wallet context from openWalletContext, wiping its keys.
+   * @param {string} walletContext - The wallet context handle.
+   * @returns {boolean} True if the context was open.
+   */
+  closeWalletContext (walletContext) {
+    return this.Module.closeWalletContext(walletContext)
+  }
+
+  /**
+   * As cachedKeyImage, with the wallet's address and keys taken from a wallet context.
+   * @param {string} walletContext - The wallet context handle.
+   * @param {string} txPublicKey - The output public key.
+   * @param {number} outputIndex - The output index within the transaction.
+   * @returns {string} Returns the key image.
+   */
+  contextKeyImage (walletContext, txPublicKey, outputIndex) {
+    if (outputIndex === '' || outputIndex == null || isNaN(outputIndex)) {
+      throw Error('Invalid outputIndex is not a number')
+    }
+    const retString = this.Module.contextKeyImage(walletContext, txPublicKey, '' + outputIndex)
+    const ret = JSON.parse(retString)
+    if (ret.err_msg) {
+      throw Error(ret.err_msg)
+    }
+
+    return ret.retVal
+  }
+
+  /**
+   * As generateKeyImages, with the keys taken from a wallet context.
+   * @param {string} walletContext - The wallet context handle.
+   * @param {array} outputs - List of { txPublicKey, outputIndex } objects.
+   * @returns {array} Returns the key images in the same order as outputs.
+   */
+  contextKeyImages (walletContext, outputs) {
+    if (!Array.isArray(outputs)) {
+      throw Error('Invalid outputs')
+    }
+    if (outputs.length === 0) {
+      return []
+    }
+    const args = {
+      wallet_context: walletContext,
+      outputs: outputs.map(function (output) {
+        if (typeof output.txPublicKey !== 'string' || output.txPublicKey.length !== 64) {
+          throw Error('Invalid txPublicKey length')
+        }
+        if (output.outputIndex === '' || output.outputIndex == null || isNaN(output.outputIndex)) {
+          throw Error('Invalid outputIndex is not a number')
+        }
+        return { tx_pub_key: output.txPublicKey, out_index: '' + output.outputIndex }
+      })
+    }
+    const ret = JSON.parse(this.Module.generateKeyImages(JSON.stringify(args)))
+    if (ret.err_msg) {
+      throw Error(ret.err_msg)
+    }
+    const keyImages = new Array(outputs.length)
+    for (let i = 0; i < outputs.length; i++) {
+      keyImages[i] = ret.retVal.substr(i * 64, 64)
+    }
+
+    return keyImages
+  }
+
+  /**
+   * Finds the outputs which belong to the wallet of a wallet context, e.g. from blocks fetched from a node.
+   * @param {string} walletContext - The wallet context handle.
+   * @param {array} transactions - List of { tx_pub_key, additional_pub_keys, outputs } objects, where each output is
+   * { public_key, view_tag, commitment, encrypted_amount, amount } and all but public_key are optional.
+   * @param {boolean} withKeyImages - Also derive the key image of each owned output.
+   * @returns {array} The owned outputs as { tx_index, index, public_key, amount, key_image } objects.
+   */
+  scanOutputs (walletContext, transactions, withKeyImages = false) {
+    if (!Array.isArray(transactions)) {
+      throw Error('Invalid transactions')
+    }
+    const args = {
+      wallet_context: walletContext,
+      key_images: withKeyImages,
+      transactions: transactions
+    }
+    const ret = JSON.parse(this.Module.scanOutputs(JSON.stringify(args)))
+    if (ret.err_msg) {
+      throw Error(ret.err_msg)
+    }
+
+    return ret.outputs
+  }
+
+  /**
+   * Parses a get_address_txs response into the wallet's transaction history in one call, as
+   * Parsed_AddressTransactions of mymonero-response-parser-utils does: spent outputs whose key image isn't the
+   * wallet's are dropped and their amounts taken off total_sent, transactions which neither receive nor send are
+   * dropped, and amount and approx_float_amount are added. The key images come from the address's key image cache.
+   * @param {(string|object)} payload - The get_address_txs response. A response string is passed on as it is,
+   * without being parsed in JavaScript.
+   * @param {object} wallet - { walletContext } from openWalletContext, or { address, privateViewKey, publicSpendKey,
+   * privateSpendKey }.
+   * @returns {object} { account_scanned_height, account_scanned_block_height, account_scan_start_height,
+   * transaction_height, blockchain_height, serialized_transactions }, the transactions mempool first and then
+   * newest first.
+   */
+  parseOwnedTransactions (payload, wallet) {
+    let args
+    if (wallet.walletContext) {
+      args = { wallet_context: wallet.walletContext }
+    } else {
+      if (typeof wallet.privateViewKey !== 'string' || wallet.privateViewKey.length !== 64) {
+        throw Error('Invalid privateViewKey length')
+      }
+      if (typeof wallet.publicSpendKey !== 'string' || wallet.publicSpendKey.length !== 64) {
+        throw Error('Invalid publicSpendKey length')
+      }
+      if (typeof wallet.privateSpendKey !== 'string' || wallet.privateSpendKey.length !== 64) {
+        throw Error('Invalid privateSpendKey length')
+      }
+      args = {
+        address: wallet.address || '',
+        sec_viewKey_string: wallet.privateViewKey,
+        pub_spendKey_string: wallet.publicSpendKey,
+        sec_spendKey_string: wallet.privateSpendKey
+      }
+    }
+    const payloadString = typeof payload === 'string' ? payload : JSON.stringify(payload)
+    const ret = JSON.parse(this.Module.parseOwnedTransactions(JSON.stringify(args), payloadString))
+    if (ret.err_msg) {
+      throw Error(ret.err_msg)
+    }
+
+    return ret
+  }
+
+  /**
+   * Applies a get_address_txs response to the wallet context's state, which keeps the balances and spends between
+   * refreshes: only the confirmed transactions above the last scanned block height are applied, so only their spent
+   * outputs need key images, and the mempool transactions replace the previous ones.
+   * @param {string} walletContext - The wallet context handle.
+   * @param {(string|object)} payload - The get_address_txs response. A response string is passed on as it is.
+   * @returns {object} { balances, isDelta, history }. history is as parseOwnedTransactions returns, with the new
+   * confirmed transactions and every mempool one. isDelta is false when it holds every transaction - the first time,
+   * or after the server rescanned - which should then replace rather than extend the wallet's list.
+   */
+  applyAddressTxs (walletContext, payload) {
+    const payloadString = typeof payload === 'string' ? payload : JSON.stringify(payload)
+    const ret = JSON.parse(this.Module.applyAddressTxs(walletContext, payloadString))
+    if (ret.err_msg) {
+      throw Error(ret.err_msg)
+    }
+
+    return { balances: ret.balances, isDelta: ret.is_delta, history: ret.history }
+  }
+
+  /**
+   * Adds the wallet's outputs to the wallet context's state, which tracks whether each is spent, pending or unspent.
+   * Key images are only derived for outputs the state doesn't hold yet.
+   * @param {string} walletContext - The wallet context handle.
+   * @param {array} outputs - Outputs as in a get_unspent_outs response.
+   * @returns {number} The number of outputs held.
+   */
+  addOwnedOutputs (walletContext, outputs) {
+    if (!Array.isArray(outputs)) {
+      throw Error('Invalid outputs')
+    }
+    const ret = JSON.parse(this.Module.addOwnedOutputs(JSON.stringify({ wallet_context: walletContext, outputs: outputs })))
+    if (ret.err_msg) {
+      throw Error(ret.err_msg)
+    }
+
+    return parseInt(ret.retVal)
+  }
+
+  /**
+   * The balances of the wallet context's state as of the last applyAddressTxs. Amounts are strings of atomic units.
+   * @param {string} walletContext - The wallet context handle.
+   * @returns {object} { balance, unlocked_balance, pending_balance, total_received, total_sent, locked_received,
+   * locked_sent, pending_received, pending_sent, account_scanned_block_height, blockchain_height }
+   */
+  walletStateBalances (walletContext) {
+    const ret = JSON.parse(this.Module.walletStateBalances(walletContext))
+    if (ret.err_msg) {
+      throw Error(ret.err_msg)
+    }
+
+    return ret
+  }
+
+  /**
+   * The outputs held by the wallet context's state, oldest first.
+   * @param {string} walletContext - The wallet context handle.
+   * @returns {array} [{ public_key, tx_pub_key, index, amount, height, key_image, status }], status being 'unspent',
+   * 'pending' (spent by a mempool transaction) or 'spent'.
+   */
+  walletStateOutputs (walletContext) {
+    const ret = JSON.parse(this.Module.walletStateOutputs(walletContext))
+    if (ret.err_msg) {
+      throw Error(ret.err_msg)
+    }
+
+    return ret.outputs
+  }
+
+  /**
+   * Serializes the wallet context's state so a restarted wallet can resume from it with loadWalletStateSnapshot.
+   * @param {string} walletContext - The wallet context handle.
+   * @returns {Uint8Array} The binary snapshot.
+   */
+  walletStateSnapshot (walletContext) {
+    const snapshot = new Uint8Array(this.Module.walletStateSnapshot(walletContext)) // copy out of the WASM heap
+    if (snapshot.length === 0) {
+      throw Error('Unknown or closed wallet context')
+    }
+
+    return snapshot
+  }
+
+  /**
+   * Loads a snapshot from walletStateSnapshot into the wallet context's state, replacing it.
+   * @param {string} walletContext - The wallet context handle.
+   * @param {Uint8Array} snapshot - The binary snapshot.
+   * @returns {boolean} False if the snapshot was not valid, or was of another wallet.
+   */
+  loadWalletStateSnapshot (walletContext, snapshot) {
+    if (!(snapshot instanceof Uint8Array)) {
+      throw Error('Invalid snapshot')
+    }
+    return this.Module.loadWalletStateSnapshot(walletContext, snapshot)
+  }
+
+  /**
+   * Adds outputs to the wallet context's output index, which createTransaction spends from with the outputIndex
+   * option. Add outputs as they're received - e.g. the outputs of a get_unspent_outs response, of which any found
+   * spent are left out - and remove them once they're spent.
+   * @param {string} walletContext - The wallet context handle.
+   * @param {array} outputs - Outputs as in a get_unspent_outs response.
+   * @returns {number} The number of indexed outputs.
+   */
+  outputIndexAdd (walletContext, outputs) {
+    if (!Array.isArray(outputs)) {
+      throw Error('Invalid outputs')
+    }
+    const ret = JSON.parse(this.Module.outputIndexAdd(JSON.stringify({ wallet_context: walletContext, outputs: outputs })))
+    if (ret.err_msg) {
+      throw Error(ret.err_msg)
+    }
+
+    return parseInt(ret.retVal)
+  }
+
+  /**
+   * Removes spent outputs from the wallet context's output index.
+   * @param {string} walletContext - The wallet context handle.
+   * @param {array} publicKeys - The public keys of the outputs.
+   * @returns {number} The number of indexed outputs.
+   */
+  outputIndexRemove (walletContext, publicKeys) {
+    if (!Array.isArray(publicKeys)) {
+      throw Error('Invalid publicKeys')
+    }
+    const ret = JSON.parse(this.Module.outputIndexRemove(JSON.stringify({ wallet_context: walletContext, public_keys: publicKeys })))
+    if (ret.err_msg) {
+      throw Error(ret.err_msg)
+    }
+
+    return parseInt(ret.retVal)
+  }
+
+  /**
+   * Starts taking a wallet's unspent outputs in chunks, for responses too large to pass to
+   * createTransaction whole. Append each chunk with appendUnspentOuts, then call finishUnspentOuts and
+   * pass the returned id to createTransaction as unspentOutsId.
+   * @param {string} walletContext - The wallet context handle, whose keys check the outputs for spends.
+   * @returns {string} The unspent outputs id.
+   */
+  beginUnspentOuts (walletContext) {
+    const ret = JSON.parse(this.Module.beginUnspentOuts(JSON.stringify({ wallet_context: walletContext })))
+    if (ret.err_msg) {
+      throw Error(ret.err_msg)
+    }
+
+    return ret.retVal
+  }
+
+  /**
+   * Appends a chunk of unspent outputs, which are checked for spends straight away so that only the
+   * unspent ones are held.
+   * @param {string} unspentOutsId - From beginUnspentOuts.
+   * @param {(string|object)} chunk - Shaped like a get_unspent_outs response: any of its fee fields, and outputs.
+   * A response string is passed on as it is, without being parsed in JavaScript.
+   * @returns {number} The number of unspent outputs so far.
+   */
+  appendUnspentOuts (unspentOutsId, chunk) {
+    const chunkString = typeof chunk === 'string' ? chunk : JSON.stringify(chunk)
+    const ret = JSON.parse(this.Module.appendUnspentOuts(unspentOutsId, chunkString))
+    if (ret.err_msg) {
+      throw Error(ret.err_msg)
+    }
+
+    return parseInt(ret.retVal)
+  }
+
+  /**
+   * Marks the unspent outputs complete, ready for createTransaction's unspentOutsId.
+   * @param {string} unspentOutsId - From beginUnspentOuts.
+   * @returns {number} The number of unspent outputs.
+   */
+  finishUnspentOuts (unspentOutsId) {
+    const ret = JSON.parse(this.Module.finishUnspentOuts(unspentOutsId))
+    if (ret.err_msg) {
+      throw Error(ret.err_msg)
+    }
+
+    return parseInt(ret.retVal)
+  }
+
+  /**
+   * Frees unspent outputs which won't be passed to createTransaction, which otherwise frees them.
+   * @param {string} unspentOutsId - From beginUnspentOuts.
+   * @returns {boolean} True if there were unspent outputs to free.
+   */
+  releaseUnspentOuts (unspentOutsId) {
+    return this.Module.releaseUnspentOuts(unspentOutsId)
+  }
+
+  /**
+   * Takes the unspent outputs page by page as they are downloaded: each page is appended while the
+   * iterator is free to be fetching the next one.
+   * @param {string} walletContext - The wallet context handle.
+   * @param {AsyncIterable} pages - Chunks as taken by appendUnspentOuts.
+   * @returns {string} The unspent outputs id for createTransaction, finished.
+   */
+  async ingestUnspentOuts (walletContext, pages) {
+    const unspentOutsId = this.beginUnspentOuts(walletContext)
+    try {
+      for await (const page of pages) {
+        this.appendUnspentOuts(unspentOutsId, page)
+      }
+      this.finishUnspentOuts(unspentOutsId)
+    } catch (exception) {
+      this.releaseUnspentOuts(unspentOutsId)
+      throw exception
+    }
+
+    return unspentOutsId
+  }
+
+  /**
+   * Serializes the wallet's key image cache so it can be persisted and loaded on the next start.
+   * @param {string} address - The wallet primary address the cache belongs to.
+   * @returns {Uint8Array} The binary snapshot.
+   */
+  keyImageCacheSnapshot (address) {
+    return new Uint8Array(this.Module.keyImageCacheSnapshot(address)) // copy out of the WASM heap
+  }
+
+  /**
+   * Loads a snapshot from keyImageCacheSnapshot into the wallet's key image cache.
+   * @param {string} address - The wallet primary address the cache belongs to.
+   * @param {Uint8Array} snapshot - The binary snapshot.
+   * @returns {boolean} False if the snapshot was not valid.
+   */
+  loadKeyImageCacheSnapshot (address, snapshot) {
+    if (!(snapshot instanceof Uint8Array)) {
+      throw Error('Invalid snapshot')
+    }
+    return this.Module.loadKeyImageCacheSnapshot(address, snapshot)
+  }
+
+  /**
+   * Deletes the wallet's key image cache. Call this when removing a wallet from memory.
+   * @param {string} address - The wallet primary address the cache belongs to.
+   * @returns {boolean} True if a cache existed.
+   */
+  deleteKeyImageCache (address) {
+    return this.Module.deleteKeyImageCache(address)
+  }
+
   /**
    * Estimates the transaction fee based on two outputs.
    * @param {number} priority - The priority level the estimate is for.
@@ -178,6 +764,66 @@ class WABridge {
     return parseInt(ret.retVal)
   }
 
+  /**
+   * Calculates the exact fee of every transaction shape in a range at once, for every priority - what
+   * createTransaction would charge a transaction with that many inputs and outputs (change included).
+   * @param {number} feePerb - The fee per byte. This is retrieved from the MM server.
+   * @param {object} options
+   * @param {number} options.maxInputs - Fees are for 1 through maxInputs inputs (at most 1024). Defaults to 16.
+   * @param {number} options.maxOutputs - Fees are for 1 through maxOutputs outputs (at most 16). Defaults to 16.
+   * @param {array} options.forkVersions - The fork versions to calculate for. Defaults to [0], the latest.
+   * @param {number} options.feeMask - The fee quantization mask (fee_mask of the MM server). Defaults to 10000.
+   * @param {number} options.extraSize - Bytes of tx extra, e.g. for a payment id. Defaults to 0.
+   * @returns {object} { forkVersions, maxInputs, maxOutputs, fees, fee(priority, nInputs, nOutputs, forkVersion) }, where fees
+   * holds every fee in piconeros nested fork version, priority, inputs then outputs, and fee() looks one up.
+   */
+  estimateFeeMatrix (feePerb, options = {}) {
+    if (isNaN(feePerb) || feePerb <= 0) {
+      throw Error('Invalid feePerb. must be an number')
+    }
+    const forkVersions = options.forkVersions || [0]
+    const maxInputs = options.maxInputs || 16
+    const maxOutputs = options.maxOutputs || 16
+    if (!Array.isArray(forkVersions) || forkVersions.length === 0 || forkVersions.some(version => !Number.isInteger(version) || version < 0 || version > 255)) {
+      throw Error('Invalid forkVersions')
+    }
+    if (!Number.isInteger(maxInputs) || maxInputs < 1 || maxInputs > 1024 || !Number.isInteger(maxOutputs) || maxOutputs < 1 || maxOutputs > 16) {
+      throw Error('Invalid maxInputs or maxOutputs')
+    }
+    const args = {
+      fee_per_b: '' + feePerb,
+      fee_mask: '' + (options.feeMask || 10000),
+      fork_versions: forkVersions.map(version => '' + version),
+      max_inputs: '' + maxInputs,
+      max_outputs: '' + maxOutputs,
+      extra_size: '' + (options.extraSize || 0)
+    }
+    const packed = this.Module.estimateFeeMatrix(JSON.stringify(args))
+    if (typeof packed === 'string') {
+      throw Error(JSON.parse(packed).err_msg)
+    }
+    const count = forkVersions.length * FEE_MATRIX_PRIORITIES * maxInputs * maxOutputs
+    const view = new DataView(packed.buffer, packed.byteOffset, packed.byteLength)
+    const fees = new Float64Array(count)
+    for (let i = 0; i < count; i++) {
+      fees[i] = Number(view.getBigUint64(i * 8, true))
+    }
+    return {
+      forkVersions: forkVersions,
+      maxInputs: maxInputs,
+      maxOutputs: maxOutputs,
+      fees: fees,
+      fee (priority, nInputs, nOutputs, forkVersion = forkVersions[0]) {
+        checkPriority(priority)
+        const forkIndex = forkVersions.indexOf(forkVersion)
+        if (forkIndex < 0 || nInputs < 1 || nInputs > maxInputs || nOutputs < 1 || nOutputs > maxOutputs) {
+          throw Error('Outside of the fee matrix')
+        }
+        return fees[((forkIndex * FEE_MATRIX_PRIORITIES + priority - 1) * maxInputs + nInputs - 1) * maxOutputs + nOutputs - 1]
+      }
+    }
+  }
+
   /**
    * Derives the seed and keys from the mnemonic string.
    * @param {string} mnemonic - The string of mnemonic words.
@@ -251,6 +897,45 @@ class WABridge {
     }
   }
 
+  /**
+   * Decodes a list of addresses in one call, e.g. to validate a payout list. Unlike decodeAddress,
+   * an invalid address doesn't throw - its entry has isValid false.
+   * @param {array} addresses - The addresses to decode.
+   * @param {string} nettype - The network name eg MAINNET.
+   * @returns {array} One breakdown per address, in the same order.
+   */
+  decodeAddresses (addresses, nettype) {
+    checkNetType(nettype)
+    if (!Array.isArray(addresses)) {
+      throw Error('Invalid addresses')
+    }
+    addresses.forEach(function (address) {
+      if (typeof address !== 'string' || address.includes('\n')) {
+        throw Error('Invalid addresses')
+      }
+    })
+    // every address is newline-terminated so that a trailing empty string still gets its record
+    const records = this.Module.decodeAddresses(addresses.map(address => address + '\n').join(''), nettype)
+    const decoded = []
+    for (let i = 0; i < addresses.length; i++) {
+      const record = records.subarray(i * DECODED_ADDRESS_SIZE, (i + 1) * DECODED_ADDRESS_SIZE)
+      const status = record[0]
+      if (status === 0) {
+        decoded.push({ isValid: false })
+        continue
+      }
+      decoded.push({
+        isValid: true,
+        publicSpendKey: bytesToHex(record.subarray(16, 48)),
+        publicViewKey: bytesToHex(record.subarray(48, 80)),
+        paymentId: status === 3 ? bytesToHex(record.subarray(8, 16)) : undefined,
+        isSubaddress: status === 2,
+        isIntegrated: status === 3
+      })
+    }
+    return decoded
+  }
+
   /**
    * Creates a new wallet based on the locale.
    * @param {string} localeLanguageCode The locale  based on language and Country. eg. en-US.
@@ -376,10 +1061,173 @@ class WABridge {
 
     return randomOuts
   }
+
+  /**
+   * Calls prepareTxWire with the unspent outputs written straight into the WASM heap.
+   * Falls back to prepareTx if an output can't be represented in the wire format.
+   * @param {object} args - The prepareTx arguments.
+   * @returns {string} The prepareTx response.
+   */
+  _prepareTxWire (args) {
+    const outputs = args.unspentOuts.outputs || []
+    const byteLength = WireFormat.unspentOutputsByteLength(outputs)
+    if (byteLength === null) {
+      return this.Module.prepareTx(JSON.stringify(args))
+    }
+    const unspentOuts = Object.assign({}, args.unspentOuts)
+    delete unspentOuts.outputs // carried by the buffer
+    const argsString = JSON.stringify(Object.assign({}, args, { unspentOuts: unspentOuts }))
+
+    return this._withHeapBytes(byteLength, function (bytes) {
+      WireFormat.writeUnspentOutputs(bytes, outputs)
+    }, (pointer) => this.Module.prepareTxWire(argsString, pointer, byteLength))
+  }
+
+  /**
+   * Calls createAndSignTxWire with the random outs written straight into the WASM heap.
+   * Falls back to createAndSignTx if an output can't be represented in the wire format.
+   * @param {string} sessionId - From the prepareTx response.
+   * @param {object} randomOuts - The randomOutsCb response.
+   * @returns {string} The createAndSignTx response.
+   */
+  _createAndSignTxWire (sessionId, randomOuts) {
+    const byteLength = WireFormat.randomOutsByteLength(randomOuts.amount_outs)
+    if (byteLength === null) {
+      return this.Module.createAndSignTx(JSON.stringify(Object.assign({ session_id: sessionId }, randomOuts)))
+    }
+
+    return this._withHeapBytes(byteLength, function (bytes) {
+      WireFormat.writeRandomOuts(bytes, randomOuts.amount_outs)
+    }, (pointer) => this.Module.createAndSignTxWire(sessionId, pointer, byteLength))
+  }
+
+  /**
+   * Allocates byteLength bytes in the WASM heap, fills them with write and passes the pointer to call.
+   * The bytes are freed once call returns.
+   */
+  _withHeapBytes (byteLength, write, call) {
+    const pointer = this.Module._malloc(byteLength)
+    if (!pointer) {
+      throw Error('Unable to allocate ' + byteLength + ' bytes in WebAssembly')
+    }
+    try {
+      // HEAPU8 is re-read here since the heap may have grown since the last call
+      write(this.Module.HEAPU8.subarray(pointer, pointer + byteLength))
+      return call(pointer)
+    } finally {
+      this.Module._free(pointer)
+    }
+  }
 }
 
 module.exports = WABridge
 
+// Size of a record returned by Module.decodeAddresses - see src/emscr_Address_bridge.hpp
+const DECODED_ADDRESS_SIZE = 80
+// Priorities in a Module.estimateFeeMatrix table - see src/FeeMatrix.hpp
+const FEE_MATRIX_PRIORITIES = 4
+
+function bytesToHex (bytes) {
+  let hex = ''
+  for (let i = 0; i < bytes.length; i++) {
+    hex += (bytes[i] < 16 ? '0' : '') + bytes[i].toString(16)
+  }
+  return hex
+}
+
+// Validates the createTransaction / createTransactions options and builds the prepareTx arguments
+function transactionArgs (options) {
+  checkPriority(options.priority)
+  checkNetType(options.nettype)
+  if (!options.walletContext) {
+    if (options.privateViewKey.length !== 64) {
+      throw Error('Invalid privateViewKey length')
+    }
+    if (options.publicSpendKey.length !== 64) {
+      throw Error('Invalid publicSpendKey length')
+    }
+    if (options.privateSpendKey.length !== 64) {
+      throw Error('Invalid privateSpendKey length')
+    }
+  }
+  if (typeof options.randomOutsCb !== 'function') {
+    throw Error('Invalid randomsOutCB not a function')
+  }
+  if (!Array.isArray(options.destinations)) {
+    throw Error('Invalid destinations')
+  }
+  options.destinations.forEach(function (destination) {
+    if (!destination.hasOwnProperty('to_address') || !destination.hasOwnProperty('send_amount')) {
+      throw Error('Invalid destinations missing values')
+    }
+  })
+  if (options.shouldSweep) {
+    if (options.destinations.length !== 1) {
+      throw Error('Invalid number of destinations must be 1')
+    }
+    if (options.destinations[0].send_amount !== 0) {
+      throw Error('Invalid amount when sweeping amount must be 0')
+    }
+  }
+
+  // check if destinations is set correctly
+  const args =
+  {
+    destinations: options.destinations,
+    is_sweeping: options.shouldSweep,
+    from_address_string: options.address,
+    sec_viewKey_string: options.privateViewKey,
+    sec_spendKey_string: options.privateSpendKey,
+    pub_spendKey_string: options.publicSpendKey,
+    priority: '' + options.priority,
+    nettype_string: options.nettype,
+    manuallyEnteredPaymentID: options.paymentId,
+    unspentOuts: options.unspentOuts
+  }
+  if (options.collectMetrics) {
+    args.metrics = true
+  }
+  if (options.verifyBeforeReturn) {
+    args.verify_before_return = true
+  }
+  if (options.walletContext) {
+    // the keys and address were validated by openWalletContext
+    args.wallet_context = options.walletContext
+    delete args.from_address_string
+    delete args.sec_viewKey_string
+    delete args.sec_spendKey_string
+    delete args.pub_spendKey_string
+  }
+
+  if (options.outputIndex) {
+    if (!options.walletContext) {
+      throw Error('Invalid outputIndex without walletContext')
+    }
+    if (OUTPUT_INDEX_STRATEGIES[options.outputIndex] === undefined) {
+      throw Error('Invalid outputIndex strategy')
+    }
+    args.output_index = OUTPUT_INDEX_STRATEGIES[options.outputIndex]
+    // only the fee fields are needed; the outputs come from the index
+    args.unspentOuts = Object.assign({}, options.unspentOuts, { outputs: [] })
+  }
+
+  if (options.unspentOutsId) {
+    // the outputs, and fee fields which unspentOuts doesn't have, come from appendUnspentOuts
+    args.unspent_outs_id = options.unspentOutsId
+    if (args.unspentOuts === undefined) {
+      delete args.unspentOuts
+    }
+  }
+
+  if (options.paymentId === undefined) {
+    args.manuallyEnteredPaymentID = ''
+  }
+
+  return args
+}
+
+const OUTPUT_INDEX_STRATEGIES = { minimizeInputs: 'minimize_inputs', consolidateDust: 'consolidate_dust' }
+
 function checkNetType (netType) {
   switch (netType) {
     case 'MAINNET':
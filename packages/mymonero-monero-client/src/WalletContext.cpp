@@ -0,0 +1,117 @@
+//
+//  WalletContext.cpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+//
+#include "WalletContext.hpp"
+//
+#include "string_tools.h"
+#include "cryptonote_basic_impl.h"
+//
+using namespace std;
+using namespace boost;
+using namespace Wallet;
+//
+// Runtime - Memory
+static const size_t contexts__capacity = 32;
+static const std::chrono::minutes contexts__ttl(30); // only evicted when the table is full
+//
+ContextRegistry &Wallet::contexts()
+{
+	static ContextRegistry registry(contexts__capacity, contexts__ttl);
+	return registry;
+}
+const char *Wallet::checkout_error(const ContextRegistry::Checkout &context)
+{
+	return context.is_busy() ? "Wallet context busy" : "Unknown or closed wallet context";
+}
+//
+// Accessory functions
+optional<string> Wallet::parsed_account_keys(
+	const string &address,
+	const string &sec_viewKey_string,
+	const string &sec_spendKey_string,
+	cryptonote::network_type nettype,
+	AccountKeys &out__keys
+) {
+	cryptonote::address_parse_info info;
+	if (!cryptonote::get_account_address_from_str(info, nettype, address)) {
+		return string("Invalid address");
+	}
+	if (info.is_subaddress || info.has_payment_id) {
+		return string("Expected a primary address");
+	}
+	if (!epee::string_tools::hex_to_pod(sec_viewKey_string, out__keys.sec_viewKey)) {
+		return string("Invalid privateViewKey");
+	}
+	if (!epee::string_tools::hex_to_pod(sec_spendKey_string, out__keys.sec_spendKey)) {
+		return string("Invalid privateSpendKey");
+	}
+	if (!crypto::secret_key_to_public_key(out__keys.sec_viewKey, out__keys.pub_viewKey)
+		|| out__keys.pub_viewKey != info.address.m_view_public_key) {
+		return string("Private view key does not match address");
+	}
+	if (!crypto::secret_key_to_public_key(out__keys.sec_spendKey, out__keys.pub_spendKey)
+		|| out__keys.pub_spendKey != info.address.m_spend_public_key) {
+		return string("Private spend key does not match address");
+	}
+	return none;
+}
+//
+// Lifecycle - Init
+Context::Context(const string &address, cryptonote::network_type nettype, const AccountKeys &keys)
+	: _address(address),
+	_nettype(nettype),
+	_keys(keys),
+	_keys__lock(&this->_keys, sizeof(this->_keys))
+{
+	ge_p3 pub_spendKey__p3;
+	ge_frombytes_vartime(&pub_spendKey__p3, (const unsigned char *)&this->_keys.pub_spendKey); // valid - derived from sec_spendKey
+	ge_p3_to_cached(&this->pub_spendKey__cached, &pub_spendKey__p3);
+}
+//
+// Imperatives
+bool Context::derive_output_public_key(
+	const crypto::key_derivation &derivation,
+	size_t output_index,
+	crypto::public_key &out__output_public_key
+) const {
+	crypto::ec_scalar scalar;
+	crypto::derivation_to_scalar(derivation, output_index, scalar);
+	ge_p3 point;
+	ge_p1p1 sum;
+	ge_p2 sum__p2;
+	ge_scalarmult_base(&point, (const unsigned char *)&scalar);
+	ge_add(&sum, &point, &this->pub_spendKey__cached);
+	ge_p1p1_to_p2(&sum__p2, &sum);
+	ge_tobytes((unsigned char *)&out__output_public_key, &sum__p2);
+	//
+	return true;
+}
@@ -0,0 +1,125 @@
+//
+//  WalletContext.hpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#ifndef WalletContext_hpp
+#define WalletContext_hpp
+
+#include <string>
+#include <boost/optional/optional.hpp>
+#include "crypto.h"
+#include "mlocker.h"
+#include "cryptonote_config.h"
+#include "SlotRegistry.hpp"
+#include "KeyImages.hpp"
+#include "OutputIndex.hpp"
+#include "WalletState.hpp"
+extern "C" {
+#include "crypto-ops.h"
+}
+
+namespace Wallet
+{
+	using namespace std;
+	using namespace boost;
+	//
+	// Accessory Types
+	struct AccountKeys
+	{
+		crypto::secret_key sec_viewKey; // scrubbed on destruction, like every crypto::secret_key
+		crypto::secret_key sec_spendKey;
+		crypto::public_key pub_viewKey;
+		crypto::public_key pub_spendKey;
+	};
+	//
+	// Parses the hex keys and checks them against the primary address; returns the error, if any
+	optional<string> parsed_account_keys(
+		const string &address,
+		const string &sec_viewKey_string,
+		const string &sec_spendKey_string,
+		cryptonote::network_type nettype,
+		AccountKeys &out__keys
+	);
+	//
+	// A wallet's keys, parsed and validated once by open_wallet_context and then addressed by
+	// handle, so that the key image and send entry points don't re-parse hex on every call.
+	//
+	// The keys live in pages which are mlocked for the lifetime of the context (a no-op under
+	// emscripten, which has no swap) and are wiped when the context is closed or evicted.
+	//
+	class Context
+	{
+	public:
+		//
+		// Lifecycle - Init
+		Context(const string &address, cryptonote::network_type nettype, const AccountKeys &keys);
+		Context(const Context &) = delete;
+		Context &operator=(const Context &) = delete;
+		//
+		// Accessors
+		const string &address() const { return this->_address; }
+		cryptonote::network_type nettype() const { return this->_nettype; }
+		const AccountKeys &keys() const { return this->_keys; }
+		KeyImages::Deriver deriver() const
+		{
+			return KeyImages::Deriver(this->_keys.sec_viewKey, this->_keys.sec_spendKey);
+		}
+		// The wallet's unspent outputs, for sends which select from the context rather than
+		// from unspentOuts.outputs; maintained by the caller as outputs are received and spent
+		Outputs::Index &outputs() { return this->_outputs; }
+		// Balances, spends and outputs as of the last refresh - see emscr_WalletState_bridge
+		State &state() { return this->_state; }
+		//
+		// Imperatives
+		// crypto::derive_public_key(derivation, output_index, pub_spendKey) without decompressing
+		// the spend key each time, e.g. to test whether an output belongs to the wallet
+		bool derive_output_public_key(
+			const crypto::key_derivation &derivation,
+			size_t output_index,
+			crypto::public_key &out__output_public_key
+		) const;
+	private:
+		string _address;
+		cryptonote::network_type _nettype;
+		AccountKeys _keys;
+		epee::mlocker _keys__lock;
+		ge_cached pub_spendKey__cached; // precomputed addend of derive_output_public_key
+		Outputs::Index _outputs;
+		State _state;
+	};
+	//
+	// Open contexts, shared by the bridges
+	typedef Runtime::SlotRegistry<Context> ContextRegistry;
+	ContextRegistry &contexts();
+	const char *checkout_error(const ContextRegistry::Checkout &context); // why a Checkout of a context failed
+}
+
+#endif /* WalletContext_hpp */
@@ -0,0 +1,329 @@
+//
+//  WalletState.cpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#include "WalletState.hpp"
+//
+#include <algorithm>
+#include <cstring>
+//
+using namespace std;
+using namespace boost;
+using namespace Wallet;
+//
+// Constants - Persistence
+static const char snapshot__magic[4] = { 'M', 'M', 'W', 'S' };
+static const uint32_t snapshot__version = 1;
+static const size_t snapshot__locked_transaction_size = 3 * sizeof(uint64_t);
+static const size_t snapshot__output_size = sizeof(crypto::public_key) * 2 + sizeof(crypto::key_image) + 3 * sizeof(uint64_t);
+//
+// Accessory functions - Persistence
+static void _append_le(string &dst, uint64_t value, size_t n_bytes)
+{
+	for (size_t i = 0; i < n_bytes; ++i) {
+		dst.push_back((char)((value >> (8 * i)) & 0xff));
+	}
+}
+template <typename T>
+static void _append_pod(string &dst, const T &pod)
+{
+	dst.append((const char *)&pod, sizeof(T));
+}
+class SnapshotReader
+{ // bounds-checked; every read fails once one has
+public:
+	SnapshotReader(const string &snapshot) : cursor(snapshot.data()), end(snapshot.data() + snapshot.size()), is_ok(true) {}
+	//
+	uint64_t le(size_t n_bytes)
+	{
+		if (!this->_take(n_bytes)) {
+			return 0;
+		}
+		const char *src = this->cursor - n_bytes;
+		uint64_t value = 0;
+		for (size_t i = 0; i < n_bytes; ++i) {
+			value |= (uint64_t)(uint8_t)src[i] << (8 * i);
+		}
+		return value;
+	}
+	template <typename T>
+	void pod(T &out__pod)
+	{
+		if (this->_take(sizeof(T))) {
+			memcpy(&out__pod, this->cursor - sizeof(T), sizeof(T));
+		}
+	}
+	bool has(uint64_t n_records, size_t record_size) const
+	{ // so a corrupt count can't make the caller reserve more than the snapshot holds
+		return this->is_ok && n_records <= (uint64_t)(this->end - this->cursor) / record_size;
+	}
+	bool ok() const { return this->is_ok; }
+	bool at_end() const { return this->is_ok && this->cursor == this->end; }
+private:
+	const char *cursor;
+	const char *end;
+	bool is_ok;
+	//
+	bool _take(size_t n_bytes)
+	{
+		if (!this->is_ok || (size_t)(this->end - this->cursor) < n_bytes) {
+			this->is_ok = false;
+			return false;
+		}
+		this->cursor += n_bytes;
+		return true;
+	}
+};
+//
+// Imperatives - Transactions
+void State::apply(const History::Payload &payload)
+{
+	this->pending_received = 0;
+	this->pending_sent = 0;
+	this->pending_key_images.clear();
+	size_t n_locked_before = this->locked_transactions.size();
+	for (const History::Transaction &tx : payload.transactions) {
+		if (tx.mempool) {
+			this->pending_received += tx.total_received;
+			this->pending_sent += tx.total_sent;
+			for (const History::SpentOutput &spent_output : tx.spent_outputs) {
+				this->pending_key_images.insert(spent_output.key_image);
+			}
+			continue;
+		}
+		this->total_received += tx.total_received;
+		this->total_sent += tx.total_sent;
+		for (const History::SpentOutput &spent_output : tx.spent_outputs) {
+			this->spent_key_images.insert(spent_output.key_image);
+		}
+		this->locked_transactions.push_back(LockedTransaction{ tx.height, tx.total_received, tx.total_sent });
+	}
+	// the delta comes in id order, newest first - and a few blocks' worth at most are still locked
+	std::sort(this->locked_transactions.begin() + n_locked_before, this->locked_transactions.end(), [](const LockedTransaction &a, const LockedTransaction &b) {
+		return a.height < b.height;
+	});
+	std::inplace_merge(this->locked_transactions.begin(), this->locked_transactions.begin() + n_locked_before, this->locked_transactions.end(), [](const LockedTransaction &a, const LockedTransaction &b) {
+		return a.height < b.height;
+	});
+	this->_has_applied = true;
+	this->_scanned_block_height = payload.scanned_block_height;
+	this->_blockchain_height = payload.blockchain_height;
+	this->_unlock_transactions();
+}
+void State::_unlock_transactions()
+{ // confirmations as Transaction.js counts them: blockchain_height - height + 1
+	while (!this->locked_transactions.empty()
+		&& this->locked_transactions.front().height + unlocked_confirmations <= this->_blockchain_height + 1) {
+		this->locked_transactions.pop_front();
+	}
+}
+//
+// Imperatives - Outputs
+bool State::has_output(const crypto::public_key &public_key) const
+{
+	return this->outputs.find(public_key) != this->outputs.end();
+}
+void State::add_output(const OwnedOutput &output)
+{
+	this->outputs[output.public_key] = output;
+}
+//
+void State::clear()
+{
+	this->clear_transactions();
+	this->outputs.clear();
+}
+void State::clear_transactions()
+{
+	this->_has_applied = false;
+	this->_scanned_block_height = 0;
+	this->_blockchain_height = 0;
+	this->total_received = 0;
+	this->total_sent = 0;
+	this->locked_transactions.clear();
+	this->pending_received = 0;
+	this->pending_sent = 0;
+	this->spent_key_images.clear();
+	this->pending_key_images.clear();
+}
+//
+// Accessors
+optional<uint64_t> State::applied_height() const
+{
+	if (!this->_has_applied) {
+		return none;
+	}
+	return this->_scanned_block_height;
+}
+Balances State::balances() const
+{
+	Balances balances{};
+	balances.total_received = this->total_received;
+	balances.total_sent = this->total_sent;
+	for (const LockedTransaction &tx : this->locked_transactions) {
+		balances.locked_received += tx.received;
+		balances.locked_sent += tx.sent;
+	}
+	balances.pending_received = this->pending_received;
+	balances.pending_sent = this->pending_sent;
+	return balances;
+}
+OutputStatus State::status_of(const OwnedOutput &output) const
+{
+	if (this->spent_key_images.find(output.key_image) != this->spent_key_images.end()) {
+		return spent;
+	}
+	if (this->pending_key_images.find(output.key_image) != this->pending_key_images.end()) {
+		return pendingSpend;
+	}
+	return unspent;
+}
+void State::all_outputs(vector<OwnedOutput> &out__outputs) const
+{
+	size_t n_outputs_before = out__outputs.size();
+	for (const auto &entry : this->outputs) {
+		out__outputs.push_back(entry.second);
+	}
+	std::sort(out__outputs.begin() + n_outputs_before, out__outputs.end(), [](const OwnedOutput &a, const OwnedOutput &b) {
+		return a.height < b.height;
+	});
+}
+//
+// Imperatives - Persistence
+string State::snapshot(const crypto::public_key &pub_spendKey) const
+{
+	string snapshot;
+	snapshot.reserve(
+		128 + this->locked_transactions.size() * snapshot__locked_transaction_size
+		+ (this->spent_key_images.size() + this->pending_key_images.size()) * sizeof(crypto::key_image)
+		+ this->outputs.size() * snapshot__output_size
+	);
+	snapshot.append(snapshot__magic, sizeof(snapshot__magic));
+	_append_le(snapshot, snapshot__version, sizeof(uint32_t));
+	_append_pod(snapshot, pub_spendKey);
+	_append_le(snapshot, this->_has_applied ? 1 : 0, sizeof(uint8_t));
+	_append_le(snapshot, this->_scanned_block_height, sizeof(uint64_t));
+	_append_le(snapshot, this->_blockchain_height, sizeof(uint64_t));
+	_append_le(snapshot, this->total_received, sizeof(uint64_t));
+	_append_le(snapshot, this->total_sent, sizeof(uint64_t));
+	_append_le(snapshot, this->pending_received, sizeof(uint64_t));
+	_append_le(snapshot, this->pending_sent, sizeof(uint64_t));
+	_append_le(snapshot, this->locked_transactions.size(), sizeof(uint64_t));
+	for (const LockedTransaction &tx : this->locked_transactions) {
+		_append_le(snapshot, tx.height, sizeof(uint64_t));
+		_append_le(snapshot, tx.received, sizeof(uint64_t));
+		_append_le(snapshot, tx.sent, sizeof(uint64_t));
+	}
+	for (const unordered_set<crypto::key_image> *key_images : { &this->spent_key_images, &this->pending_key_images }) {
+		_append_le(snapshot, key_images->size(), sizeof(uint64_t));
+		for (const crypto::key_image &key_image : *key_images) {
+			_append_pod(snapshot, key_image);
+		}
+	}
+	_append_le(snapshot, this->outputs.size(), sizeof(uint64_t));
+	for (const auto &entry : this->outputs) {
+		const OwnedOutput &output = entry.second;
+		_append_pod(snapshot, output.public_key);
+		_append_pod(snapshot, output.output.tx_pub_key);
+		_append_le(snapshot, output.output.out_index, sizeof(uint64_t));
+		_append_pod(snapshot, output.key_image);
+		_append_le(snapshot, output.amount, sizeof(uint64_t));
+		_append_le(snapshot, output.height, sizeof(uint64_t));
+	}
+	return snapshot;
+}
+bool State::load_snapshot(const string &snapshot, const crypto::public_key &pub_spendKey)
+{
+	if (snapshot.size() < sizeof(snapshot__magic) || memcmp(snapshot.data(), snapshot__magic, sizeof(snapshot__magic)) != 0) {
+		return false;
+	}
+	SnapshotReader reader(snapshot);
+	reader.le(sizeof(snapshot__magic));
+	if (reader.le(sizeof(uint32_t)) != snapshot__version) {
+		return false;
+	}
+	crypto::public_key owner{};
+	reader.pod(owner);
+	if (!reader.ok() || owner != pub_spendKey) {
+		return false;
+	}
+	State loaded; // so a bad snapshot leaves this state as it was
+	loaded._has_applied = reader.le(sizeof(uint8_t)) != 0;
+	loaded._scanned_block_height = reader.le(sizeof(uint64_t));
+	loaded._blockchain_height = reader.le(sizeof(uint64_t));
+	loaded.total_received = reader.le(sizeof(uint64_t));
+	loaded.total_sent = reader.le(sizeof(uint64_t));
+	loaded.pending_received = reader.le(sizeof(uint64_t));
+	loaded.pending_sent = reader.le(sizeof(uint64_t));
+	uint64_t n_locked = reader.le(sizeof(uint64_t));
+	if (!reader.has(n_locked, snapshot__locked_transaction_size)) {
+		return false;
+	}
+	for (uint64_t i = 0; i < n_locked; ++i) {
+		LockedTransaction tx;
+		tx.height = reader.le(sizeof(uint64_t));
+		tx.received = reader.le(sizeof(uint64_t));
+		tx.sent = reader.le(sizeof(uint64_t));
+		loaded.locked_transactions.push_back(tx);
+	}
+	for (unordered_set<crypto::key_image> *key_images : { &loaded.spent_key_images, &loaded.pending_key_images }) {
+		uint64_t n_key_images = reader.le(sizeof(uint64_t));
+		if (!reader.has(n_key_images, sizeof(crypto::key_image))) {
+			return false;
+		}
+		key_images->reserve(n_key_images);
+		for (uint64_t i = 0; i < n_key_images; ++i) {
+			crypto::key_image key_image;
+			reader.pod(key_image);
+			key_images->insert(key_image);
+		}
+	}
+	uint64_t n_outputs = reader.le(sizeof(uint64_t));
+	if (!reader.has(n_outputs, snapshot__output_size)) {
+		return false;
+	}
+	loaded.outputs.reserve(n_outputs);
+	for (uint64_t i = 0; i < n_outputs; ++i) {
+		OwnedOutput output;
+		reader.pod(output.public_key);
+		reader.pod(output.output.tx_pub_key);
+		output.output.out_index = reader.le(sizeof(uint64_t));
+		reader.pod(output.key_image);
+		output.amount = reader.le(sizeof(uint64_t));
+		output.height = reader.le(sizeof(uint64_t));
+		loaded.outputs[output.public_key] = output;
+	}
+	if (!reader.at_end()) {
+		return false;
+	}
+	*this = std::move(loaded);
+	return true;
+}
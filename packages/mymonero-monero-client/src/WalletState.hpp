@@ -0,0 +1,148 @@
+//
+//  WalletState.hpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#ifndef WalletState_hpp
+#define WalletState_hpp
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <boost/optional/optional.hpp>
+#include <unordered_map>
+#include <unordered_set>
+#include "crypto.h"
+#include "KeyImages.hpp"
+#include "TransactionHistory.hpp"
+
+namespace Wallet
+{
+	using namespace std;
+	using namespace boost;
+	//
+	// Accessory Types
+	struct OwnedOutput
+	{
+		crypto::public_key public_key;
+		KeyImages::OutputRef output;
+		crypto::key_image key_image;
+		uint64_t amount;
+		uint64_t height;
+	};
+	enum OutputStatus
+	{
+		unspent = 0,
+		pendingSpend = 1, // by a transaction in the mempool
+		spent = 2
+	};
+	struct Balances
+	{ // balance is total_received - total_sent; unlocked balance is that less locked_received - locked_sent
+		uint64_t total_received; // of confirmed transactions
+		uint64_t total_sent;
+		uint64_t locked_received; // of confirmed transactions with fewer than unlocked_confirmations
+		uint64_t locked_sent;
+		uint64_t pending_received; // of transactions in the mempool
+		uint64_t pending_sent;
+	};
+	//
+	// A wallet's balances, spends and outputs, kept between refreshes so that each one only
+	// applies what's new: the confirmed transactions above the last scanned_block_height and
+	// the outputs which aren't held yet. Only their spent outputs and outputs need key images,
+	// and the totals are updated rather than summed again, so a refresh costs O(delta) beyond
+	// reading the server's response.
+	//
+	// Confirmed transactions count as locked as Transaction.js counts them, until they have
+	// unlocked_confirmations. Mempool transactions are replaced on each refresh, as the
+	// server reports all of them every time.
+	//
+	// The state can be written to and read back from a compact binary snapshot, so that a
+	// restarted wallet resumes from where it left off.
+	//
+	class State
+	{
+	public:
+		static const uint64_t unlocked_confirmations = 10;
+		//
+		// Lifecycle - Init
+		State() { this->clear(); }
+		//
+		// Imperatives - Transactions
+		// Applies a get_address_txs response, read with History::read_payload past applied_height()
+		// and then History::filter_owned. A server which is behind the last refresh (a rescan or a
+		// reorg) calls for clear_transactions and the whole response instead.
+		void apply(const History::Payload &payload);
+		//
+		// Imperatives - Outputs
+		bool has_output(const crypto::public_key &public_key) const;
+		void add_output(const OwnedOutput &output); // replaces an output of the same public key
+		//
+		void clear();
+		void clear_transactions(); // keeps the outputs
+		//
+		// Accessors
+		// The scanned_block_height of the last refresh, through which its confirmed transactions are applied
+		optional<uint64_t> applied_height() const;
+		uint64_t scanned_block_height() const { return this->_scanned_block_height; }
+		uint64_t blockchain_height() const { return this->_blockchain_height; }
+		Balances balances() const;
+		OutputStatus status_of(const OwnedOutput &output) const;
+		size_t n_outputs() const { return this->outputs.size(); }
+		void all_outputs(vector<OwnedOutput> &out__outputs) const; // by height
+		//
+		// Imperatives - Persistence
+		// The snapshot names the wallet by its public spend key, and is only loaded into its state
+		string snapshot(const crypto::public_key &pub_spendKey) const;
+		bool load_snapshot(const string &snapshot, const crypto::public_key &pub_spendKey); // false on a malformed or foreign snapshot, leaving the state as it was
+	private:
+		struct LockedTransaction
+		{
+			uint64_t height;
+			uint64_t received;
+			uint64_t sent;
+		};
+		bool _has_applied;
+		uint64_t _scanned_block_height;
+		uint64_t _blockchain_height;
+		uint64_t total_received;
+		uint64_t total_sent;
+		deque<LockedTransaction> locked_transactions; // by height
+		uint64_t pending_received;
+		uint64_t pending_sent;
+		unordered_set<crypto::key_image> spent_key_images;
+		unordered_set<crypto::key_image> pending_key_images;
+		unordered_map<crypto::public_key, OwnedOutput> outputs;
+		//
+		void _unlock_transactions();
+	};
+}
+
+#endif /* WalletState_hpp */
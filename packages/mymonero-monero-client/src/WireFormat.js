@@ -0,0 +1,155 @@
+'use strict'
+
+// Binary layout of the unspent outputs and random outs passed to prepareTxWire / createAndSignTxWire.
+// Must match src/SendFundsWireFormat.hpp. All integers are little-endian.
+const VERSION = 1
+const HEADER_SIZE = 16
+const RCT_CAPACITY = 96
+const KEY_SIZE = 32
+const UNSPENT_OUTPUT_SIZE = 192
+const RANDOM_AMOUNT_SIZE = 16
+const RANDOM_OUTPUT_SIZE = 144
+
+function hexByteLength (hex) {
+  if (hex === undefined || hex === null || hex === '') {
+    return 0
+  }
+  if (typeof hex !== 'string' || hex.length % 2 !== 0 || !/^[0-9a-fA-F]*$/.test(hex)) {
+    return -1
+  }
+  return hex.length / 2
+}
+
+function writeHex (bytes, offset, hex) {
+  for (let i = 0; i < hex.length; i += 2) {
+    bytes[offset + i / 2] = parseInt(hex.substr(i, 2), 16)
+  }
+}
+
+function writeHeader (view, magic, count) {
+  for (let i = 0; i < 4; i++) {
+    view.setUint8(i, magic.charCodeAt(i))
+  }
+  view.setUint32(4, VERSION, true)
+  view.setUint32(8, count, true)
+  view.setUint32(12, 0, true)
+}
+
+/**
+ * Whether this engine can write the layout: the 64-bit integers need BigInt and DataView.setBigUint64,
+ * which e.g. Safari only has from 15. Without them the JSON transport should be used instead.
+ * @returns {boolean}
+ */
+function isSupported () {
+  return typeof BigInt === 'function' &&
+    typeof DataView === 'function' &&
+    typeof DataView.prototype.setBigUint64 === 'function'
+}
+
+/**
+ * Returns the number of bytes writeUnspentOutputs needs, or null if an output can't be
+ * represented (e.g. a non-hex rct) and the JSON transport should be used instead.
+ * @param {array} outputs - The outputs of a get_unspent_outs response.
+ * @returns {?number}
+ */
+function unspentOutputsByteLength (outputs) {
+  let size = HEADER_SIZE
+  for (const output of outputs) {
+    const rctSize = hexByteLength(output.rct)
+    if (rctSize < 0 || rctSize > RCT_CAPACITY) {
+      return null
+    }
+    if (hexByteLength(output.public_key) !== KEY_SIZE || hexByteLength(output.tx_pub_key) !== KEY_SIZE) {
+      return null
+    }
+    const keyImages = output.spend_key_images || []
+    for (const keyImage of keyImages) {
+      if (hexByteLength(keyImage) !== KEY_SIZE) {
+        return null
+      }
+    }
+    size += UNSPENT_OUTPUT_SIZE + keyImages.length * KEY_SIZE
+  }
+  return size
+}
+
+/**
+ * Writes the outputs into bytes, which must be unspentOutputsByteLength(outputs) long.
+ * @param {Uint8Array} bytes - Usually a view of the WASM heap.
+ * @param {array} outputs - The outputs of a get_unspent_outs response.
+ */
+function writeUnspentOutputs (bytes, outputs) {
+  const view = new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength)
+  writeHeader(view, 'MMUO', outputs.length)
+  bytes.fill(0, HEADER_SIZE)
+  let offset = HEADER_SIZE
+  for (const output of outputs) {
+    const keyImages = output.spend_key_images || []
+    const rct = output.rct || ''
+    view.setBigUint64(offset, BigInt(output.amount), true)
+    view.setBigUint64(offset + 8, BigInt(output.global_index), true)
+    view.setBigUint64(offset + 16, BigInt(output.index), true)
+    writeHex(bytes, offset + 24, output.public_key)
+    writeHex(bytes, offset + 56, output.tx_pub_key)
+    view.setUint32(offset + 88, rct.length / 2, true)
+    view.setUint32(offset + 92, keyImages.length, true)
+    writeHex(bytes, offset + 96, rct)
+    offset += UNSPENT_OUTPUT_SIZE
+    for (const keyImage of keyImages) {
+      writeHex(bytes, offset, keyImage)
+      offset += KEY_SIZE
+    }
+  }
+}
+
+/**
+ * Returns the number of bytes writeRandomOuts needs, or null if an output can't be represented.
+ * @param {array} amountOuts - The amount_outs of a get_random_outs response.
+ * @returns {?number}
+ */
+function randomOutsByteLength (amountOuts) {
+  let size = HEADER_SIZE
+  for (const amountOut of amountOuts) {
+    for (const output of amountOut.outputs) {
+      const rctSize = hexByteLength(output.rct)
+      if (rctSize < 0 || rctSize > RCT_CAPACITY || hexByteLength(output.public_key) !== KEY_SIZE) {
+        return null
+      }
+    }
+    size += RANDOM_AMOUNT_SIZE + amountOut.outputs.length * RANDOM_OUTPUT_SIZE
+  }
+  return size
+}
+
+/**
+ * Writes the random outs into bytes, which must be randomOutsByteLength(amountOuts) long.
+ * @param {Uint8Array} bytes - Usually a view of the WASM heap.
+ * @param {array} amountOuts - The amount_outs of a get_random_outs response.
+ */
+function writeRandomOuts (bytes, amountOuts) {
+  const view = new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength)
+  writeHeader(view, 'MMRO', amountOuts.length)
+  bytes.fill(0, HEADER_SIZE)
+  let offset = HEADER_SIZE
+  for (const amountOut of amountOuts) {
+    view.setBigUint64(offset, BigInt(amountOut.amount), true)
+    view.setUint32(offset + 8, amountOut.outputs.length, true)
+    offset += RANDOM_AMOUNT_SIZE
+    for (const output of amountOut.outputs) {
+      const rct = output.rct || ''
+      view.setBigUint64(offset, BigInt(output.global_index), true)
+      writeHex(bytes, offset + 8, output.public_key)
+      view.setUint32(offset + 40, rct.length / 2, true)
+      writeHex(bytes, offset + 48, rct)
+      offset += RANDOM_OUTPUT_SIZE
+    }
+  }
+}
+
+module.exports = {
+  isSupported,
+  unspentOutputsByteLength,
+  writeUnspentOutputs,
+  randomOutsByteLength,
+  writeRandomOuts
+}
@@ -0,0 +1,183 @@
+//
+//  WorkerPool.cpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+#include "WorkerPool.hpp"
+//
+using namespace std;
+using namespace Runtime;
+//
+// Lifecycle - Init
+WorkerPool::WorkerPool(size_t n_workers)
+	: n_queued(0), is_stopping(false)
+{
+#if !MYMONERO_CLIENT_HAS_THREADS
+	n_workers = 0;
+#endif
+	for (size_t i = 0; i < n_workers + 1; ++i) {
+		this->queues.emplace_back(new Queue());
+	}
+	this->workers.reserve(n_workers);
+	for (size_t i = 0; i < n_workers; ++i) {
+		this->workers.emplace_back(&WorkerPool::_worker_main, this, i);
+	}
+}
+WorkerPool::~WorkerPool()
+{
+	{
+		lock_guard<mutex> lock(this->sleep_m);
+		this->is_stopping = true;
+	}
+	this->wake.notify_all();
+	for (thread &worker : this->workers) {
+		worker.join();
+	}
+}
+WorkerPool &WorkerPool::shared()
+{
+	static WorkerPool pool([]() -> size_t {
+		size_t n_threads = MYMONERO_CLIENT_THREADS;
+		if (n_threads == 0) {
+			n_threads = thread::hardware_concurrency();
+		}
+		size_t n_workers = n_threads > 1 ? n_threads - 1 : 0; // the calling thread makes up the last one
+#ifdef MYMONERO_CLIENT_PTHREAD_POOL_SIZE
+		// only pre-spawned web workers can start while the main thread is blocked in parallel_for
+		n_workers = min(n_workers, (size_t)MYMONERO_CLIENT_PTHREAD_POOL_SIZE);
+#endif
+		return n_workers;
+	}());
+	return pool;
+}
+//
+// Imperatives
+void WorkerPool::parallel_for(size_t n, size_t grain, const RangeFn &fn)
+{
+	if (n == 0) {
+		return;
+	}
+	if (grain == 0) {
+		grain = 1;
+	}
+	if (this->workers.empty() || n <= grain) {
+		fn(0, n);
+		return;
+	}
+	Batch batch;
+	batch.fn = &fn;
+	size_t n_chunks = (n + grain - 1) / grain;
+	batch.n_remaining = n_chunks;
+	{ // deal the chunks round-robin so that every worker starts with local work
+		size_t queue_index = 0;
+		for (size_t begin = 0; begin < n; begin += grain) {
+			Queue &queue = *this->queues[queue_index];
+			{
+				lock_guard<mutex> lock(queue.m);
+				queue.tasks.push_back(Task{ &batch, begin, min(n, begin + grain) });
+			}
+			queue_index = (queue_index + 1) % this->queues.size();
+		}
+		lock_guard<mutex> lock(this->sleep_m);
+		this->n_queued += n_chunks;
+	}
+	this->wake.notify_all();
+	//
+	Task task;
+	size_t caller_queue_index = this->queues.size() - 1;
+	while (batch.n_remaining.load() != 0 && this->_try_pop(caller_queue_index, task)) {
+		this->_run(task); // may run other callers' chunks; that's fine, they're independent
+	}
+	{
+		unique_lock<mutex> lock(batch.m);
+		batch.finished.wait(lock, [&batch]() { return batch.n_remaining.load() == 0; });
+	}
+	if (batch.error) {
+		rethrow_exception(batch.error);
+	}
+}
+bool WorkerPool::_try_pop(size_t queue_index, Task &out__task)
+{
+	{ // own queue, LIFO
+		Queue &own = *this->queues[queue_index];
+		lock_guard<mutex> lock(own.m);
+		if (!own.tasks.empty()) {
+			out__task = own.tasks.back();
+			own.tasks.pop_back();
+			lock_guard<mutex> sleep_lock(this->sleep_m);
+			this->n_queued -= 1;
+			return true;
+		}
+	}
+	for (size_t offset = 1; offset < this->queues.size(); ++offset) { // steal, FIFO
+		Queue &victim = *this->queues[(queue_index + offset) % this->queues.size()];
+		lock_guard<mutex> lock(victim.m);
+		if (!victim.tasks.empty()) {
+			out__task = victim.tasks.front();
+			victim.tasks.pop_front();
+			lock_guard<mutex> sleep_lock(this->sleep_m);
+			this->n_queued -= 1;
+			return true;
+		}
+	}
+	return false;
+}
+void WorkerPool::_run(Task &task)
+{
+	Batch &batch = *task.batch;
+	try {
+		(*batch.fn)(task.begin, task.end);
+	} catch (...) {
+		lock_guard<mutex> lock(batch.m);
+		if (!batch.error) {
+			batch.error = current_exception();
+		}
+	}
+	// Decremented under the lock: parallel_for takes batch.m before it returns, so the stack Batch
+	// outlives this, the last touch of it by a worker
+	lock_guard<mutex> lock(batch.m);
+	if (--batch.n_remaining == 0) {
+		batch.finished.notify_all();
+	}
+}
+void WorkerPool::_worker_main(size_t queue_index)
+{
+	Task task;
+	while (true) {
+		if (this->_try_pop(queue_index, task)) {
+			this->_run(task);
+			continue;
+		}
+		unique_lock<mutex> lock(this->sleep_m);
+		this->wake.wait(lock, [this]() { return this->is_stopping || this->n_queued != 0; });
+		if (this->is_stopping) {
+			return;
+		}
+	}
+}
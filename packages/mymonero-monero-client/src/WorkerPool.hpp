@@ -0,0 +1,122 @@
+//
+//  WorkerPool.hpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#ifndef WorkerPool_hpp
+#define WorkerPool_hpp
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <condition_variable>
+
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+	#define MYMONERO_CLIENT_HAS_THREADS 0
+#else
+	#define MYMONERO_CLIENT_HAS_THREADS 1
+#endif
+#ifndef MYMONERO_CLIENT_THREADS
+	#define MYMONERO_CLIENT_THREADS 0 // 0: one worker per hardware thread
+#endif
+
+namespace Runtime
+{
+	using namespace std;
+	//
+	// A small work-stealing pool for data-parallel loops over independent items, e.g. key
+	// images for many outputs. parallel_for splits [0, n) into chunks which are dealt across
+	// per-worker deques; each worker pops from the back of its own deque and steals from the
+	// front of the others' once it runs dry. The calling thread steals too, so a pool with no
+	// workers (the single-threaded WASM build) simply runs the loop inline.
+	//
+	// Results must be written to per-index slots so that output is independent of scheduling.
+	//
+	class WorkerPool
+	{
+	public:
+		typedef function<void(size_t begin, size_t end)> RangeFn;
+		//
+		// Lifecycle - Init
+		explicit WorkerPool(size_t n_workers);
+		~WorkerPool();
+		WorkerPool(const WorkerPool &) = delete;
+		WorkerPool &operator=(const WorkerPool &) = delete;
+		//
+		static WorkerPool &shared(); // sized by MYMONERO_CLIENT_THREADS
+		//
+		// Accessors
+		size_t concurrency() const { return this->workers.size() + 1; } // including the caller
+		//
+		// Imperatives
+		// Blocks until fn has been called for every chunk of at most `grain` indices. Rethrows the
+		// first exception thrown by fn, after all chunks have finished.
+		void parallel_for(size_t n, size_t grain, const RangeFn &fn);
+	private:
+		struct Batch
+		{
+			const RangeFn *fn;
+			atomic<size_t> n_remaining;
+			mutex m;
+			condition_variable finished;
+			exception_ptr error;
+		};
+		struct Task
+		{
+			Batch *batch;
+			size_t begin;
+			size_t end;
+		};
+		struct Queue
+		{
+			mutex m;
+			deque<Task> tasks;
+		};
+		//
+		vector<thread> workers;
+		vector<unique_ptr<Queue>> queues; // one per worker, plus one for callers
+		mutex sleep_m;
+		condition_variable wake;
+		size_t n_queued; // guarded by sleep_m
+		bool is_stopping; // guarded by sleep_m
+		//
+		void _worker_main(size_t queue_index);
+		bool _try_pop(size_t queue_index, Task &out__task);
+		void _run(Task &task);
+	};
+}
+
+#endif /* WorkerPool_hpp */
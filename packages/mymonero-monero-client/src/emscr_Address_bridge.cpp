@@ -0,0 +1,84 @@
+//
+//  emscr_Address_bridge.cpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#include "emscr_Address_bridge.hpp"
+//
+#include "serial_bridge_utils.hpp"
+#include "AddressDecoding.hpp"
+//
+using namespace std;
+using namespace serial_bridge_utils;
+//
+// Accessory functions
+static void _append_record(string &dst, const string &address, cryptonote::network_type nettype)
+{
+	size_t offset = dst.size();
+	dst.append(emscr_Address_bridge::decoded_address__record_size, '\0');
+	cryptonote::address_parse_info info;
+	if (address.empty() || !Addresses::DecodeCache::shared().decode(address, nettype, info)) {
+		return; // decoded_address__invalid
+	}
+	char *record = &dst[offset];
+	record[0] = (char)(info.has_payment_id ? emscr_Address_bridge::decoded_address__integrated
+		: info.is_subaddress ? emscr_Address_bridge::decoded_address__subaddress
+		: emscr_Address_bridge::decoded_address__standard);
+	if (info.has_payment_id) {
+		memcpy(record + 8, info.payment_id.data, sizeof(crypto::hash8));
+	}
+	memcpy(record + 16, info.address.m_spend_public_key.data, sizeof(crypto::public_key));
+	memcpy(record + 48, info.address.m_view_public_key.data, sizeof(crypto::public_key));
+}
+//
+// From-JS function decls
+string emscr_Address_bridge::decode_addresses(const string &addresses, const string &nettype_string)
+{
+	cryptonote::network_type nettype = nettype_from_string(nettype_string);
+	if (nettype == cryptonote::UNDEFINED) {
+		return string();
+	}
+	string records;
+	size_t line_begin = 0;
+	while (line_begin < addresses.size()) {
+		size_t line_end = addresses.find('\n', line_begin);
+		if (line_end == string::npos) {
+			line_end = addresses.size();
+		}
+		size_t address_end = line_end;
+		if (address_end > line_begin && addresses[address_end - 1] == '\r') {
+			address_end -= 1;
+		}
+		_append_record(records, addresses.substr(line_begin, address_end - line_begin), nettype);
+		line_begin = line_end + 1;
+	}
+	//
+	return records;
+}
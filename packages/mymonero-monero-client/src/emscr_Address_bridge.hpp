@@ -0,0 +1,67 @@
+//
+//  emscr_Address_bridge.hpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#ifndef emscr_Address_bridge_hpp
+#define emscr_Address_bridge_hpp
+//
+#include <string>
+//
+namespace emscr_Address_bridge
+{
+	using namespace std;
+	//
+	// decode_addresses takes newline-separated (or -terminated) addresses and returns one packed
+	// record per line, in input order, rather than a JSON document - payout lists run to thousands
+	// of addresses.
+	// Record layout (decoded_address__record_size bytes):
+	//   [0]      status - decoded_address__invalid, __standard, __subaddress or __integrated
+	//   [1, 8)   zero
+	//   [8, 16)  payment id, zero unless integrated
+	//   [16, 48) public spend key
+	//   [48, 80) public view key
+	// The keys are zero for invalid addresses. An unknown nettype returns an empty string.
+	// Decodes go through Addresses::DecodeCache::shared(), as the send path's do.
+	//
+	static const size_t decoded_address__record_size = 80;
+	enum DecodedAddressStatus
+	{
+		decoded_address__invalid = 0,
+		decoded_address__standard = 1,
+		decoded_address__subaddress = 2,
+		decoded_address__integrated = 3
+	};
+	//
+	// Public interface:
+	string decode_addresses(const string &addresses, const string &nettype);
+}
+
+#endif /* emscr_Address_bridge_hpp */
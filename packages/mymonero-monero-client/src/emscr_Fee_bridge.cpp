@@ -0,0 +1,113 @@
+//
+//  emscr_Fee_bridge.cpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#include "emscr_Fee_bridge.hpp"
+//
+#include "serial_bridge_utils.hpp"
+#include "StreamingJSON.hpp"
+#include "FeeMatrix.hpp"
+//
+using namespace std;
+using namespace Fees;
+using namespace serial_bridge_utils;
+//
+// From-JS function decls
+bool emscr_Fee_bridge::estimate_fee_matrix(const string &args_json, string &out__ret)
+{
+	uint64_t fee_per_b = 0;
+	uint64_t fee_mask = fee_matrix__default_fee_mask;
+	uint64_t max_inputs = 0;
+	uint64_t max_outputs = 0;
+	FeeMatrixShape shape{};
+	try {
+		StreamingJSON::Reader reader(args_json);
+		string key;
+		reader.begin_object();
+		while (reader.next_key(key)) {
+			if (key == "fee_per_b") {
+				fee_per_b = reader.read_uint64();
+			} else if (key == "fee_mask") {
+				fee_mask = reader.read_uint64();
+			} else if (key == "fork_versions") {
+				reader.begin_array();
+				while (reader.next_element()) {
+					uint64_t fork_version = reader.read_uint64();
+					if (fork_version > 255) {
+						out__ret = error_ret_json_from_message("Invalid fork version");
+						return false;
+					}
+					shape.fork_versions.push_back((uint8_t)fork_version);
+				}
+			} else if (key == "max_inputs") {
+				max_inputs = reader.read_uint64();
+			} else if (key == "max_outputs") {
+				max_outputs = reader.read_uint64();
+			} else if (key == "extra_size") {
+				shape.extra_size = (size_t)reader.read_uint64();
+			} else {
+				reader.skip_value();
+			}
+		}
+		reader.expect_end();
+	} catch (const StreamingJSON::ParseError &e) {
+		out__ret = error_ret_json_from_message(e.what());
+		return false;
+	}
+	const char *err_msg = NULL;
+	if (fee_per_b == 0) {
+		err_msg = "Expected a non-zero fee_per_b";
+	} else if (fee_mask == 0) {
+		err_msg = "Expected a non-zero fee_mask";
+	} else if (shape.fork_versions.empty()) {
+		err_msg = "Expected at least one fork version";
+	} else if (max_inputs < 1 || max_inputs > fee_matrix__max_inputs) { // checked before narrowing to a 32-bit size_t
+		err_msg = "max_inputs out of range";
+	} else if (max_outputs < 1 || max_outputs > fee_matrix__max_outputs) {
+		err_msg = "max_outputs out of range";
+	}
+	if (err_msg != NULL) {
+		out__ret = error_ret_json_from_message(err_msg);
+		return false;
+	}
+	shape.max_inputs = (size_t)max_inputs;
+	shape.max_outputs = (size_t)max_outputs;
+	vector<uint64_t> fees;
+	fill_fee_matrix(fee_per_b, fee_mask, shape, fees);
+	out__ret.assign(fees.size() * sizeof(uint64_t), '\0');
+	for (size_t i = 0; i < fees.size(); ++i) {
+		for (size_t b = 0; b < sizeof(uint64_t); ++b) {
+			out__ret[i * sizeof(uint64_t) + b] = (char)((fees[i] >> (8 * b)) & 0xff);
+		}
+	}
+	//
+	return true;
+}
@@ -0,0 +1,55 @@
+//
+//  emscr_Fee_bridge.hpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#ifndef emscr_Fee_bridge_hpp
+#define emscr_Fee_bridge_hpp
+//
+#include <string>
+//
+namespace emscr_Fee_bridge
+{
+	using namespace std;
+	//
+	// estimate_fee_matrix takes
+	//   { fee_per_b, fee_mask, fork_versions: [...], max_inputs, max_outputs, extra_size }
+	// (fee_mask defaults to 10000 and extra_size to 0) and returns the fee of every
+	// (fork version, priority 1-4, n_inputs, n_outputs) as a packed little-endian uint64
+	// per entry, in the order and with the limits described in FeeMatrix.hpp, rather than a
+	// JSON document. Invalid arguments return false, with the usual err_msg document instead.
+	//
+	static const uint64_t fee_matrix__default_fee_mask = 10000;
+	//
+	// Public interface:
+	bool estimate_fee_matrix(const string &args_json, string &out__ret);
+}
+
+#endif /* emscr_Fee_bridge_hpp */
@@ -0,0 +1,277 @@
+//
+//  emscr_KeyImage_bridge.cpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+#include "emscr_KeyImage_bridge.hpp"
+//
+#include <sstream>
+#include <mutex>
+#include <memory>
+#include <unordered_map>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+//
+#include "string_tools.h"
+//
+#include "serial_bridge_utils.hpp"
+#include "KeyImages.hpp"
+#include "KeyImageCache.hpp"
+#include "WalletContext.hpp"
+//
+using namespace std;
+using namespace boost;
+using namespace serial_bridge_utils;
+using namespace KeyImages;
+//
+// Runtime - Memory
+static mutex key_image_caches__mutex;
+static unordered_map<string, unique_ptr<Cache>> key_image_caches__by_address;
+//
+static Cache &_key_image_cache_for(const string &address)
+{ // key_image_caches__mutex must be held
+	auto &cache = key_image_caches__by_address[address];
+	if (!cache) {
+		cache.reset(new Cache());
+	}
+	return *cache;
+}
+//
+// From-JS function decls
+string emscr_KeyImage_bridge::generate_key_images(const string &args_string)
+{
+	property_tree::ptree json_root;
+	std::istringstream ss(args_string);
+	property_tree::read_json(ss, json_root);
+	//
+	crypto::secret_key sec_viewKey{};
+	crypto::public_key pub_spendKey{};
+	crypto::secret_key sec_spendKey{};
+	optional<string> wallet_context_string = json_root.get_optional<string>("wallet_context");
+	if (wallet_context_string != none) { // keys were parsed by open_wallet_context
+		Wallet::ContextRegistry::Checkout context(Wallet::contexts(), Wallet::ContextRegistry::handle_from(*wallet_context_string));
+		if (!context) {
+			return error_ret_json_from_message(Wallet::checkout_error(context));
+		}
+		sec_viewKey = context->keys().sec_viewKey;
+		pub_spendKey = context->keys().pub_spendKey;
+		sec_spendKey = context->keys().sec_spendKey;
+	} else {
+		if (!epee::string_tools::hex_to_pod(json_root.get<string>("sec_viewKey_string"), sec_viewKey)) {
+			return error_ret_json_from_message("Invalid privateViewKey");
+		}
+		if (!epee::string_tools::hex_to_pod(json_root.get<string>("pub_spendKey_string"), pub_spendKey)) {
+			return error_ret_json_from_message("Invalid publicSpendKey");
+		}
+		if (!epee::string_tools::hex_to_pod(json_root.get<string>("sec_spendKey_string"), sec_spendKey)) {
+			return error_ret_json_from_message("Invalid privateSpendKey");
+		}
+	}
+	//
+	const auto &outputs_desc = json_root.get_child("outputs");
+	vector<OutputRef> outputs;
+	outputs.reserve(outputs_desc.size());
+	for (const auto &output_desc : outputs_desc) {
+		OutputRef output;
+		if (!epee::string_tools::hex_to_pod(output_desc.second.get<string>("tx_pub_key"), output.tx_pub_key)) {
+			return error_ret_json_from_message("Invalid tx_pub_key at index " + std::to_string(outputs.size()));
+		}
+		try {
+			output.out_index = stoull(output_desc.second.get<string>("out_index"));
+		} catch (...) {
+			return error_ret_json_from_message("Invalid out_index at index " + std::to_string(outputs.size()));
+		}
+		outputs.push_back(output);
+	}
+	//
+	Deriver deriver(sec_viewKey, sec_spendKey);
+	vector<crypto::key_image> key_images;
+	optional<size_t> failed_index = deriver.key_images(outputs, key_images);
+	if (failed_index != none) {
+		return error_ret_json_from_message("Unable to generate key image at index " + std::to_string(*failed_index));
+	}
+	string packed_key_images;
+	packed_key_images.reserve(key_images.size() * sizeof(crypto::key_image) * 2);
+	for (const auto &key_image : key_images) {
+		packed_key_images += epee::string_tools::pod_to_hex(key_image);
+	}
+	property_tree::ptree root;
+	root.put(ret_json_key__generic_retVal(), std::move(packed_key_images));
+	//
+	return ret_json_from_root(root);
+}
+//
+string emscr_KeyImage_bridge::cached_key_image(
+	const string &address,
+	const string &tx_pub_key_string,
+	const string &sec_viewKey_string,
+	const string &pub_spendKey_string,
+	const string &sec_spendKey_string,
+	const string &output_index_string
+) {
+	if (address.empty()) {
+		return error_ret_json_from_message("Invalid address");
+	}
+	crypto::public_key tx_pub_key{};
+	crypto::secret_key sec_viewKey{};
+	crypto::public_key pub_spendKey{};
+	crypto::secret_key sec_spendKey{};
+	uint64_t output_index;
+	if (!epee::string_tools::hex_to_pod(tx_pub_key_string, tx_pub_key)) {
+		return error_ret_json_from_message("Invalid tx pub key");
+	}
+	if (!epee::string_tools::hex_to_pod(sec_viewKey_string, sec_viewKey)) {
+		return error_ret_json_from_message("Invalid view key");
+	}
+	if (!epee::string_tools::hex_to_pod(pub_spendKey_string, pub_spendKey)) {
+		return error_ret_json_from_message("Invalid pub spend key");
+	}
+	if (!epee::string_tools::hex_to_pod(sec_spendKey_string, sec_spendKey)) {
+		return error_ret_json_from_message("Invalid sec spend key");
+	}
+	try {
+		output_index = stoull(output_index_string);
+	} catch (...) {
+		return error_ret_json_from_message("Invalid output index");
+	}
+	crypto::key_image key_image;
+	bool is_cached;
+	{
+		lock_guard<mutex> lock(key_image_caches__mutex);
+		is_cached = _key_image_cache_for(address).get(pub_spendKey, tx_pub_key, output_index, key_image);
+	}
+	if (!is_cached) {
+		Deriver deriver(sec_viewKey, sec_spendKey);
+		if (!deriver.key_image(tx_pub_key, output_index, key_image)) {
+			return error_ret_json_from_message("Unable to generate key image");
+		}
+		lock_guard<mutex> lock(key_image_caches__mutex);
+		_key_image_cache_for(address).put(pub_spendKey, tx_pub_key, output_index, key_image);
+	}
+	property_tree::ptree root;
+	root.put(ret_json_key__generic_retVal(), epee::string_tools::pod_to_hex(key_image));
+	//
+	return ret_json_from_root(root);
+}
+string emscr_KeyImage_bridge::context_key_image(
+	const string &wallet_context_string,
+	const string &tx_pub_key_string,
+	const string &output_index_string
+) {
+	crypto::public_key tx_pub_key{};
+	uint64_t output_index;
+	if (!epee::string_tools::hex_to_pod(tx_pub_key_string, tx_pub_key)) {
+		return error_ret_json_from_message("Invalid tx pub key");
+	}
+	try {
+		output_index = stoull(output_index_string);
+	} catch (...) {
+		return error_ret_json_from_message("Invalid output index");
+	}
+	Wallet::ContextRegistry::Checkout context(Wallet::contexts(), Wallet::ContextRegistry::handle_from(wallet_context_string));
+	if (!context) {
+		return error_ret_json_from_message(Wallet::checkout_error(context));
+	}
+	const crypto::public_key &pub_spendKey = context->keys().pub_spendKey;
+	crypto::key_image key_image;
+	bool is_cached;
+	{
+		lock_guard<mutex> lock(key_image_caches__mutex);
+		is_cached = _key_image_cache_for(context->address()).get(pub_spendKey, tx_pub_key, output_index, key_image);
+	}
+	if (!is_cached) {
+		if (!context->deriver().key_image(tx_pub_key, output_index, key_image)) {
+			return error_ret_json_from_message("Unable to generate key image");
+		}
+		lock_guard<mutex> lock(key_image_caches__mutex);
+		_key_image_cache_for(context->address()).put(pub_spendKey, tx_pub_key, output_index, key_image);
+	}
+	property_tree::ptree root;
+	root.put(ret_json_key__generic_retVal(), epee::string_tools::pod_to_hex(key_image));
+	//
+	return ret_json_from_root(root);
+}
+string emscr_KeyImage_bridge::key_image_cache_snapshot(const string &address)
+{
+	lock_guard<mutex> lock(key_image_caches__mutex);
+	auto found = key_image_caches__by_address.find(address);
+	if (found == key_image_caches__by_address.end()) {
+		return Cache(0).snapshot(); // valid, empty
+	}
+	return found->second->snapshot();
+}
+bool emscr_KeyImage_bridge::key_image_cache_load(const string &address, const string &snapshot)
+{
+	if (address.empty()) {
+		return false;
+	}
+	lock_guard<mutex> lock(key_image_caches__mutex);
+	return _key_image_cache_for(address).load_snapshot(snapshot);
+}
+bool emscr_KeyImage_bridge::key_image_cache_delete(const string &address)
+{
+	lock_guard<mutex> lock(key_image_caches__mutex);
+	return key_image_caches__by_address.erase(address) != 0;
+}
+optional<size_t> emscr_KeyImage_bridge::cached_key_images(
+	const string &address,
+	const crypto::public_key &pub_spendKey,
+	Deriver &deriver,
+	const vector<OutputRef> &outputs,
+	vector<crypto::key_image> &out__key_images
+) {
+	out__key_images.resize(outputs.size());
+	vector<size_t> missed_indices;
+	vector<OutputRef> missed;
+	{
+		lock_guard<mutex> lock(key_image_caches__mutex);
+		const Cache &cache = _key_image_cache_for(address);
+		for (size_t i = 0; i < outputs.size(); ++i) {
+			if (!cache.get(pub_spendKey, outputs[i].tx_pub_key, outputs[i].out_index, out__key_images[i])) {
+				missed_indices.push_back(i);
+				missed.push_back(outputs[i]);
+			}
+		}
+	}
+	if (missed.empty()) {
+		return none;
+	}
+	vector<crypto::key_image> derived;
+	optional<size_t> failed_index = deriver.key_images(missed, derived);
+	if (failed_index != none) {
+		return missed_indices[*failed_index];
+	}
+	lock_guard<mutex> lock(key_image_caches__mutex);
+	Cache &cache = _key_image_cache_for(address);
+	for (size_t i = 0; i < missed.size(); ++i) {
+		out__key_images[missed_indices[i]] = derived[i];
+		cache.put(pub_spendKey, missed[i].tx_pub_key, missed[i].out_index, derived[i]);
+	}
+	return none;
+}
@@ -0,0 +1,92 @@
+//
+//  emscr_KeyImage_bridge.hpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#ifndef emscr_KeyImage_bridge_hpp
+#define emscr_KeyImage_bridge_hpp
+//
+#include <string>
+#include <vector>
+#include <boost/optional/optional.hpp>
+#include "KeyImages.hpp"
+//
+namespace emscr_KeyImage_bridge
+{
+	using namespace std;
+	//
+	// Bridging Functions - these take and return JSON strings, like those of serial_bridge.
+	//
+	// generate_key_images args:
+	// {
+	//   sec_viewKey_string, pub_spendKey_string, sec_spendKey_string,
+	//   outputs: [ { tx_pub_key, out_index }, ... ]
+	// }
+	// or { wallet_context, outputs } with a handle from open_wallet_context in place of the keys.
+	// On success, retVal holds the 64-char hex key images of every output concatenated in input order.
+	//
+	// The key_image_cache_ functions manage one KeyImages::Cache per wallet address. cached_key_image
+	// takes the same arguments as serial_bridge::generate_key_image plus the address, and only derives
+	// the key image on a cache miss. context_key_image does the same for an open wallet context.
+	// Snapshots are the binary format of KeyImages::Cache::snapshot.
+	//
+	// Public interface:
+	string generate_key_images(const string &args_string);
+	//
+	string cached_key_image(
+		const string &address,
+		const string &tx_pub_key,
+		const string &sec_viewKey,
+		const string &pub_spendKey,
+		const string &sec_spendKey,
+		const string &output_index
+	);
+	string context_key_image(
+		const string &wallet_context,
+		const string &tx_pub_key,
+		const string &output_index
+	);
+	string key_image_cache_snapshot(const string &address);
+	bool key_image_cache_load(const string &address, const string &snapshot);
+	bool key_image_cache_delete(const string &address);
+	//
+	// For the other bridges - the key images of many outputs of the wallet at address, from its
+	// cache where present; the rest are derived as one batch and cached under pub_spendKey, which
+	// must be that of the deriver's keys. Returns the index of the first output which failed, if any.
+	boost::optional<size_t> cached_key_images(
+		const string &address,
+		const crypto::public_key &pub_spendKey,
+		KeyImages::Deriver &deriver,
+		const vector<KeyImages::OutputRef> &outputs,
+		vector<crypto::key_image> &out__key_images
+	);
+}
+
+#endif /* emscr_KeyImage_bridge_hpp */
@@ -0,0 +1,175 @@
+//
+//  emscr_OutputScanner_bridge.cpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+//
+#include "emscr_OutputScanner_bridge.hpp"
+//
+#include <cstring>
+#include "string_tools.h"
+//
+#include "serial_bridge_utils.hpp"
+#include "StreamingJSON.hpp"
+#include "OutputScanner.hpp"
+#include "WalletContext.hpp"
+//
+using namespace std;
+using namespace boost;
+using namespace serial_bridge_utils;
+using namespace OutputScanning;
+//
+// Accessory functions - Parsing
+static void _read_output(StreamingJSON::Reader &reader, string &key, TransactionOutput &out)
+{
+	bool has_public_key = false;
+	out.amount = 0;
+	reader.begin_object();
+	while (reader.next_key(key)) {
+		if (key == "public_key") {
+			has_public_key = true;
+			reader.read_hex_pod(out.public_key);
+		} else if (key == "view_tag") {
+			if (!reader.read_null()) {
+				out.view_tag = crypto::view_tag();
+				reader.read_hex_pod(*out.view_tag);
+			}
+		} else if (key == "commitment") {
+			if (!reader.read_null()) {
+				out.commitment = rct::key();
+				reader.read_hex_pod(*out.commitment);
+			}
+		} else if (key == "encrypted_amount") {
+			if (!reader.read_null()) {
+				crypto::hash8 encrypted_amount;
+				reader.read_hex_pod(encrypted_amount);
+				out.encrypted_amount = rct::key();
+				memset(out.encrypted_amount->bytes, 0, sizeof(out.encrypted_amount->bytes));
+				memcpy(out.encrypted_amount->bytes, &encrypted_amount, sizeof(encrypted_amount));
+			}
+		} else if (key == "amount") {
+			out.amount = reader.read_uint64();
+		} else {
+			reader.skip_value();
+		}
+	}
+	if (!has_public_key) {
+		reader.fail("Expected public_key in each output");
+	}
+}
+static void _read_transactions(StreamingJSON::Reader &reader, string &key, vector<Transaction> &out)
+{
+	reader.begin_array();
+	while (reader.next_element()) {
+		out.emplace_back();
+		Transaction &transaction = out.back();
+		bool has_tx_pub_key = false;
+		reader.begin_object();
+		while (reader.next_key(key)) {
+			if (key == "tx_pub_key") {
+				has_tx_pub_key = true;
+				reader.read_hex_pod(transaction.tx_pub_key);
+			} else if (key == "additional_pub_keys") {
+				reader.begin_array();
+				while (reader.next_element()) {
+					transaction.additional_pub_keys.emplace_back();
+					reader.read_hex_pod(transaction.additional_pub_keys.back());
+				}
+			} else if (key == "outputs") {
+				reader.begin_array();
+				while (reader.next_element()) {
+					transaction.outputs.emplace_back();
+					_read_output(reader, key, transaction.outputs.back());
+				}
+			} else {
+				reader.skip_value();
+			}
+		}
+		if (!has_tx_pub_key) {
+			reader.fail("Expected tx_pub_key in each transaction");
+		}
+	}
+}
+//
+// From-JS function decls
+string emscr_OutputScanner_bridge::scan_outputs(const string &args_string)
+{
+	string wallet_context_string;
+	bool with_key_images = false;
+	vector<Transaction> transactions;
+	try {
+		StreamingJSON::Reader reader(args_string);
+		string key;
+		reader.begin_object();
+		while (reader.next_key(key)) {
+			if (key == "wallet_context") {
+				reader.read_scalar_text(wallet_context_string);
+			} else if (key == "key_images") {
+				with_key_images = reader.read_bool();
+			} else if (key == "transactions") {
+				_read_transactions(reader, key, transactions);
+			} else {
+				reader.skip_value();
+			}
+		}
+		reader.expect_end();
+	} catch (const StreamingJSON::ParseError &e) {
+		return error_ret_json_from_message(e.what());
+	}
+	Wallet::ContextRegistry::Checkout context(Wallet::contexts(), Wallet::ContextRegistry::handle_from(wallet_context_string));
+	if (!context) {
+		return error_ret_json_from_message(Wallet::checkout_error(context));
+	}
+	Scanner scanner(*context.get());
+	vector<OwnedOutput> owned;
+	scanner.scan(transactions, owned);
+	//
+	StreamingJSON::Writer writer(64 + owned.size() * 256);
+	writer.begin_object();
+	writer.key("outputs").begin_array();
+	for (const OwnedOutput &output : owned) {
+		writer.begin_object();
+		writer.key("tx_index").uint_string_value(output.tx_index);
+		writer.key("index").uint_string_value(output.output_index);
+		writer.key("public_key").string_value(epee::string_tools::pod_to_hex(output.public_key));
+		writer.key("amount").uint_string_value(output.amount);
+		if (with_key_images) {
+			crypto::key_image key_image;
+			if (!scanner.key_image(output, key_image)) {
+				return error_ret_json_from_message("Unable to generate key image");
+			}
+			writer.key("key_image").string_value(epee::string_tools::pod_to_hex(key_image));
+		}
+		writer.end_object();
+	}
+	writer.end_array();
+	writer.end_object();
+
+	return writer.take();
+}
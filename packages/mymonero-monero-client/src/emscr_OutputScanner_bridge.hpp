@@ -0,0 +1,63 @@
+//
+//  emscr_OutputScanner_bridge.hpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#ifndef emscr_OutputScanner_bridge_hpp
+#define emscr_OutputScanner_bridge_hpp
+//
+#include <string>
+//
+namespace emscr_OutputScanner_bridge
+{
+	using namespace std;
+	//
+	// Bridging Functions - these take and return JSON strings, like those of serial_bridge.
+	//
+	// scan_outputs args:
+	// {
+	//   wallet_context, // from open_wallet_context
+	//   key_images, // optional "true" to derive the key image of each owned output
+	//   transactions: [ {
+	//     tx_pub_key, additional_pub_keys: [ ... ], // optional, one per output
+	//     outputs: [ { public_key, view_tag, commitment, encrypted_amount, amount }, ... ]
+	//   }, ... ]
+	// }
+	// view_tag (2 hex), commitment (64 hex) and encrypted_amount (the 16 hex of a RingCT v2
+	// ecdhInfo amount) are optional; amount is the cleartext amount of outputs without one.
+	//
+	// Returns { outputs: [ { tx_index, index, public_key, amount, key_image }, ... ] } for the
+	// owned outputs only, in input order; key_image only when asked for.
+	//
+	// Public interface:
+	string scan_outputs(const string &args_string);
+}
+
+#endif /* emscr_OutputScanner_bridge_hpp */
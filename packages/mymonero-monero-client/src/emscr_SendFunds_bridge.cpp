@@ -32,18 +32,29 @@
 //
 #include "emscr_SendFunds_bridge.hpp"
 //
-#include <boost/property_tree/ptree.hpp>
-#include <boost/property_tree/json_parser.hpp>
-#include <boost/foreach.hpp>
-#include <emscripten.h>
 #include <unordered_map>
 #include <memory>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 //
 #include "string_tools.h"
 #include "wallet_errors.h"
 //
 #include "serial_bridge_utils.hpp"
 #include "SendFundsFormSubmissionController.hpp"
+#include "SendFundsBatchController.hpp"
+#include "TransactionVerification.hpp"
+#include "SlotRegistry.hpp"
+#include "StreamingJSON.hpp"
+#include "SendFundsWireFormat.hpp"
+#include "SendFundsMetrics.hpp"
+#include "WalletContext.hpp"
+#include "KeyImages.hpp"
+#include "UnspentOutsIngest.hpp"
+#include "WorkerPool.hpp"
+#include "ringct/rctOps.h"
+#include "ringct/bulletproofs_plus.h"
 //
 //
 using namespace std;
@@ -57,57 +68,894 @@ using namespace emscr_SendFunds_bridge;
 //
 // Runtime - Memory
 //
-SendFunds::FormSubmissionController *controller_ptr = NULL;
+// One controller per in-flight send, addressed by the session_id returned from prepare_send.
+// Sessions are released once send_funds has signed or failed, or explicitly via release_send
+// when the caller abandons a send; anything left behind is evicted after the TTL.
+typedef Runtime::SlotRegistry<FormSubmissionController> SendSessionRegistry;
+static const size_t send_sessions__capacity = 256;
+static const std::chrono::minutes send_sessions__ttl(10);
+//
+static SendSessionRegistry &_send_sessions()
+{
+	static SendSessionRegistry registry(send_sessions__capacity, send_sessions__ttl);
+	return registry;
+}
+//
+// Batch sends have their own, smaller table; their handles mean nothing to the one above.
+typedef Runtime::SlotRegistry<BatchSubmissionController> BatchSendSessionRegistry;
+static const size_t batch_send_sessions__capacity = 16;
+//
+static BatchSendSessionRegistry &_batch_send_sessions()
+{
+	static BatchSendSessionRegistry registry(batch_send_sessions__capacity, send_sessions__ttl);
+	return registry;
+}
+//
+// Unspent outputs being appended chunk by chunk, until a prepare_send consumes them
+typedef Runtime::SlotRegistry<UnspentOutsIngest> UnspentOutsIngestRegistry;
+static const size_t unspent_outs_ingests__capacity = 16;
+//
+static UnspentOutsIngestRegistry &_unspent_outs_ingests()
+{
+	static UnspentOutsIngestRegistry registry(unspent_outs_ingests__capacity, send_sessions__ttl);
+	return registry;
+}
+//
+// Accessory functions - Parsing
+//
+// The request documents are decoded in one pass, straight into the controller's typed
+// parameters; `key` is a scratch buffer reused across members to spare allocations.
+static void _read_destinations(StreamingJSON::Reader &reader, string &key, Parameters &parameters)
+{
+	reader.begin_array();
+	while (reader.next_element()) {
+		optional<string> to_address;
+		optional<string> send_amount;
+		reader.begin_object();
+		while (reader.next_key(key)) {
+			if (key == "to_address") {
+				to_address = string();
+				reader.read_string(*to_address);
+			} else if (key == "send_amount") {
+				send_amount = string();
+				reader.read_scalar_text(*send_amount);
+			} else {
+				reader.skip_value();
+			}
+		}
+		if (!to_address || !send_amount) {
+			reader.fail("Expected to_address and send_amount in each destination");
+		}
+		parameters.enteredAddressValues.push_back(std::move(*to_address));
+		parameters.send_amount_strings.push_back(std::move(*send_amount));
+	}
+}
+// Returns false when a field every output needs is missing; such an output is skipped, as the
+// property tree parsing did
+static bool _read_unspent_output(StreamingJSON::Reader &reader, string &key, string &scratch, UnspentOutput &out)
+{
+	enum { has_amount = 1, has_public_key = 2, has_global_index = 4, has_index = 8, has_tx_pub_key = 16, has_all = 31 };
+	int seen = 0;
+	reader.begin_object();
+	while (reader.next_key(key)) {
+		if (key == "amount") {
+			out.spendable.amount = reader.read_uint64();
+			seen |= has_amount;
+		} else if (key == "public_key") {
+			reader.read_string(out.spendable.public_key);
+			seen |= has_public_key;
+		} else if (key == "rct") {
+			if (!reader.read_null()) {
+				reader.read_string(scratch);
+				if (!scratch.empty()) {
+					out.spendable.rct = scratch;
+				}
+			}
+		} else if (key == "global_index") {
+			out.spendable.global_index = reader.read_uint64();
+			seen |= has_global_index;
+		} else if (key == "index") {
+			out.spendable.index = reader.read_uint64();
+			seen |= has_index;
+		} else if (key == "tx_pub_key") {
+			reader.read_string(out.spendable.tx_pub_key);
+			seen |= has_tx_pub_key;
+		} else if (key == "spend_key_images") {
+			reader.begin_array();
+			while (reader.next_element()) {
+				reader.read_string(scratch);
+				crypto::key_image key_image;
+				if (epee::string_tools::hex_to_pod(scratch, key_image)) { // anything else can't be one of ours
+					out.spend_key_images.push_back(key_image);
+				}
+			}
+		} else {
+			reader.skip_value();
+		}
+	}
+	return seen == has_all;
+}
+static void _read_unspent_outs(StreamingJSON::Reader &reader, string &key, UnspentOuts &out, bool &out__has_outputs)
+{
+	string scratch;
+	reader.begin_object();
+	while (reader.next_key(key)) {
+		if (key == "outputs") {
+			out__has_outputs = true;
+			reader.begin_array();
+			while (reader.next_element()) {
+				if (reader.read_null()) {
+					continue;
+				}
+				out.outputs.emplace_back();
+				if (!_read_unspent_output(reader, key, scratch, out.outputs.back())) {
+					out.outputs.pop_back();
+				}
+			}
+		} else {
+			StreamingJSON::ValueType type = reader.peek();
+			if (type == StreamingJSON::array_type || type == StreamingJSON::object_type || type == StreamingJSON::null_type) {
+				reader.skip_value();
+				continue;
+			}
+			reader.read_scalar_text(scratch);
+			out.fields.put(key, scratch);
+		}
+	}
+	out.fields.put_child("outputs", property_tree::ptree()); // for new__parsed_res__get_unspent_outs
+}
+static void _read_prepare_send_args(
+	const string &args_string,
+	Parameters &parameters,
+	bool outputs_in_wire_format,
+	optional<string> &out__wallet_context_string, // in place of the address and key strings
+	optional<string> &out__output_index_strategy, // with a wallet context, in place of unspentOuts.outputs
+	optional<string> &out__unspent_outs_id // an UnspentOutsIngest, in place of or besides unspentOuts
+) {
+	StreamingJSON::Reader reader(args_string);
+	string key;
+	optional<bool> is_sweeping;
+	optional<uint64_t> priority;
+	optional<string> nettype_string;
+	bool has_destinations = false, has_unspentOuts = false, has_outputs = false;
+	reader.begin_object();
+	while (reader.next_key(key)) {
+		if (key == "destinations") {
+			has_destinations = true;
+			_read_destinations(reader, key, parameters);
+		} else if (key == "unspentOuts") {
+			has_unspentOuts = true;
+			_read_unspent_outs(reader, key, parameters.unspentOuts, has_outputs);
+		} else if (key == "is_sweeping") {
+			is_sweeping = reader.read_bool();
+		} else if (key == "priority") {
+			priority = reader.read_uint64();
+		} else if (key == "nettype_string") {
+			nettype_string = string();
+			reader.read_string(*nettype_string);
+		} else if (key == "from_address_string") {
+			reader.read_string(parameters.from_address_string);
+		} else if (key == "sec_viewKey_string") {
+			reader.read_string(parameters.sec_viewKey_string);
+		} else if (key == "sec_spendKey_string") {
+			reader.read_string(parameters.sec_spendKey_string);
+		} else if (key == "pub_spendKey_string") {
+			reader.read_string(parameters.pub_spendKey_string);
+		} else if (key == "wallet_context") {
+			out__wallet_context_string = string();
+			reader.read_scalar_text(*out__wallet_context_string);
+		} else if (key == "output_index") {
+			out__output_index_strategy = string();
+			reader.read_string(*out__output_index_strategy);
+		} else if (key == "unspent_outs_id") {
+			out__unspent_outs_id = string();
+			reader.read_scalar_text(*out__unspent_outs_id);
+		} else if (key == "metrics") {
+			parameters.collect_metrics = reader.read_bool();
+		} else if (key == "verify_before_return") {
+			parameters.verify_before_return = reader.read_bool();
+		} else if (key == "manuallyEnteredPaymentID") {
+			if (!reader.read_null()) {
+				parameters.manuallyEnteredPaymentID = string();
+				reader.read_string(*parameters.manuallyEnteredPaymentID);
+			}
+		} else {
+			reader.skip_value();
+		}
+	}
+	reader.expect_end();
+	if (out__unspent_outs_id != boost::none) {
+		has_unspentOuts = has_outputs = true; // the ingest brings the fields and outputs it was given
+	}
+	if (!has_destinations || !has_unspentOuts || !is_sweeping || !priority || !nettype_string) {
+		reader.fail("Expected destinations, unspentOuts, is_sweeping, priority and nettype_string");
+	}
+	if (!has_outputs && !outputs_in_wire_format) {
+		reader.fail("Expected unspentOuts.outputs");
+	}
+	parameters.is_sweeping = *is_sweeping;
+	parameters.priority = (uint32_t)*priority;
+	parameters.nettype = nettype_from_string(*nettype_string);
+}
+static void _read_random_outs(StreamingJSON::Reader &reader, string &key, vector<RandomAmountOutputs> &out)
+{
+	reader.begin_array();
+	while (reader.next_element()) {
+		RandomAmountOutputs amountAndOuts{};
+		reader.begin_object();
+		while (reader.next_key(key)) {
+			if (key == "amount") {
+				amountAndOuts.amount = reader.read_uint64();
+			} else if (key == "outputs") {
+				reader.begin_array();
+				while (reader.next_element()) {
+					RandomAmountOutput amountOutput{};
+					reader.begin_object();
+					while (reader.next_key(key)) {
+						if (key == "global_index") {
+							amountOutput.global_index = reader.read_uint64();
+						} else if (key == "public_key") {
+							reader.read_string(amountOutput.public_key);
+						} else if (key == "rct") {
+							if (!reader.read_null()) {
+								amountOutput.rct = string();
+								reader.read_string(*amountOutput.rct);
+							}
+						} else {
+							reader.skip_value();
+						}
+					}
+					amountAndOuts.outputs.push_back(std::move(amountOutput));
+				}
+			} else {
+				reader.skip_value();
+			}
+		}
+		out.push_back(std::move(amountAndOuts));
+	}
+}
+static void _read_send_funds_args(const string &args_string, string &out__session_id_string, vector<RandomAmountOutputs> &out__mix_outs)
+{
+	StreamingJSON::Reader reader(args_string);
+	string key;
+	reader.begin_object();
+	while (reader.next_key(key)) {
+		if (key == "session_id") {
+			reader.read_scalar_text(out__session_id_string);
+		} else if (key == "amount_outs") {
+			_read_random_outs(reader, key, out__mix_outs);
+		} else {
+			reader.skip_value();
+		}
+	}
+	reader.expect_end();
+}
+//
+// Accessory functions - Wallet contexts
+static optional<string> _apply_wallet_context(
+	const optional<string> &wallet_context_string,
+	const optional<string> &output_index_strategy_string,
+	Parameters &parameters,
+	bool select_all_outputs
+) { // returns the error, if any
+	if (wallet_context_string == boost::none) {
+		if (output_index_strategy_string != boost::none) {
+			return string("An output index needs a wallet context");
+		}
+		return boost::none;
+	}
+	Runtime::SlotHandle handle = Wallet::ContextRegistry::handle_from(*wallet_context_string);
+	{
+		Wallet::ContextRegistry::Checkout context(Wallet::contexts(), handle);
+		if (!context) {
+			return string(Wallet::checkout_error(context));
+		}
+		const Wallet::AccountKeys &keys = context->keys();
+		parameters.account_keys = keys; // so cb_I needn't parse the strings below, which step2 still takes
+		parameters.from_address_string = context->address();
+		parameters.sec_viewKey_string = epee::string_tools::pod_to_hex(keys.sec_viewKey);
+		parameters.sec_spendKey_string = epee::string_tools::pod_to_hex(keys.sec_spendKey);
+		parameters.pub_spendKey_string = epee::string_tools::pod_to_hex(keys.pub_spendKey);
+	}
+	if (output_index_strategy_string != boost::none) {
+		Outputs::SelectionStrategy strategy;
+		if (*output_index_strategy_string == "minimize_inputs") {
+			strategy = Outputs::minimizeInputs;
+		} else if (*output_index_strategy_string == "consolidate_dust") {
+			strategy = Outputs::consolidateDust;
+		} else {
+			return string("Unknown output_index strategy");
+		}
+		const bool select_all = select_all_outputs || parameters.is_sweeping;
+		parameters.select_unspent_outs = [handle, strategy, select_all](
+			uint64_t amount,
+			const Outputs::FeeReserveFn &reserve,
+			vector<SpendableOutput> &out__outputs
+		) -> optional<string> {
+			Wallet::ContextRegistry::Checkout context(Wallet::contexts(), handle);
+			if (!context) {
+				return string(Wallet::checkout_error(context));
+			}
+			if (select_all) {
+				context->outputs().all(out__outputs);
+			} else {
+				context->outputs().select(strategy, amount, reserve, out__outputs);
+			}
+			return boost::none;
+		};
+	}
+	//
+	return boost::none;
+}
+//
+// Accessory functions - Unspent outputs
+static optional<string> _take_unspent_outs_ingest(const optional<string> &unspent_outs_id_string, Parameters &parameters)
+{ // returns the error, if any; the ingest is released either way
+	if (unspent_outs_id_string == boost::none) {
+		return boost::none;
+	}
+	Runtime::SlotHandle unspent_outs_id = UnspentOutsIngestRegistry::handle_from(*unspent_outs_id_string);
+	optional<string> err_msg = boost::none;
+	{
+		UnspentOutsIngestRegistry::Checkout ingest(_unspent_outs_ingests(), unspent_outs_id);
+		if (!ingest) {
+			return string("Unknown or expired unspent outputs");
+		}
+		if (!ingest->isFinished()) {
+			err_msg = string("Unspent outputs aren't finished");
+		} else {
+			ingest->take(parameters.unspentOuts);
+		}
+	}
+	_unspent_outs_ingests().release(unspent_outs_id);
+	//
+	return err_msg;
+}
+//
+// Accessory functions - Sessions
+//
+// parse_stopwatch was started before the request was decoded
+static string _send_funds(
+	const string &session_id_string,
+	const vector<RandomAmountOutputs> &mix_outs,
+	const SendFundsMetrics::Stopwatch &parse_stopwatch
+) {
+	if (session_id_string.empty()) {
+		return error_ret_json_from_message("Missing session_id");
+	}
+	Runtime::SlotHandle session_id = SendSessionRegistry::handle_from(session_id_string);
+	string ret_json;
+	bool is_finished = true;
+	try {
+		SendSessionRegistry::Checkout controller(_send_sessions(), session_id);
+		if (!controller) {
+			return error_ret_json_from_message("Unknown or expired send session");
+		}
+		controller->metrics.record(parse_stopwatch, SendFundsMetrics::parseArgs);
+		ret_json = controller->handle(mix_outs);
+		is_finished = !controller->isAwaitingRandomOuts(); // else ret_json asks for decoys for newly selected inputs
+	} catch (const std::exception &e) { // the session can't be resumed, and the caller may not release it
+		_send_sessions().release(session_id);
+		return error_ret_json_from_message(e.what());
+	}
+	if (is_finished) {
+		_send_sessions().release(session_id);
+	}
+
+	return ret_json;
+}
+static string _prepare_send(Parameters &&parameters, const SendFundsMetrics::Stopwatch &parse_stopwatch)
+{
+	Runtime::SlotHandle session_id = _send_sessions().emplace(std::move(parameters));
+	if (session_id == Runtime::invalid_slot_handle) {
+		return error_ret_json_from_message("Too many send sessions in progress");
+	}
+	string ret_json;
+	bool did_error = false;
+	try {
+		SendSessionRegistry::Checkout controller(_send_sessions(), session_id);
+		controller->session_id_string = SendSessionRegistry::string_from(session_id);
+		controller->metrics.record(parse_stopwatch, SendFundsMetrics::parseArgs);
+		ret_json = controller->prepare();
+		did_error = controller->didFail();
+	} catch (const std::exception &e) { // the caller never gets the session_id to release
+		_send_sessions().release(session_id);
+		return error_ret_json_from_message(e.what());
+	}
+	if (did_error) { // nothing to come back for
+		_send_sessions().release(session_id);
+	}
 
+	return ret_json;
+}
 //
 // From-JS function decls
 string emscr_SendFunds_bridge::send_funds(const string &args_string)
 {
-	boost::property_tree::ptree json_root;
-
-	std::istringstream ss(args_string);
-	boost::property_tree::read_json(ss, json_root);
+	SendFundsMetrics::Stopwatch parse_stopwatch;
+	string session_id_string;
+	vector<RandomAmountOutputs> mix_outs;
+	try {
+		_read_send_funds_args(args_string, session_id_string, mix_outs);
+	} catch (const StreamingJSON::ParseError &e) {
+		return error_ret_json_from_message(e.what());
+	}
+	return _send_funds(session_id_string, mix_outs, parse_stopwatch);
+}
 
-	return (*controller_ptr).handle(json_root);
+string emscr_SendFunds_bridge::send_funds_wire(const string &session_id_string, const uint8_t *random_outs, size_t random_outs_size)
+{
+	SendFundsMetrics::Stopwatch parse_stopwatch;
+	vector<RandomAmountOutputs> mix_outs;
+	string err_msg;
+	if (!SendFundsWireFormat::read_random_outs(random_outs, random_outs_size, mix_outs, err_msg)) {
+		return error_ret_json_from_message(err_msg);
+	}
+	return _send_funds(session_id_string, mix_outs, parse_stopwatch);
 }
 
 string emscr_SendFunds_bridge::prepare_send(const string &args_string)
 {
-	boost::property_tree::ptree json_root;
-
-	std::istringstream ss(args_string);
-	boost::property_tree::read_json(ss, json_root);
-	
-	const auto& destinations = json_root.get_child("destinations");
- 	vector<string> dest_addrs, dest_amounts;
- 	dest_addrs.reserve(destinations.size());
- 	dest_amounts.reserve(destinations.size());
-
- 	for (const auto& dest : destinations) {
- 		dest_addrs.emplace_back(dest.second.get<string>("to_address"));
- 		dest_amounts.emplace_back(dest.second.get<string>("send_amount"));
- 	}
-
-	Parameters parameters{
-		std::move(dest_amounts),
-		json_root.get<bool>("is_sweeping"),
-		(uint32_t)stoul(json_root.get<string>("priority")),
-		//
-		nettype_from_string(json_root.get<string>("nettype_string")),
-		json_root.get<string>("from_address_string"),
-		json_root.get<string>("sec_viewKey_string"),
-		json_root.get<string>("sec_spendKey_string"),
-		json_root.get<string>("pub_spendKey_string"),
-		//
-		std::move(dest_addrs),
-		//
-		json_root.get_optional<string>("manuallyEnteredPaymentID"),
-		json_root.get_child("unspentOuts")
-	};
-	controller_ptr = new FormSubmissionController{parameters}; // heap alloc
-	if (!controller_ptr) { // exception will be thrown if oom but JIC, since null ptrs are somehow legal in WASM
-		return error_ret_json_from_message("Out of memory (heap vals container)");
-	}
-	
-	return (*controller_ptr).prepare();
+	SendFundsMetrics::Stopwatch parse_stopwatch;
+	Parameters parameters{};
+	optional<string> wallet_context_string;
+	optional<string> output_index_strategy;
+	optional<string> unspent_outs_id;
+	try {
+		_read_prepare_send_args(args_string, parameters, false, wallet_context_string, output_index_strategy, unspent_outs_id);
+	} catch (const StreamingJSON::ParseError &e) {
+		return error_ret_json_from_message(e.what());
+	}
+	optional<string> err_msg = _apply_wallet_context(wallet_context_string, output_index_strategy, parameters, false);
+	if (err_msg == boost::none) {
+		err_msg = _take_unspent_outs_ingest(unspent_outs_id, parameters);
+	}
+	if (err_msg != boost::none) {
+		return error_ret_json_from_message(*err_msg);
+	}
+	return _prepare_send(std::move(parameters), parse_stopwatch);
+}
+
+string emscr_SendFunds_bridge::prepare_send_wire(const string &args_string, const uint8_t *unspent_outputs, size_t unspent_outputs_size)
+{
+	SendFundsMetrics::Stopwatch parse_stopwatch;
+	Parameters parameters{};
+	optional<string> wallet_context_string;
+	optional<string> output_index_strategy;
+	optional<string> unspent_outs_id;
+	try {
+		_read_prepare_send_args(args_string, parameters, true, wallet_context_string, output_index_strategy, unspent_outs_id);
+	} catch (const StreamingJSON::ParseError &e) {
+		return error_ret_json_from_message(e.what());
+	}
+	optional<string> err_msg = _apply_wallet_context(wallet_context_string, output_index_strategy, parameters, false);
+	if (err_msg != boost::none) {
+		return error_ret_json_from_message(*err_msg);
+	}
+	parameters.unspentOuts.outputs.clear(); // the buffer is the only source of outputs
+	string wire_err_msg;
+	if (!SendFundsWireFormat::read_unspent_outputs(unspent_outputs, unspent_outputs_size, parameters.unspentOuts.outputs, wire_err_msg)) {
+		return error_ret_json_from_message(wire_err_msg);
+	}
+	err_msg = _take_unspent_outs_ingest(unspent_outs_id, parameters);
+	if (err_msg != boost::none) {
+		return error_ret_json_from_message(*err_msg);
+	}
+	return _prepare_send(std::move(parameters), parse_stopwatch);
+}
+
+string emscr_SendFunds_bridge::prepare_batch_send(const string &args_string)
+{
+	Parameters parameters{};
+	optional<string> wallet_context_string;
+	optional<string> output_index_strategy;
+	optional<string> unspent_outs_id;
+	try {
+		_read_prepare_send_args(args_string, parameters, false, wallet_context_string, output_index_strategy, unspent_outs_id);
+	} catch (const StreamingJSON::ParseError &e) {
+		return error_ret_json_from_message(e.what());
+	}
+	// the batch planner picks its own outputs, so it's given every indexed one
+	optional<string> err_msg = _apply_wallet_context(wallet_context_string, output_index_strategy, parameters, true);
+	if (err_msg == boost::none) {
+		err_msg = _take_unspent_outs_ingest(unspent_outs_id, parameters);
+	}
+	if (err_msg != boost::none) {
+		return error_ret_json_from_message(*err_msg);
+	}
+	Runtime::SlotHandle session_id = _batch_send_sessions().emplace(std::move(parameters));
+	if (session_id == Runtime::invalid_slot_handle) {
+		return error_ret_json_from_message("Too many batch sends in progress");
+	}
+	string ret_json;
+	bool did_error = false;
+	try {
+		BatchSendSessionRegistry::Checkout controller(_batch_send_sessions(), session_id);
+		controller->session_id_string = BatchSendSessionRegistry::string_from(session_id);
+		ret_json = controller->prepare();
+		did_error = controller->didFail();
+	} catch (const std::exception &e) { // the caller never gets the session_id to release
+		_batch_send_sessions().release(session_id);
+		return error_ret_json_from_message(e.what());
+	}
+	if (did_error) {
+		_batch_send_sessions().release(session_id);
+	}
+
+	return ret_json;
+}
+
+string emscr_SendFunds_bridge::send_batch_funds(const string &args_string)
+{
+	string session_id_string;
+	vector<RandomAmountOutputs> mix_outs;
+	try {
+		_read_send_funds_args(args_string, session_id_string, mix_outs);
+	} catch (const StreamingJSON::ParseError &e) {
+		return error_ret_json_from_message(e.what());
+	}
+	if (session_id_string.empty()) {
+		return error_ret_json_from_message("Missing session_id");
+	}
+	Runtime::SlotHandle session_id = BatchSendSessionRegistry::handle_from(session_id_string);
+	string ret_json;
+	bool is_finished = true;
+	try {
+		BatchSendSessionRegistry::Checkout controller(_batch_send_sessions(), session_id);
+		if (!controller) {
+			return error_ret_json_from_message("Unknown or expired send session");
+		}
+		ret_json = controller->handle(mix_outs);
+		is_finished = !controller->isAwaitingRandomOuts();
+	} catch (const std::exception &e) { // the session can't be resumed, and the caller may not release it
+		_batch_send_sessions().release(session_id);
+		return error_ret_json_from_message(e.what());
+	}
+	if (is_finished) {
+		_batch_send_sessions().release(session_id);
+	}
+
+	return ret_json;
+}
+
+bool emscr_SendFunds_bridge::release_batch_send(const string &session_id_string)
+{
+	return _batch_send_sessions().release(BatchSendSessionRegistry::handle_from(session_id_string));
+}
+
+string emscr_SendFunds_bridge::plan_batch_send(const string &args_string)
+{
+	vector<uint64_t> sending_amounts;
+	vector<bool> is_integrated;
+	vector<uint64_t> output_amounts;
+	BatchFeeModel fees{ 0, 0, 1 };
+	bool is_sweeping = false;
+	try {
+		StreamingJSON::Reader reader(args_string);
+		string key;
+		reader.begin_object();
+		while (reader.next_key(key)) {
+			if (key == "sending_amounts") {
+				reader.begin_array();
+				while (reader.next_element()) {
+					sending_amounts.push_back(reader.read_uint64());
+				}
+			} else if (key == "is_integrated") {
+				reader.begin_array();
+				while (reader.next_element()) {
+					is_integrated.push_back(reader.read_bool());
+				}
+			} else if (key == "output_amounts") {
+				reader.begin_array();
+				while (reader.next_element()) {
+					output_amounts.push_back(reader.read_uint64());
+				}
+			} else if (key == "fee_per_b") {
+				fees.fee_per_b = reader.read_uint64();
+			} else if (key == "fee_per_o") {
+				fees.fee_per_o = reader.read_uint64();
+			} else if (key == "priority") {
+				fees.priority = (uint32_t)reader.read_uint64();
+			} else if (key == "is_sweeping") {
+				is_sweeping = reader.read_bool();
+			} else {
+				reader.skip_value();
+			}
+		}
+		reader.expect_end();
+	} catch (const StreamingJSON::ParseError &e) {
+		return error_ret_json_from_message(e.what());
+	}
+	is_integrated.resize(sending_amounts.size(), false);
+	vector<PlannedTransaction> plan;
+	optional<string> err_msg = is_sweeping
+		? plan_batch_sweep(output_amounts, plan)
+		: plan_batch_payout(sending_amounts, is_integrated, output_amounts, fees, plan);
+	if (err_msg != boost::none) {
+		return error_ret_json_from_message(*err_msg);
+	}
+	StreamingJSON::Writer writer(64 + output_amounts.size() * 8 + sending_amounts.size() * 8);
+	writer.begin_object();
+	writer.key("transactions").begin_array();
+	for (const PlannedTransaction &planned : plan) {
+		writer.begin_object();
+		writer.key("destination_indices").begin_array();
+		for (size_t i : planned.destination_indices) {
+			writer.uint_value(i);
+		}
+		writer.end_array();
+		writer.key("output_indices").begin_array();
+		for (size_t i : planned.output_indices) {
+			writer.uint_value(i);
+		}
+		writer.end_array();
+		writer.end_object();
+	}
+	writer.end_array();
+	writer.end_object();
+
+	return writer.take();
+}
+
+string emscr_SendFunds_bridge::output_index_add(const string &args_string)
+{
+	string wallet_context_string;
+	vector<UnspentOutput> outputs;
+	try {
+		StreamingJSON::Reader reader(args_string);
+		string key, scratch;
+		reader.begin_object();
+		while (reader.next_key(key)) {
+			if (key == "wallet_context") {
+				reader.read_scalar_text(wallet_context_string);
+			} else if (key == "outputs") {
+				reader.begin_array();
+				while (reader.next_element()) {
+					outputs.emplace_back();
+					if (!_read_unspent_output(reader, key, scratch, outputs.back())) {
+						outputs.pop_back();
+					}
+				}
+			} else {
+				reader.skip_value();
+			}
+		}
+		reader.expect_end();
+	} catch (const StreamingJSON::ParseError &e) {
+		return error_ret_json_from_message(e.what());
+	}
+	Wallet::ContextRegistry::Checkout context(Wallet::contexts(), Wallet::ContextRegistry::handle_from(wallet_context_string));
+	if (!context) {
+		return error_ret_json_from_message(Wallet::checkout_error(context));
+	}
+	// as in cb_I; spent outputs are left out of the index
+	KeyImages::Deriver deriver = context->deriver();
+	vector<bool> is_spent;
+	if (!find_spent_outputs(deriver, outputs, is_spent)) {
+		return error_ret_json_from_message("Unable to generate key image");
+	}
+	for (size_t i = 0; i < outputs.size(); ++i) {
+		if (is_spent[i]) {
+			context->outputs().remove(outputs[i].spendable.public_key);
+		} else {
+			context->outputs().add(std::move(outputs[i].spendable));
+		}
+	}
+	StreamingJSON::Writer writer(64);
+	writer.begin_object();
+	writer.key("retVal").uint_string_value(context->outputs().size());
+	writer.end_object();
+
+	return writer.take();
+}
+
+string emscr_SendFunds_bridge::output_index_remove(const string &args_string)
+{
+	string wallet_context_string;
+	vector<string> public_keys;
+	try {
+		StreamingJSON::Reader reader(args_string);
+		string key;
+		reader.begin_object();
+		while (reader.next_key(key)) {
+			if (key == "wallet_context") {
+				reader.read_scalar_text(wallet_context_string);
+			} else if (key == "public_keys") {
+				reader.begin_array();
+				while (reader.next_element()) {
+					public_keys.emplace_back();
+					reader.read_string(public_keys.back());
+				}
+			} else {
+				reader.skip_value();
+			}
+		}
+		reader.expect_end();
+	} catch (const StreamingJSON::ParseError &e) {
+		return error_ret_json_from_message(e.what());
+	}
+	Wallet::ContextRegistry::Checkout context(Wallet::contexts(), Wallet::ContextRegistry::handle_from(wallet_context_string));
+	if (!context) {
+		return error_ret_json_from_message(Wallet::checkout_error(context));
+	}
+	for (const string &public_key : public_keys) {
+		context->outputs().remove(public_key);
+	}
+	StreamingJSON::Writer writer(64);
+	writer.begin_object();
+	writer.key("retVal").uint_string_value(context->outputs().size());
+	writer.end_object();
+
+	return writer.take();
+}
+
+string emscr_SendFunds_bridge::begin_unspent_outs(const string &args_string)
+{
+	string wallet_context_string;
+	try {
+		StreamingJSON::Reader reader(args_string);
+		string key;
+		reader.begin_object();
+		while (reader.next_key(key)) {
+			if (key == "wallet_context") {
+				reader.read_scalar_text(wallet_context_string);
+			} else {
+				reader.skip_value();
+			}
+		}
+		reader.expect_end();
+	} catch (const StreamingJSON::ParseError &e) {
+		return error_ret_json_from_message(e.what());
+	}
+	Runtime::SlotHandle unspent_outs_id;
+	{
+		Wallet::ContextRegistry::Checkout context(Wallet::contexts(), Wallet::ContextRegistry::handle_from(wallet_context_string));
+		if (!context) {
+			return error_ret_json_from_message(Wallet::checkout_error(context));
+		}
+		unspent_outs_id = _unspent_outs_ingests().emplace(context->deriver());
+	}
+	if (unspent_outs_id == Runtime::invalid_slot_handle) {
+		return error_ret_json_from_message("Too many unspent outputs in progress");
+	}
+	StreamingJSON::Writer writer(64);
+	writer.begin_object();
+	writer.key("retVal").string_value(UnspentOutsIngestRegistry::string_from(unspent_outs_id));
+	writer.end_object();
+
+	return writer.take();
+}
+
+string emscr_SendFunds_bridge::append_unspent_outs(const string &unspent_outs_id_string, const string &chunk_string)
+{
+	UnspentOuts chunk;
+	try {
+		StreamingJSON::Reader reader(chunk_string);
+		string key;
+		bool has_outputs = false;
+		_read_unspent_outs(reader, key, chunk, has_outputs);
+		reader.expect_end();
+	} catch (const StreamingJSON::ParseError &e) {
+		return error_ret_json_from_message(e.what());
+	}
+	UnspentOutsIngestRegistry::Checkout ingest(_unspent_outs_ingests(), UnspentOutsIngestRegistry::handle_from(unspent_outs_id_string));
+	if (!ingest) {
+		return error_ret_json_from_message("Unknown or expired unspent outputs");
+	}
+	optional<string> err_msg = ingest->append(chunk);
+	if (err_msg != boost::none) {
+		return error_ret_json_from_message(*err_msg);
+	}
+	StreamingJSON::Writer writer(64);
+	writer.begin_object();
+	writer.key("retVal").uint_string_value(ingest->size());
+	writer.end_object();
+
+	return writer.take();
+}
+
+string emscr_SendFunds_bridge::finish_unspent_outs(const string &unspent_outs_id_string)
+{
+	UnspentOutsIngestRegistry::Checkout ingest(_unspent_outs_ingests(), UnspentOutsIngestRegistry::handle_from(unspent_outs_id_string));
+	if (!ingest) {
+		return error_ret_json_from_message("Unknown or expired unspent outputs");
+	}
+	ingest->finish();
+	StreamingJSON::Writer writer(64);
+	writer.begin_object();
+	writer.key("retVal").uint_string_value(ingest->size());
+	writer.end_object();
+
+	return writer.take();
+}
+
+bool emscr_SendFunds_bridge::release_unspent_outs(const string &unspent_outs_id_string)
+{
+	return _unspent_outs_ingests().release(UnspentOutsIngestRegistry::handle_from(unspent_outs_id_string));
+}
+
+bool emscr_SendFunds_bridge::release_send(const string &session_id_string)
+{
+	return _send_sessions().release(SendSessionRegistry::handle_from(session_id_string));
+}
+
+string emscr_SendFunds_bridge::verify_transaction(const string &args_string)
+{
+	SignedTransaction signed_tx;
+	vector<RandomAmountOutputs> mix_outs;
+	try {
+		StreamingJSON::Reader reader(args_string);
+		string key, scratch;
+		reader.begin_object();
+		while (reader.next_key(key)) {
+			if (key == "serialized_signed_tx") {
+				reader.read_string(signed_tx.serialized_signed_tx);
+			} else if (key == "using_outs") {
+				reader.begin_array();
+				while (reader.next_element()) {
+					UnspentOutput using_out;
+					if (!_read_unspent_output(reader, key, scratch, using_out)) {
+						reader.fail("Expected amount, public_key, global_index, index and tx_pub_key in each using out");
+					}
+					signed_tx.using_outs.push_back(std::move(using_out.spendable));
+				}
+			} else if (key == "mix_outs") {
+				_read_random_outs(reader, key, mix_outs);
+			} else {
+				reader.skip_value();
+			}
+		}
+		reader.expect_end();
+	} catch (const StreamingJSON::ParseError &e) {
+		return error_ret_json_from_message(e.what());
+	}
+	for (RandomAmountOutputs &amount_outs : mix_outs) {
+		signed_tx.mix_outs.push_back(std::move(amount_outs.outputs));
+	}
+	optional<string> err_msg = verify_signed_transactions({ &signed_tx });
+	if (err_msg != boost::none) {
+		return error_ret_json_from_message(*err_msg);
+	}
+	StreamingJSON::Writer writer(32);
+	writer.begin_object();
+	writer.key("retVal").bool_string_value(true);
+	writer.end_object();
+
+	return writer.take();
+}
+
+string emscr_SendFunds_bridge::send_metrics()
+{
+	return SendFundsMetrics::counters_json();
+}
+
+//
+// Proof tables
+static atomic<bool> proofs__are_warm(false);
+//
+// init_exponents in bulletproofs_plus.cc builds the generators, and the straus and pippenger
+// caches, for every proof size once per process under its own lock - one small proof and its
+// check are enough to trigger it.
+static void _warm_up_proofs()
+{
+	try {
+		rct::BulletproofPlus proof = rct::bulletproof_plus_PROVE((uint64_t)0, rct::skGen());
+		rct::bulletproof_plus_VERIFY(proof);
+	} catch (...) { // the first send builds them instead
+		proofs__are_warm = false;
+	}
+}
+bool emscr_SendFunds_bridge::warm_up_proofs(bool in_background)
+{
+	if (proofs__are_warm.exchange(true)) {
+		return false;
+	}
+#if MYMONERO_CLIENT_HAS_THREADS
+	if (in_background) {
+		thread(_warm_up_proofs).detach();
+		return true;
+	}
+#endif
+	_warm_up_proofs();
+	return true;
 }
@@ -34,6 +34,7 @@
 #define emscr_async_bridge_index_hpp
 //
 #include <string>
+#include <cstdint>
 #include <boost/optional.hpp>
 #include "cryptonote_config.h" 
 #include "SendFundsFormSubmissionController.hpp"
@@ -50,8 +51,65 @@ namespace emscr_SendFunds_bridge
 	// To use these functions, the appropriate emscripten-side JS fn handlers must exist, which must be hooked up to perform the e.g. networking or transport requests they are specced to perform, then upon the async completion of those requests, call the appropate "cb_I+"-named function to allow the internal evaluation of the routine entrypoint to complete.
 	//
 	// Public interface:
-	string prepare_send(const string &args_string);
-	string send_funds(const string &args_string);
+	string prepare_send(const string &args_string); // the returned document carries the session_id to pass to send_funds; a "wallet_context" handle may stand in for from_address_string and the key strings
+	string send_funds(const string &args_string); // may return another {amounts, count, session_id} request when the fee rose enough to select new inputs; answer it with send_funds again
+	//
+	// As above, with the unspent outputs and random outs in SendFundsWireFormat rather than JSON.
+	// args_string carries unspentOuts' fee fields without its outputs.
+	string prepare_send_wire(const string &args_string, const uint8_t *unspent_outputs, size_t unspent_outputs_size);
+	string send_funds_wire(const string &session_id_string, const uint8_t *random_outs, size_t random_outs_size);
+	bool release_send(const string &session_id_string); // for sends which are abandoned before send_funds
+	//
+	// Batch sends - the same args as prepare_send, planned into as many transactions as the
+	// destinations (or, sweeping, the outputs) need; see SendFundsBatchController.hpp. Each random
+	// outs request covers every transaction of the batch, and send_batch_funds finally returns
+	// { transactions: [ <send_funds document>, ... ] }. Payment IDs must come in integrated addresses.
+	string prepare_batch_send(const string &args_string);
+	string send_batch_funds(const string &args_string);
+	bool release_batch_send(const string &session_id_string);
+	// The plan prepare_batch_send would make, without the wallet: args { sending_amounts,
+	// is_integrated, output_amounts, fee_per_b, fee_per_o, priority, is_sweeping }, amounts in
+	// atomic units. Returns { transactions: [ { destination_indices, output_indices }, ... ] }.
+	string plan_batch_send(const string &args_string);
+	//
+	// The check of verify_before_return, of a transaction signed elsewhere: args { serialized_signed_tx,
+	// using_outs: [ <unspentOuts output>, ... ], mix_outs: [ <amount_outs entry>, ... ] } with one
+	// mix_outs entry, the decoys it may have been signed with, per using out.
+	string verify_transaction(const string &args_string);
+	//
+	// A wallet context's output index, which prepare_send / prepare_batch_send spend from in place
+	// of unspentOuts.outputs when their args carry "output_index": "minimize_inputs" or
+	// "consolidate_dust" next to "wallet_context" (unspentOuts still carries the fee fields).
+	// output_index_add args: { wallet_context, outputs: [ <unspentOuts output>, ... ] } - outputs
+	// which are already indexed are replaced, and ones found spent are removed.
+	// output_index_remove args: { wallet_context, public_keys: [ ... ] }
+	// Both return the number of indexed outputs as retVal.
+	string output_index_add(const string &args_string);
+	string output_index_remove(const string &args_string);
+	//
+	// Unspent outputs in chunks, for responses too large to pass to prepare_send whole, each
+	// checked for spends as it arrives; see UnspentOutsIngest.hpp.
+	// begin_unspent_outs args: { wallet_context } - returns the unspent_outs_id as retVal
+	// append_unspent_outs takes a chunk shaped like unspentOuts: any of its fee and fork fields,
+	// and outputs. It and finish_unspent_outs return the number of unspent outputs as retVal.
+	// prepare_send / prepare_batch_send then take "unspent_outs_id", which they consume, and
+	// need no unspentOuts.
+	string begin_unspent_outs(const string &args_string);
+	string append_unspent_outs(const string &unspent_outs_id_string, const string &chunk_string);
+	string finish_unspent_outs(const string &unspent_outs_id_string);
+	bool release_unspent_outs(const string &unspent_outs_id_string); // for ingests which are abandoned
+	//
+	// Cumulative per-phase timings and heap high-water marks of every send since start. Per-send
+	// samples come back in a "metrics" object when prepare_send's args carry "metrics": true.
+	string send_metrics();
+	//
+	// Builds the generator and multiexp tables which bulletproofs_plus.cc and multiexp.cc otherwise
+	// build lazily inside the first send of each process or instance, so that send pays no more
+	// than later ones. Call it right after loading, e.g. while unspent outputs are fetched; with
+	// in_background, and threads, it returns at once and a send which starts meanwhile waits for
+	// the tables rather than building them again. Returns false when an earlier call already
+	// started the warm-up.
+	bool warm_up_proofs(bool in_background);
 	// Internal
 }
 
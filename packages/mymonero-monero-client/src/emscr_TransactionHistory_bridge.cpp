@@ -0,0 +1,117 @@
+//
+//  emscr_TransactionHistory_bridge.cpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+//
+#include "emscr_TransactionHistory_bridge.hpp"
+//
+#include <boost/optional/optional.hpp>
+#include "string_tools.h"
+//
+#include "serial_bridge_utils.hpp"
+#include "StreamingJSON.hpp"
+#include "TransactionHistory.hpp"
+#include "KeyImages.hpp"
+#include "WalletContext.hpp"
+#include "emscr_KeyImage_bridge.hpp"
+//
+using namespace std;
+using namespace boost;
+using namespace serial_bridge_utils;
+//
+// From-JS function decls
+string emscr_TransactionHistory_bridge::parse_owned_transactions(const string &args_string, const string &payload_string)
+{
+	string wallet_context_string, address, sec_viewKey_string, pub_spendKey_string, sec_spendKey_string;
+	History::Payload payload;
+	try {
+		StreamingJSON::Reader reader(args_string);
+		string key;
+		reader.begin_object();
+		while (reader.next_key(key)) {
+			if (key == "wallet_context") {
+				reader.read_scalar_text(wallet_context_string);
+			} else if (key == "address") {
+				reader.read_string(address);
+			} else if (key == "sec_viewKey_string") {
+				reader.read_string(sec_viewKey_string);
+			} else if (key == "pub_spendKey_string") {
+				reader.read_string(pub_spendKey_string);
+			} else if (key == "sec_spendKey_string") {
+				reader.read_string(sec_spendKey_string);
+			} else {
+				reader.skip_value();
+			}
+		}
+		reader.expect_end();
+		//
+		History::read_payload(payload_string.data(), payload_string.data() + payload_string.size(), payload);
+	} catch (const StreamingJSON::ParseError &e) {
+		return error_ret_json_from_message(e.what());
+	}
+	crypto::secret_key sec_viewKey{};
+	crypto::public_key pub_spendKey{};
+	crypto::secret_key sec_spendKey{};
+	if (!wallet_context_string.empty()) { // keys were parsed by open_wallet_context
+		Wallet::ContextRegistry::Checkout context(Wallet::contexts(), Wallet::ContextRegistry::handle_from(wallet_context_string));
+		if (!context) {
+			return error_ret_json_from_message(Wallet::checkout_error(context));
+		}
+		address = context->address();
+		sec_viewKey = context->keys().sec_viewKey;
+		pub_spendKey = context->keys().pub_spendKey;
+		sec_spendKey = context->keys().sec_spendKey;
+	} else {
+		if (!epee::string_tools::hex_to_pod(sec_viewKey_string, sec_viewKey)) {
+			return error_ret_json_from_message("Invalid privateViewKey");
+		}
+		if (!epee::string_tools::hex_to_pod(pub_spendKey_string, pub_spendKey)) {
+			return error_ret_json_from_message("Invalid publicSpendKey");
+		}
+		if (!epee::string_tools::hex_to_pod(sec_spendKey_string, sec_spendKey)) {
+			return error_ret_json_from_message("Invalid privateSpendKey");
+		}
+	}
+	vector<KeyImages::OutputRef> spent_outputs;
+	History::spent_output_refs(payload, spent_outputs);
+	KeyImages::Deriver deriver(sec_viewKey, sec_spendKey);
+	vector<crypto::key_image> key_images;
+	optional<size_t> failed_index = address.empty()
+		? deriver.key_images(spent_outputs, key_images)
+		: emscr_KeyImage_bridge::cached_key_images(address, pub_spendKey, deriver, spent_outputs, key_images);
+	if (failed_index != none) {
+		return error_ret_json_from_message("Unable to generate key image of spent output " + std::to_string(*failed_index));
+	}
+	optional<string> err_string = History::filter_owned(payload, key_images);
+	if (err_string != none) {
+		return error_ret_json_from_message(*err_string);
+	}
+	return History::write_history(payload);
+}
@@ -0,0 +1,57 @@
+//
+//  emscr_TransactionHistory_bridge.hpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#ifndef emscr_TransactionHistory_bridge_hpp
+#define emscr_TransactionHistory_bridge_hpp
+//
+#include <string>
+//
+namespace emscr_TransactionHistory_bridge
+{
+	using namespace std;
+	//
+	// Bridging Functions - these take and return JSON strings, like those of serial_bridge.
+	//
+	// parse_owned_transactions args:
+	//   { address, sec_viewKey_string, pub_spendKey_string, sec_spendKey_string }
+	// or { wallet_context } with a handle from open_wallet_context in place of the keys.
+	// payload is the get_address_txs response, verbatim.
+	//
+	// The key images of the spent outputs come from, and are added to, the key image cache
+	// of the address (none when the keys are given without one). Returns the document
+	// described by History::write_history.
+	//
+	// Public interface:
+	string parse_owned_transactions(const string &args_string, const string &payload);
+}
+
+#endif /* emscr_TransactionHistory_bridge_hpp */
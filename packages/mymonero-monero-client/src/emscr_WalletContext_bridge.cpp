@@ -0,0 +1,69 @@
+//
+//  emscr_WalletContext_bridge.cpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+//
+#include "emscr_WalletContext_bridge.hpp"
+//
+#include <boost/property_tree/ptree.hpp>
+//
+#include "serial_bridge_utils.hpp"
+#include "WalletContext.hpp"
+//
+using namespace std;
+using namespace boost;
+using namespace serial_bridge_utils;
+//
+// From-JS function decls
+string emscr_WalletContext_bridge::open_wallet_context(
+	const string &address,
+	const string &sec_viewKey_string,
+	const string &sec_spendKey_string,
+	const string &nettype_string
+) {
+	cryptonote::network_type nettype = nettype_from_string(nettype_string);
+	Wallet::AccountKeys keys;
+	optional<string> err_msg = Wallet::parsed_account_keys(address, sec_viewKey_string, sec_spendKey_string, nettype, keys);
+	if (err_msg != none) {
+		return error_ret_json_from_message(*err_msg);
+	}
+	Runtime::SlotHandle handle = Wallet::contexts().emplace(address, nettype, keys);
+	if (handle == Runtime::invalid_slot_handle) {
+		return error_ret_json_from_message("Too many wallet contexts open");
+	}
+	property_tree::ptree root;
+	root.put(ret_json_key__generic_retVal(), Wallet::ContextRegistry::string_from(handle));
+	//
+	return ret_json_from_root(root);
+}
+bool emscr_WalletContext_bridge::close_wallet_context(const string &wallet_context_string)
+{
+	return Wallet::contexts().release(Wallet::ContextRegistry::handle_from(wallet_context_string));
+}
@@ -0,0 +1,284 @@
+//
+//  emscr_WalletState_bridge.cpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#include "emscr_WalletState_bridge.hpp"
+//
+#include <cstring>
+#include <boost/optional/optional.hpp>
+#include "string_tools.h"
+//
+#include "serial_bridge_utils.hpp"
+#include "StreamingJSON.hpp"
+#include "TransactionHistory.hpp"
+#include "KeyImages.hpp"
+#include "WalletContext.hpp"
+#include "WalletState.hpp"
+#include "emscr_KeyImage_bridge.hpp"
+//
+using namespace std;
+using namespace boost;
+using namespace serial_bridge_utils;
+//
+// Accessory functions
+static void _write_difference(StreamingJSON::Writer &writer, uint64_t a, uint64_t b)
+{ // a - b, which may be negative
+	if (a >= b) {
+		writer.uint_string_value(a - b);
+		return;
+	}
+	string difference = "-" + std::to_string(b - a);
+	writer.string_value(difference);
+}
+static void _write_balances(StreamingJSON::Writer &writer, const Wallet::State &state)
+{
+	Wallet::Balances balances = state.balances();
+	writer.begin_object();
+	_write_difference(writer.key("balance"), balances.total_received, balances.total_sent);
+	_write_difference( // balance - (locked_received - locked_sent)
+		writer.key("unlocked_balance"),
+		balances.total_received + balances.locked_sent,
+		balances.total_sent + balances.locked_received
+	);
+	_write_difference(writer.key("pending_balance"), balances.pending_received, balances.pending_sent);
+	writer.key("total_received").uint_string_value(balances.total_received);
+	writer.key("total_sent").uint_string_value(balances.total_sent);
+	writer.key("locked_received").uint_string_value(balances.locked_received);
+	writer.key("locked_sent").uint_string_value(balances.locked_sent);
+	writer.key("pending_received").uint_string_value(balances.pending_received);
+	writer.key("pending_sent").uint_string_value(balances.pending_sent);
+	writer.key("account_scanned_block_height").uint_value(state.scanned_block_height());
+	writer.key("blockchain_height").uint_value(state.blockchain_height());
+	writer.end_object();
+}
+static void _read_owned_output(StreamingJSON::Reader &reader, string &key, Wallet::OwnedOutput &out)
+{
+	bool has_public_key = false;
+	bool has_tx_pub_key = false;
+	out.output.out_index = 0;
+	out.amount = 0;
+	out.height = 0;
+	reader.begin_object();
+	while (reader.next_key(key)) {
+		if (key == "public_key") {
+			has_public_key = true;
+			reader.read_hex_pod(out.public_key);
+		} else if (key == "tx_pub_key") {
+			has_tx_pub_key = true;
+			reader.read_hex_pod(out.output.tx_pub_key);
+		} else if (key == "index") {
+			out.output.out_index = reader.read_uint64();
+		} else if (key == "amount") {
+			out.amount = reader.read_uint64();
+		} else if (key == "height") {
+			out.height = reader.read_null() ? 0 : reader.read_uint64();
+		} else {
+			reader.skip_value();
+		}
+	}
+	if (!has_public_key || !has_tx_pub_key) {
+		reader.fail("Expected public_key and tx_pub_key in each output");
+	}
+}
+static const char *_name_of(Wallet::OutputStatus status)
+{
+	switch (status) {
+		case Wallet::pendingSpend:
+			return "pending";
+		case Wallet::spent:
+			return "spent";
+		default:
+			return "unspent";
+	}
+}
+//
+// From-JS function decls
+string emscr_WalletState_bridge::apply_address_txs(const string &wallet_context_string, const string &payload_string)
+{
+	Wallet::ContextRegistry::Checkout context(Wallet::contexts(), Wallet::ContextRegistry::handle_from(wallet_context_string));
+	if (!context) {
+		return error_ret_json_from_message(Wallet::checkout_error(context));
+	}
+	Wallet::State &state = context->state();
+	optional<uint64_t> applied_height = state.applied_height();
+	History::Payload payload;
+	try { // past what the last refresh applied
+		History::read_payload(payload_string.data(), payload_string.data() + payload_string.size(), payload, applied_height);
+		if (applied_height != none && payload.scanned_block_height < *applied_height) { // the server rescanned or reorganized
+			state.clear_transactions();
+			applied_height = none;
+			History::read_payload(payload_string.data(), payload_string.data() + payload_string.size(), payload);
+		}
+	} catch (const StreamingJSON::ParseError &e) {
+		return error_ret_json_from_message(e.what());
+	}
+	bool is_delta = applied_height != none;
+	// only the delta's spent outputs need key images
+	vector<KeyImages::OutputRef> spent_outputs;
+	History::spent_output_refs(payload, spent_outputs);
+	KeyImages::Deriver deriver = context->deriver();
+	vector<crypto::key_image> key_images;
+	optional<size_t> failed_index = emscr_KeyImage_bridge::cached_key_images(context->address(), context->keys().pub_spendKey, deriver, spent_outputs, key_images);
+	if (failed_index != none) {
+		return error_ret_json_from_message("Unable to generate key image of spent output " + std::to_string(*failed_index));
+	}
+	optional<string> err_string = History::filter_owned(payload, key_images);
+	if (err_string != none) {
+		return error_ret_json_from_message(*err_string);
+	}
+	state.apply(payload);
+	string history = History::write_history(payload);
+	//
+	StreamingJSON::Writer writer(history.size() + 512);
+	writer.begin_object();
+	_write_balances(writer.key("balances"), state);
+	const char *is_delta_value = is_delta ? "true" : "false";
+	writer.key("is_delta").raw_value(is_delta_value, is_delta_value + strlen(is_delta_value));
+	writer.key("history").raw_value(history.data(), history.data() + history.size());
+	writer.end_object();
+
+	return writer.take();
+}
+
+string emscr_WalletState_bridge::add_owned_outputs(const string &args_string)
+{
+	string wallet_context_string;
+	vector<Wallet::OwnedOutput> outputs;
+	try {
+		StreamingJSON::Reader reader(args_string);
+		string key;
+		reader.begin_object();
+		while (reader.next_key(key)) {
+			if (key == "wallet_context") {
+				reader.read_scalar_text(wallet_context_string);
+			} else if (key == "outputs") {
+				reader.begin_array();
+				while (reader.next_element()) {
+					outputs.emplace_back();
+					_read_owned_output(reader, key, outputs.back());
+				}
+			} else {
+				reader.skip_value();
+			}
+		}
+		reader.expect_end();
+	} catch (const StreamingJSON::ParseError &e) {
+		return error_ret_json_from_message(e.what());
+	}
+	Wallet::ContextRegistry::Checkout context(Wallet::contexts(), Wallet::ContextRegistry::handle_from(wallet_context_string));
+	if (!context) {
+		return error_ret_json_from_message(Wallet::checkout_error(context));
+	}
+	Wallet::State &state = context->state();
+	vector<Wallet::OwnedOutput> new_outputs;
+	vector<KeyImages::OutputRef> new_output_refs;
+	for (const Wallet::OwnedOutput &output : outputs) {
+		if (!state.has_output(output.public_key)) {
+			new_outputs.push_back(output);
+			new_output_refs.push_back(output.output);
+		}
+	}
+	KeyImages::Deriver deriver = context->deriver();
+	vector<crypto::key_image> key_images;
+	optional<size_t> failed_index = emscr_KeyImage_bridge::cached_key_images(context->address(), context->keys().pub_spendKey, deriver, new_output_refs, key_images);
+	if (failed_index != none) {
+		return error_ret_json_from_message("Unable to generate key image");
+	}
+	for (size_t i = 0; i < new_outputs.size(); ++i) {
+		new_outputs[i].key_image = key_images[i];
+		state.add_output(new_outputs[i]);
+	}
+	StreamingJSON::Writer writer(64);
+	writer.begin_object();
+	writer.key("retVal").uint_string_value(state.n_outputs());
+	writer.end_object();
+
+	return writer.take();
+}
+
+string emscr_WalletState_bridge::wallet_state_balances(const string &wallet_context_string)
+{
+	Wallet::ContextRegistry::Checkout context(Wallet::contexts(), Wallet::ContextRegistry::handle_from(wallet_context_string));
+	if (!context) {
+		return error_ret_json_from_message(Wallet::checkout_error(context));
+	}
+	StreamingJSON::Writer writer(512);
+	_write_balances(writer, context->state());
+
+	return writer.take();
+}
+
+string emscr_WalletState_bridge::wallet_state_outputs(const string &wallet_context_string)
+{
+	Wallet::ContextRegistry::Checkout context(Wallet::contexts(), Wallet::ContextRegistry::handle_from(wallet_context_string));
+	if (!context) {
+		return error_ret_json_from_message(Wallet::checkout_error(context));
+	}
+	const Wallet::State &state = context->state();
+	vector<Wallet::OwnedOutput> outputs;
+	state.all_outputs(outputs);
+	StreamingJSON::Writer writer(64 + outputs.size() * 320);
+	writer.begin_object();
+	writer.key("outputs").begin_array();
+	for (const Wallet::OwnedOutput &output : outputs) {
+		writer.begin_object();
+		writer.key("public_key").string_value(epee::string_tools::pod_to_hex(output.public_key));
+		writer.key("tx_pub_key").string_value(epee::string_tools::pod_to_hex(output.output.tx_pub_key));
+		writer.key("index").uint_value(output.output.out_index);
+		writer.key("amount").uint_string_value(output.amount);
+		writer.key("height").uint_value(output.height);
+		writer.key("key_image").string_value(epee::string_tools::pod_to_hex(output.key_image));
+		writer.key("status").string_value(_name_of(state.status_of(output)));
+		writer.end_object();
+	}
+	writer.end_array();
+	writer.end_object();
+
+	return writer.take();
+}
+
+string emscr_WalletState_bridge::wallet_state_snapshot(const string &wallet_context_string)
+{
+	Wallet::ContextRegistry::Checkout context(Wallet::contexts(), Wallet::ContextRegistry::handle_from(wallet_context_string));
+	if (!context) {
+		return string();
+	}
+	return context->state().snapshot(context->keys().pub_spendKey);
+}
+
+bool emscr_WalletState_bridge::load_wallet_state_snapshot(const string &wallet_context_string, const string &snapshot)
+{
+	Wallet::ContextRegistry::Checkout context(Wallet::contexts(), Wallet::ContextRegistry::handle_from(wallet_context_string));
+	if (!context) {
+		return false;
+	}
+	return context->state().load_snapshot(snapshot, context->keys().pub_spendKey);
+}
@@ -0,0 +1,71 @@
+//
+//  emscr_WalletState_bridge.hpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#ifndef emscr_WalletState_bridge_hpp
+#define emscr_WalletState_bridge_hpp
+//
+#include <string>
+//
+namespace emscr_WalletState_bridge
+{
+	using namespace std;
+	//
+	// Bridging Functions - these take and return JSON strings, like those of serial_bridge.
+	//
+	// Each wallet context from open_wallet_context holds a Wallet::State, which these feed and read.
+	//
+	// apply_address_txs takes the get_address_txs response, verbatim, and applies what's new
+	// since the last call. Returns { balances, is_delta, history }: history is the document of
+	// History::write_history for the new confirmed transactions and every mempool one; is_delta
+	// is false when it holds all of them, i.e. the first time or after the server rescanned.
+	//
+	// add_owned_outputs args: { wallet_context, outputs: [ <unspentOuts output>, ... ] } - the
+	// key images of outputs which aren't held yet are derived, through the address's key image
+	// cache. Returns the number of outputs held as retVal.
+	//
+	// wallet_state_outputs returns { outputs: [ { public_key, tx_pub_key, index, amount, height,
+	// key_image, status: unspent | pending | spent }, ... ] }.
+	//
+	// wallet_state_snapshot returns the binary snapshot of Wallet::State, or an empty string for
+	// an unknown context; load_wallet_state_snapshot is false for a malformed snapshot or one of
+	// another wallet.
+	//
+	// Public interface:
+	string apply_address_txs(const string &wallet_context, const string &payload);
+	string add_owned_outputs(const string &args_string);
+	string wallet_state_balances(const string &wallet_context);
+	string wallet_state_outputs(const string &wallet_context);
+	string wallet_state_snapshot(const string &wallet_context);
+	bool load_wallet_state_snapshot(const string &wallet_context, const string &snapshot);
+}
+
+#endif /* emscr_WalletState_bridge_hpp */
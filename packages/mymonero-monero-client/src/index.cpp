@@ -34,33 +34,137 @@
 
 #include "serial_bridge_index.hpp"
 #include "emscr_SendFunds_bridge.hpp"
+#include "emscr_KeyImage_bridge.hpp"
+#include "emscr_WalletContext_bridge.hpp"
+#include "emscr_OutputScanner_bridge.hpp"
+#include "emscr_Address_bridge.hpp"
+#include "emscr_Fee_bridge.hpp"
+#include "emscr_TransactionHistory_bridge.hpp"
+#include "emscr_WalletState_bridge.hpp"
+//
+// Capabilities bound by this module. The lean MyMoneroClient_WASM_* targets in CMakeLists.txt
+// define a subset so the linker can drop what they don't bind (bulletproofs, the wordlists, ...)
+#define MYMONERO_CLIENT_CAP_ADDRESS 1 // addresses, payment IDs, keys from a seed, fees
+#define MYMONERO_CLIENT_CAP_MNEMONIC 2 // wallet generation and mnemonics
+#define MYMONERO_CLIENT_CAP_SCAN 4 // key images, wallet contexts and state, output scanning and history
+#define MYMONERO_CLIENT_CAP_SEND 8 // transaction construction
+#ifndef MYMONERO_CLIENT_CAPABILITIES
+#define MYMONERO_CLIENT_CAPABILITIES 15
+#endif
+#define MYMONERO_CLIENT_HAS(cap) ((MYMONERO_CLIENT_CAPABILITIES & MYMONERO_CLIENT_CAP_##cap) != 0)
 
 std::string getExceptionMessage(intptr_t exceptionPtr) {
   return std::string(reinterpret_cast<std::exception *>(exceptionPtr)->what());
 }
 
+#if MYMONERO_CLIENT_HAS(SCAN)
+emscripten::val keyImageCacheSnapshot(const std::string &address) {
+  // the view is only valid until the next call - callers must copy it out of the heap straight away
+  static std::string snapshot;
+  snapshot = emscr_KeyImage_bridge::key_image_cache_snapshot(address);
+  return emscripten::val(emscripten::typed_memory_view(snapshot.size(), (const unsigned char *)snapshot.data()));
+}
+
+emscripten::val walletStateSnapshot(const std::string &walletContext) {
+  // as keyImageCacheSnapshot - valid until the next call
+  static std::string snapshot;
+  snapshot = emscr_WalletState_bridge::wallet_state_snapshot(walletContext);
+  return emscripten::val(emscripten::typed_memory_view(snapshot.size(), (const unsigned char *)snapshot.data()));
+}
+#endif
+
+emscripten::val decodeAddresses(const std::string &addresses, const std::string &nettype) {
+  // as keyImageCacheSnapshot - valid until the next call
+  static std::string records;
+  records = emscr_Address_bridge::decode_addresses(addresses, nettype);
+  return emscripten::val(emscripten::typed_memory_view(records.size(), (const unsigned char *)records.data()));
+}
+
+emscripten::val estimateFeeMatrix(const std::string &args) {
+  // as keyImageCacheSnapshot - valid until the next call; the err_msg document as a string otherwise
+  static std::string fees;
+  if (!emscr_Fee_bridge::estimate_fee_matrix(args, fees)) {
+    return emscripten::val(fees);
+  }
+  return emscripten::val(emscripten::typed_memory_view(fees.size(), (const unsigned char *)fees.data()));
+}
+
+#if MYMONERO_CLIENT_HAS(SEND)
+// The wire variants take a buffer the caller wrote into the heap with Module._malloc
+std::string prepareTxWire(const std::string &args, uintptr_t unspentOutputs, size_t unspentOutputsSize) {
+  return emscr_SendFunds_bridge::prepare_send_wire(args, (const uint8_t *)unspentOutputs, unspentOutputsSize);
+}
+
+std::string createAndSignTxWire(const std::string &sessionId, uintptr_t randomOuts, size_t randomOutsSize) {
+  return emscr_SendFunds_bridge::send_funds_wire(sessionId, (const uint8_t *)randomOuts, randomOutsSize);
+}
+#endif
+
 EMSCRIPTEN_BINDINGS(my_module)
 { // C++ -> JS 
     emscripten::function("getExceptionMessage", &getExceptionMessage);
     emscripten::function("decodeAddress", &serial_bridge::decode_address);
+    emscripten::function("decodeAddresses", &decodeAddresses);
     emscripten::function("isSubaddress", &serial_bridge::is_subaddress);
     emscripten::function("isIntegratedAddress", &serial_bridge::is_integrated_address);
 
     emscripten::function("newIntegratedAddress", &serial_bridge::new_integrated_address);
     emscripten::function("generatePaymentId", &serial_bridge::new_payment_id);
+    emscripten::function("isValidKeys", &serial_bridge::validate_components_for_login);
+    emscripten::function("addressAndKeysFromSeed", &serial_bridge::address_and_keys_from_seed);
+
+    emscripten::function("estimateTxFee", &serial_bridge::estimated_tx_network_fee);
+    emscripten::function("estimateFeeMatrix", &estimateFeeMatrix);
+#if MYMONERO_CLIENT_HAS(MNEMONIC)
 
     emscripten::function("generateWallet", &serial_bridge::newly_created_wallet);
     emscripten::function("compareMnemonics", &serial_bridge::are_equal_mnemonics);
     emscripten::function("mnemonicFromSeed", &serial_bridge::mnemonic_from_seed);
     emscripten::function("seedAndKeysFromMnemonic", &serial_bridge::seed_and_keys_from_mnemonic);
-    emscripten::function("isValidKeys", &serial_bridge::validate_components_for_login);
-    emscripten::function("addressAndKeysFromSeed", &serial_bridge::address_and_keys_from_seed);
-
-    emscripten::function("estimateTxFee", &serial_bridge::estimated_tx_network_fee);
+#endif
+#if MYMONERO_CLIENT_HAS(SCAN)
 
     emscripten::function("generateKeyImage", &serial_bridge::generate_key_image);
+    emscripten::function("generateKeyImages", &emscr_KeyImage_bridge::generate_key_images);
+    emscripten::function("cachedKeyImage", &emscr_KeyImage_bridge::cached_key_image);
+    emscripten::function("contextKeyImage", &emscr_KeyImage_bridge::context_key_image);
+    emscripten::function("openWalletContext", &emscr_WalletContext_bridge::open_wallet_context);
+    emscripten::function("closeWalletContext", &emscr_WalletContext_bridge::close_wallet_context);
+    emscripten::function("scanOutputs", &emscr_OutputScanner_bridge::scan_outputs);
+    emscripten::function("parseOwnedTransactions", &emscr_TransactionHistory_bridge::parse_owned_transactions);
+    emscripten::function("keyImageCacheSnapshot", &keyImageCacheSnapshot);
+    emscripten::function("loadKeyImageCacheSnapshot", &emscr_KeyImage_bridge::key_image_cache_load);
+    emscripten::function("deleteKeyImageCache", &emscr_KeyImage_bridge::key_image_cache_delete);
+    emscripten::function("applyAddressTxs", &emscr_WalletState_bridge::apply_address_txs);
+    emscripten::function("addOwnedOutputs", &emscr_WalletState_bridge::add_owned_outputs);
+    emscripten::function("walletStateBalances", &emscr_WalletState_bridge::wallet_state_balances);
+    emscripten::function("walletStateOutputs", &emscr_WalletState_bridge::wallet_state_outputs);
+    emscripten::function("walletStateSnapshot", &walletStateSnapshot);
+    emscripten::function("loadWalletStateSnapshot", &emscr_WalletState_bridge::load_wallet_state_snapshot);
+#endif
+#if MYMONERO_CLIENT_HAS(SEND)
+
     emscripten::function("prepareTx", emscr_SendFunds_bridge::prepare_send);
     emscripten::function("createAndSignTx", &emscr_SendFunds_bridge::send_funds);
+    emscripten::function("prepareTxWire", &prepareTxWire);
+    emscripten::function("createAndSignTxWire", &createAndSignTxWire);
+    emscripten::function("releaseSendSession", &emscr_SendFunds_bridge::release_send);
+    emscripten::function("prepareBatchTx", &emscr_SendFunds_bridge::prepare_batch_send);
+    emscripten::function("createAndSignBatchTx", &emscr_SendFunds_bridge::send_batch_funds);
+    emscripten::function("releaseBatchSendSession", &emscr_SendFunds_bridge::release_batch_send);
+    emscripten::function("planBatchTx", &emscr_SendFunds_bridge::plan_batch_send);
+    emscripten::function("verifyTx", &emscr_SendFunds_bridge::verify_transaction);
+    emscripten::function("outputIndexAdd", &emscr_SendFunds_bridge::output_index_add);
+    emscripten::function("outputIndexRemove", &emscr_SendFunds_bridge::output_index_remove);
+    emscripten::function("beginUnspentOuts", &emscr_SendFunds_bridge::begin_unspent_outs);
+    emscripten::function("appendUnspentOuts", &emscr_SendFunds_bridge::append_unspent_outs);
+    emscripten::function("finishUnspentOuts", &emscr_SendFunds_bridge::finish_unspent_outs);
+    emscripten::function("releaseUnspentOuts", &emscr_SendFunds_bridge::release_unspent_outs);
+    emscripten::function("sendMetrics", &emscr_SendFunds_bridge::send_metrics);
+    emscripten::function("warmUpProofs", &emscr_SendFunds_bridge::warm_up_proofs);
+#endif
+
+    emscripten::constant("capabilities", MYMONERO_CLIENT_CAPABILITIES);
 }
 extern "C"
 { // C -> JS
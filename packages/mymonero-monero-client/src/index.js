@@ -1,6 +1,72 @@
 const WABridge = require('./WABridge')
 
-module.exports = async function () {
-  const thisModule = await require('./MyMoneroClient_WASM.js')({})
-  return new WABridge(thisModule)
+// Builds of the module by capability - see the MyMoneroClient_WASM* targets in CMakeLists.txt.
+// The requires are spelled out so bundlers can see them.
+const VARIANTS = {
+  address: () => require('./MyMoneroClient_WASM_Address.js'),
+  scan: () => require('./MyMoneroClient_WASM_Scan.js'),
+  full: () => require('./MyMoneroClient_WASM.js')
+}
+
+// The multi-threaded build needs SharedArrayBuffer, which browsers only provide to
+// cross-origin isolated pages, and node provides alongside worker_threads (12+).
+function supportsThreads () {
+  if (typeof SharedArrayBuffer === 'undefined') {
+    return false
+  }
+  if (typeof crossOriginIsolated !== 'undefined') {
+    return crossOriginIsolated === true
+  }
+  if (typeof process !== 'undefined' && process.versions && process.versions.node) {
+    return parseInt(process.versions.node.split('.')[0]) >= 12
+  }
+  return false
+}
+
+/**
+ * Loads the WebAssembly module. The multi-threaded build is used when the environment supports it
+ * and it was built; the single-threaded build is the fallback.
+ * @param {object} options
+ * @param {boolean} options.threads - Set to false to always load the single-threaded build.
+ * @param {string} options.variant - 'address' (addresses, payment IDs, keys from a seed and fees),
+ * 'scan' (address plus key images, wallet contexts and output scanning) or 'full' (the default,
+ * which adds mnemonics and transactions). The smaller variants download and start faster.
+ * @param {boolean} options.warmUp - Whether to build the range proof tables of the 'full' variant
+ * ahead of the first send. The multi-threaded build does so on a pthread unless this is false. The
+ * single-threaded build would block the main thread for it on the next turn of the event loop, so
+ * it only does so when this is true.
+ * @param {function} options.locateFile - Maps the .wasm file name to the URL it is served from.
+ * @returns {WABridge}
+ */
+module.exports = async function (options = {}) {
+  const variant = options.variant || 'full'
+  if (!Object.prototype.hasOwnProperty.call(VARIANTS, variant)) {
+    throw new Error('Unknown variant ' + variant)
+  }
+  const moduleArgs = {}
+  if (options.locateFile) {
+    moduleArgs.locateFile = options.locateFile
+  }
+  let thisModule = null
+  let isThreaded = false
+  if (variant === 'full' && options.threads !== false && supportsThreads()) {
+    try {
+      thisModule = await require('./MyMoneroClient_WASM_MT.js')(moduleArgs)
+      isThreaded = true
+    } catch (e) {
+      thisModule = null
+    }
+  }
+  if (thisModule === null) {
+    thisModule = await VARIANTS[variant]()(moduleArgs)
+  }
+  const bridge = new WABridge(thisModule)
+  if (variant === 'full') {
+    if (isThreaded && options.warmUp !== false) {
+      bridge.warmUpProofs(true)
+    } else if (!isThreaded && options.warmUp === true) { // after the caller's first turn, which is usually not a send
+      setTimeout(() => bridge.warmUpProofs(false), 0)
+    }
+  }
+  return bridge
 }
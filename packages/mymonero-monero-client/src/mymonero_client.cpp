@@ -0,0 +1,339 @@
+//
+//  mymonero_client.cpp
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+#include "mymonero_client.h"
+//
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+//
+#include "serial_bridge_index.hpp"
+#include "serial_bridge_utils.hpp"
+#include "emscr_SendFunds_bridge.hpp"
+#include "emscr_KeyImage_bridge.hpp"
+#include "emscr_WalletContext_bridge.hpp"
+#include "emscr_OutputScanner_bridge.hpp"
+#include "emscr_Address_bridge.hpp"
+#include "emscr_Fee_bridge.hpp"
+#include "emscr_TransactionHistory_bridge.hpp"
+#include "emscr_WalletState_bridge.hpp"
+//
+using namespace std;
+using namespace serial_bridge_utils;
+//
+// Accessory functions
+static char *_new_c_str(const string &str)
+{
+	char *c_str = (char *)malloc(str.size() + 1);
+	if (c_str == NULL) {
+		return NULL;
+	}
+	memcpy(c_str, str.data(), str.size());
+	c_str[str.size()] = '\0';
+	//
+	return c_str;
+}
+template <typename F>
+static char *_guarded_call(F fn)
+{ // exceptions thrown anywhere in the core are turned into the usual err_msg document
+	try {
+		return _new_c_str(fn());
+	} catch (const std::exception &e) {
+		return _new_c_str(error_ret_json_from_message(e.what()));
+	} catch (...) {
+		return _new_c_str(error_ret_json_from_message("Unknown exception"));
+	}
+}
+static string _str_or_empty(const char *c_str)
+{
+	return c_str != NULL ? string(c_str) : string();
+}
+//
+// C ABI
+char *mymonero_prepare_tx(const char *args_json)
+{
+	return _guarded_call([&]() {
+		return emscr_SendFunds_bridge::prepare_send(_str_or_empty(args_json));
+	});
+}
+char *mymonero_create_and_sign_tx(const char *args_json)
+{
+	return _guarded_call([&]() {
+		return emscr_SendFunds_bridge::send_funds(_str_or_empty(args_json));
+	});
+}
+char *mymonero_prepare_tx_wire(const char *args_json, const unsigned char *unspent_outputs, size_t unspent_outputs_size)
+{
+	return _guarded_call([&]() {
+		return emscr_SendFunds_bridge::prepare_send_wire(_str_or_empty(args_json), unspent_outputs, unspent_outputs_size);
+	});
+}
+char *mymonero_create_and_sign_tx_wire(const char *session_id, const unsigned char *random_outs, size_t random_outs_size)
+{
+	return _guarded_call([&]() {
+		return emscr_SendFunds_bridge::send_funds_wire(_str_or_empty(session_id), random_outs, random_outs_size);
+	});
+}
+int mymonero_release_send_session(const char *session_id)
+{
+	return emscr_SendFunds_bridge::release_send(_str_or_empty(session_id)) ? 1 : 0;
+}
+char *mymonero_prepare_batch_tx(const char *args_json)
+{
+	return _guarded_call([&]() {
+		return emscr_SendFunds_bridge::prepare_batch_send(_str_or_empty(args_json));
+	});
+}
+char *mymonero_create_and_sign_batch_tx(const char *args_json)
+{
+	return _guarded_call([&]() {
+		return emscr_SendFunds_bridge::send_batch_funds(_str_or_empty(args_json));
+	});
+}
+int mymonero_release_batch_send_session(const char *session_id)
+{
+	return emscr_SendFunds_bridge::release_batch_send(_str_or_empty(session_id)) ? 1 : 0;
+}
+char *mymonero_plan_batch_tx(const char *args_json)
+{
+	return _guarded_call([&]() {
+		return emscr_SendFunds_bridge::plan_batch_send(_str_or_empty(args_json));
+	});
+}
+char *mymonero_verify_tx(const char *args_json)
+{
+	return _guarded_call([&]() {
+		return emscr_SendFunds_bridge::verify_transaction(_str_or_empty(args_json));
+	});
+}
+char *mymonero_output_index_add(const char *args_json)
+{
+	return _guarded_call([&]() {
+		return emscr_SendFunds_bridge::output_index_add(_str_or_empty(args_json));
+	});
+}
+char *mymonero_output_index_remove(const char *args_json)
+{
+	return _guarded_call([&]() {
+		return emscr_SendFunds_bridge::output_index_remove(_str_or_empty(args_json));
+	});
+}
+char *mymonero_begin_unspent_outs(const char *args_json)
+{
+	return _guarded_call([&]() {
+		return emscr_SendFunds_bridge::begin_unspent_outs(_str_or_empty(args_json));
+	});
+}
+char *mymonero_append_unspent_outs(const char *unspent_outs_id, const char *chunk_json)
+{
+	return _guarded_call([&]() {
+		return emscr_SendFunds_bridge::append_unspent_outs(_str_or_empty(unspent_outs_id), _str_or_empty(chunk_json));
+	});
+}
+char *mymonero_finish_unspent_outs(const char *unspent_outs_id)
+{
+	return _guarded_call([&]() {
+		return emscr_SendFunds_bridge::finish_unspent_outs(_str_or_empty(unspent_outs_id));
+	});
+}
+int mymonero_release_unspent_outs(const char *unspent_outs_id)
+{
+	return emscr_SendFunds_bridge::release_unspent_outs(_str_or_empty(unspent_outs_id)) ? 1 : 0;
+}
+char *mymonero_send_metrics(void)
+{
+	return _guarded_call([&]() {
+		return emscr_SendFunds_bridge::send_metrics();
+	});
+}
+int mymonero_warm_up_proofs(int in_background)
+{
+	return emscr_SendFunds_bridge::warm_up_proofs(in_background != 0) ? 1 : 0;
+}
+char *mymonero_generate_key_image(
+	const char *tx_pub_key,
+	const char *sec_viewKey,
+	const char *pub_spendKey,
+	const char *sec_spendKey,
+	const char *output_index
+) {
+	return _guarded_call([&]() {
+		return serial_bridge::generate_key_image(
+			_str_or_empty(tx_pub_key),
+			_str_or_empty(sec_viewKey),
+			_str_or_empty(pub_spendKey),
+			_str_or_empty(sec_spendKey),
+			_str_or_empty(output_index)
+		);
+	});
+}
+char *mymonero_generate_key_images(const char *args_json)
+{
+	return _guarded_call([&]() {
+		return emscr_KeyImage_bridge::generate_key_images(_str_or_empty(args_json));
+	});
+}
+char *mymonero_cached_key_image(
+	const char *address,
+	const char *tx_pub_key,
+	const char *sec_viewKey,
+	const char *pub_spendKey,
+	const char *sec_spendKey,
+	const char *output_index
+) {
+	return _guarded_call([&]() {
+		return emscr_KeyImage_bridge::cached_key_image(
+			_str_or_empty(address),
+			_str_or_empty(tx_pub_key),
+			_str_or_empty(sec_viewKey),
+			_str_or_empty(pub_spendKey),
+			_str_or_empty(sec_spendKey),
+			_str_or_empty(output_index)
+		);
+	});
+}
+char *mymonero_key_image_cache_snapshot(const char *address, size_t *out__length)
+{
+	string snapshot = emscr_KeyImage_bridge::key_image_cache_snapshot(_str_or_empty(address));
+	if (out__length != NULL) {
+		*out__length = snapshot.size();
+	}
+	return _new_c_str(snapshot);
+}
+int mymonero_key_image_cache_load(const char *address, const char *snapshot, size_t length)
+{
+	if (snapshot == NULL) {
+		return 0;
+	}
+	return emscr_KeyImage_bridge::key_image_cache_load(_str_or_empty(address), string(snapshot, length)) ? 1 : 0;
+}
+int mymonero_key_image_cache_delete(const char *address)
+{
+	return emscr_KeyImage_bridge::key_image_cache_delete(_str_or_empty(address)) ? 1 : 0;
+}
+char *mymonero_open_wallet_context(const char *address, const char *sec_viewKey, const char *sec_spendKey, const char *nettype)
+{
+	return _guarded_call([&]() {
+		return emscr_WalletContext_bridge::open_wallet_context(
+			_str_or_empty(address),
+			_str_or_empty(sec_viewKey),
+			_str_or_empty(sec_spendKey),
+			_str_or_empty(nettype)
+		);
+	});
+}
+int mymonero_close_wallet_context(const char *wallet_context)
+{
+	return emscr_WalletContext_bridge::close_wallet_context(_str_or_empty(wallet_context)) ? 1 : 0;
+}
+char *mymonero_context_key_image(const char *wallet_context, const char *tx_pub_key, const char *output_index)
+{
+	return _guarded_call([&]() {
+		return emscr_KeyImage_bridge::context_key_image(
+			_str_or_empty(wallet_context),
+			_str_or_empty(tx_pub_key),
+			_str_or_empty(output_index)
+		);
+	});
+}
+char *mymonero_decode_addresses(const char *addresses, const char *nettype, size_t *out__length)
+{
+	string records = emscr_Address_bridge::decode_addresses(_str_or_empty(addresses), _str_or_empty(nettype));
+	if (out__length != NULL) {
+		*out__length = records.size();
+	}
+	return _new_c_str(records);
+}
+char *mymonero_estimate_fee_matrix(const char *args_json, size_t *out__length)
+{
+	string fees;
+	bool is_valid = emscr_Fee_bridge::estimate_fee_matrix(_str_or_empty(args_json), fees);
+	if (out__length != NULL) {
+		*out__length = is_valid ? fees.size() : 0;
+	}
+	return _new_c_str(fees);
+}
+char *mymonero_scan_outputs(const char *args_json)
+{
+	return _guarded_call([&]() {
+		return emscr_OutputScanner_bridge::scan_outputs(_str_or_empty(args_json));
+	});
+}
+char *mymonero_parse_owned_transactions(const char *args_json, const char *payload_json)
+{
+	return _guarded_call([&]() {
+		return emscr_TransactionHistory_bridge::parse_owned_transactions(_str_or_empty(args_json), _str_or_empty(payload_json));
+	});
+}
+char *mymonero_apply_address_txs(const char *wallet_context, const char *payload_json)
+{
+	return _guarded_call([&]() {
+		return emscr_WalletState_bridge::apply_address_txs(_str_or_empty(wallet_context), _str_or_empty(payload_json));
+	});
+}
+char *mymonero_add_owned_outputs(const char *args_json)
+{
+	return _guarded_call([&]() {
+		return emscr_WalletState_bridge::add_owned_outputs(_str_or_empty(args_json));
+	});
+}
+char *mymonero_wallet_state_balances(const char *wallet_context)
+{
+	return _guarded_call([&]() {
+		return emscr_WalletState_bridge::wallet_state_balances(_str_or_empty(wallet_context));
+	});
+}
+char *mymonero_wallet_state_outputs(const char *wallet_context)
+{
+	return _guarded_call([&]() {
+		return emscr_WalletState_bridge::wallet_state_outputs(_str_or_empty(wallet_context));
+	});
+}
+char *mymonero_wallet_state_snapshot(const char *wallet_context, size_t *out__length)
+{
+	string snapshot = emscr_WalletState_bridge::wallet_state_snapshot(_str_or_empty(wallet_context));
+	if (out__length != NULL) {
+		*out__length = snapshot.size();
+	}
+	return _new_c_str(snapshot);
+}
+int mymonero_wallet_state_load(const char *wallet_context, const char *snapshot, size_t length)
+{
+	if (snapshot == NULL) {
+		return 0;
+	}
+	return emscr_WalletState_bridge::load_wallet_state_snapshot(_str_or_empty(wallet_context), string(snapshot, length)) ? 1 : 0;
+}
+void mymonero_string_free(char *str)
+{
+	free(str);
+}
@@ -0,0 +1,136 @@
+//
+//  mymonero_client.h
+//  Copyright (c) 2014-2021, MyMonero.com
+//
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are
+//  permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice, this list of
+//	conditions and the following disclaimer.
+//
+//  2. Redistributions in binary form must reproduce the above copyright notice, this list
+//	of conditions and the following disclaimer in the documentation and/or other
+//	materials provided with the distribution.
+//
+//  3. Neither the name of the copyright holder nor the names of its contributors may be
+//	used to endorse or promote products derived from this software without specific
+//	prior written permission.
+//
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+//  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+//  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+
+#ifndef mymonero_client_h
+#define mymonero_client_h
+//
+// C ABI for the native (non-emscripten) build. These take and return the same
+// JSON documents as the WASM bindings in index.cpp so callers on either side
+// share one request/response format.
+//
+// Every returned string is heap allocated and must be released with
+// mymonero_string_free. Errors are returned as {"err_msg": ...} documents -
+// no C++ exception crosses this boundary.
+//
+#include <stddef.h>
+//
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+	//
+	// Send - same documents as prepareTx / createAndSignTx
+	char *mymonero_prepare_tx(const char *args_json);
+	char *mymonero_create_and_sign_tx(const char *args_json);
+	int mymonero_release_send_session(const char *session_id); // 1 when a session was released
+	char *mymonero_send_metrics(void); // same document as sendMetrics
+	int mymonero_warm_up_proofs(int in_background); // 1 when this call started the warm-up
+	//
+	// Batch send - same documents as prepareBatchTx / createAndSignBatchTx
+	char *mymonero_prepare_batch_tx(const char *args_json);
+	char *mymonero_create_and_sign_batch_tx(const char *args_json);
+	int mymonero_release_batch_send_session(const char *session_id);
+	char *mymonero_plan_batch_tx(const char *args_json); // same document as planBatchTx
+	char *mymonero_verify_tx(const char *args_json); // same document as verifyTx
+	//
+	// Output index of a wallet context - same documents as outputIndexAdd / outputIndexRemove
+	char *mymonero_output_index_add(const char *args_json);
+	char *mymonero_output_index_remove(const char *args_json);
+	//
+	// Unspent outputs in chunks - same documents as beginUnspentOuts / appendUnspentOuts / finishUnspentOuts;
+	// the retVal of mymonero_begin_unspent_outs goes in the send args as "unspent_outs_id"
+	char *mymonero_begin_unspent_outs(const char *args_json);
+	char *mymonero_append_unspent_outs(const char *unspent_outs_id, const char *chunk_json);
+	char *mymonero_finish_unspent_outs(const char *unspent_outs_id);
+	int mymonero_release_unspent_outs(const char *unspent_outs_id); // 1 when unspent outputs were released
+	//
+	// Send - unspent outputs and random outs in the binary layout described in SendFundsWireFormat.hpp
+	char *mymonero_prepare_tx_wire(const char *args_json, const unsigned char *unspent_outputs, size_t unspent_outputs_size);
+	char *mymonero_create_and_sign_tx_wire(const char *session_id, const unsigned char *random_outs, size_t random_outs_size);
+	//
+	// Key images - same arguments as generateKeyImage
+	char *mymonero_generate_key_image(
+		const char *tx_pub_key,
+		const char *sec_viewKey,
+		const char *pub_spendKey,
+		const char *sec_spendKey,
+		const char *output_index
+	);
+	// same document as generateKeyImages
+	char *mymonero_generate_key_images(const char *args_json);
+	//
+	// Key image cache - one bounded cache per wallet address
+	char *mymonero_cached_key_image(
+		const char *address,
+		const char *tx_pub_key,
+		const char *sec_viewKey,
+		const char *pub_spendKey,
+		const char *sec_spendKey,
+		const char *output_index
+	);
+	char *mymonero_key_image_cache_snapshot(const char *address, size_t *out__length); // binary; release with mymonero_string_free
+	int mymonero_key_image_cache_load(const char *address, const char *snapshot, size_t length);
+	int mymonero_key_image_cache_delete(const char *address);
+	//
+	// Wallet contexts - keys parsed once; the handle (retVal) replaces them in the calls above
+	// via a "wallet_context" member, and in mymonero_context_key_image
+	char *mymonero_open_wallet_context(const char *address, const char *sec_viewKey, const char *sec_spendKey, const char *nettype);
+	int mymonero_close_wallet_context(const char *wallet_context); // 1 when a context was closed
+	char *mymonero_context_key_image(const char *wallet_context, const char *tx_pub_key, const char *output_index);
+	//
+	// Addresses - newline-separated in, packed records out as described in emscr_Address_bridge.hpp
+	char *mymonero_decode_addresses(const char *addresses, const char *nettype, size_t *out__length); // binary; release with mymonero_string_free
+	//
+	// Fees - packed little-endian uint64s as described in emscr_Fee_bridge.hpp
+	char *mymonero_estimate_fee_matrix(const char *args_json, size_t *out__length); // binary, or the err_msg document with a length of 0; release with mymonero_string_free
+	//
+	// Output scanning - same document as scanOutputs
+	char *mymonero_scan_outputs(const char *args_json);
+	//
+	// Transaction history - same documents as parseOwnedTransactions; payload_json is the get_address_txs response
+	char *mymonero_parse_owned_transactions(const char *args_json, const char *payload_json);
+	//
+	// Wallet state of a wallet context - same documents as applyAddressTxs / addOwnedOutputs /
+	// walletStateBalances / walletStateOutputs
+	char *mymonero_apply_address_txs(const char *wallet_context, const char *payload_json);
+	char *mymonero_add_owned_outputs(const char *args_json);
+	char *mymonero_wallet_state_balances(const char *wallet_context);
+	char *mymonero_wallet_state_outputs(const char *wallet_context);
+	char *mymonero_wallet_state_snapshot(const char *wallet_context, size_t *out__length); // binary, empty for an unknown context; release with mymonero_string_free
+	int mymonero_wallet_state_load(const char *wallet_context, const char *snapshot, size_t length);
+	//
+	void mymonero_string_free(char *str);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* mymonero_client_h */
@@ -6,6 +6,15 @@ const nettype = 'MAINNET'
 const wasmLocation = '../../src/index'
 
 describe('cryptonote_utils tests', function () {
+  const address = '43zxvpcj5Xv9SEkNXbMCG7LPQStHMpFCQCmkmR4u5nzjWwq5Xkv5VmGgYEsHXg4ja2FGRD5wMWbBVMijDTqmmVqm93wHGkg'
+  const privateViewKey = '7bea1907940afdd480eff7c4bcadb478a0fbb626df9e3ed74ae801e18f53e104'
+  const publicSpendKey = '3eb884d3440d71326e27cc07a861b873e72abd339feb654660c36a008a0028b3'
+  const privateSpendKey = '4e6d43cd03812b803c6f3206689f5fcc910005fc7e91d50d79b0776dbefcd803'
+  const wallet = { address: address, privateViewKey: privateViewKey, publicSpendKey: publicSpendKey, privateSpendKey: privateSpendKey }
+  const unspentOutput = function (txPublicKey, publicKey, index, spendKeyImages = []) {
+    return { amount: '1000000000000', public_key: publicKey, global_index: '100', index: '' + index, tx_pub_key: txPublicKey, height: 40, spend_key_images: spendKeyImages }
+  }
+
   it('create_address aka address_and_keys_from_seed', async function () {
     const WABridge = await require(wasmLocation)({})
     const decoded = WABridge.addressAndKeysFromSeed('9c973aa296b79bbf452781dd3d32ad7f', nettype)
@@ -339,6 +348,36 @@ describe('cryptonote_utils tests', function () {
     }).to.throw('Invalid address')
   })
 
+  it('decode addresses in one call', async function () {
+    const WABridge = await require(wasmLocation)({})
+    const decoded = WABridge.decodeAddresses([
+      '49qwWM9y7j1fvaBK684Y5sMbN8MZ3XwDLcSaqcKwjh5W9kn9qFigPBNBwzdq6TCAm2gKxQWrdZuEZQBMjQodi9cNRHuCbTr',
+      '49qwWM9y7j1fvaBK684Y5sMbN8MZ3$%wDLcSaqcKwjh5W9kn9qFigPBNBwzdq6TCAm2gKxQWrdZuEZQBMjQodi9cNRHuCbTr',
+      '4KYcX9yTizXfvaBK684Y5sMbN8MZ3XwDLcSaqcKwjh5W9kn9qFigPBNBwzdq6TCAm2gKxQWrdZuEZQBMjQodi9cNd3mZpgrjXBKMx9ee7c',
+      ''
+    ], nettype)
+    assert.deepStrictEqual(decoded, [
+      {
+        isValid: true,
+        publicSpendKey: 'd8f1e81ecbe25ce8b596d426fb02fe7b1d4bb8d14c06b3d3e371a60eeea99534',
+        publicViewKey: '576f0e61e250d941746ed147f602b5eb1ea250ca385b028a935e166e18f74bd7',
+        paymentId: undefined,
+        isSubaddress: false,
+        isIntegrated: false
+      },
+      { isValid: false },
+      {
+        isValid: true,
+        publicSpendKey: 'd8f1e81ecbe25ce8b596d426fb02fe7b1d4bb8d14c06b3d3e371a60eeea99534',
+        publicViewKey: '576f0e61e250d941746ed147f602b5eb1ea250ca385b028a935e166e18f74bd7',
+        paymentId: '83eab71fbee84eb9',
+        isSubaddress: false,
+        isIntegrated: true
+      },
+      { isValid: false }
+    ])
+  })
+
   it('generate key image', async function () {
     const WABridge = await require(wasmLocation)({})
 
@@ -355,6 +394,286 @@ describe('cryptonote_utils tests', function () {
     )
   })
 
+  it('generate key images matches single key image generation', async function () {
+    const WABridge = await require(wasmLocation)({})
+
+    const result = WABridge.generateKeyImages(
+      '5925eac0f78c40a79c75a43be68905adeb7b6ae34c1be2dda2b5b417f8099700',
+      '1a9fd7ccfa0de91673f5637eb94a67d85b54eae83d1ec9b609689ec846a50fdd',
+      '5000f1da72ec13401b6e4cfccdc5e52c9d0b04383fcb32c85f235874c5104e0d',
+      [
+        { txPublicKey: '585d3601bc6f3b63ad041fbb5f301a6239cbc98ec2954ef827d5f81aed59cff9', outputIndex: 1 },
+        { txPublicKey: '585d3601bc6f3b63ad041fbb5f301a6239cbc98ec2954ef827d5f81aed59cff9', outputIndex: 0 }
+      ]
+    )
+    assert.deepStrictEqual(
+      result,
+      [
+        '8a90c3e855fde0a85e71c9c345a26d094a56a5070b0bba6c1e9495bd49aa0741',
+        WABridge.generateKeyImage(
+          '585d3601bc6f3b63ad041fbb5f301a6239cbc98ec2954ef827d5f81aed59cff9',
+          '5925eac0f78c40a79c75a43be68905adeb7b6ae34c1be2dda2b5b417f8099700',
+          '1a9fd7ccfa0de91673f5637eb94a67d85b54eae83d1ec9b609689ec846a50fdd',
+          '5000f1da72ec13401b6e4cfccdc5e52c9d0b04383fcb32c85f235874c5104e0d',
+          0
+        )
+      ]
+    )
+  })
+
+  it('cached key image survives a snapshot round trip', async function () {
+    const WABridge = await require(wasmLocation)({})
+
+    const keyImage = WABridge.cachedKeyImage(
+      address,
+      '585d3601bc6f3b63ad041fbb5f301a6239cbc98ec2954ef827d5f81aed59cff9',
+      '5925eac0f78c40a79c75a43be68905adeb7b6ae34c1be2dda2b5b417f8099700',
+      '1a9fd7ccfa0de91673f5637eb94a67d85b54eae83d1ec9b609689ec846a50fdd',
+      '5000f1da72ec13401b6e4cfccdc5e52c9d0b04383fcb32c85f235874c5104e0d',
+      1
+    )
+    assert.strictEqual(keyImage, '8a90c3e855fde0a85e71c9c345a26d094a56a5070b0bba6c1e9495bd49aa0741')
+
+    const snapshot = WABridge.keyImageCacheSnapshot(address)
+    assert.strictEqual(snapshot.length, 16 + 64)
+    WABridge.deleteKeyImageCache(address)
+    assert.strictEqual(WABridge.loadKeyImageCacheSnapshot(address, snapshot), true)
+    assert.deepStrictEqual(WABridge.keyImageCacheSnapshot(address), snapshot)
+    WABridge.deleteKeyImageCache(address)
+  })
+
+  it('wallet context key images match key images from hex keys', async function () {
+    const WABridge = await require(wasmLocation)({})
+    const txPublicKey = '585d3601bc6f3b63ad041fbb5f301a6239cbc98ec2954ef827d5f81aed59cff9'
+
+    const walletContext = WABridge.openWalletContext(address, privateViewKey, privateSpendKey, nettype)
+    const expected = WABridge.generateKeyImage(txPublicKey, privateViewKey, publicSpendKey, privateSpendKey, 1)
+    assert.strictEqual(WABridge.contextKeyImage(walletContext, txPublicKey, 1), expected)
+    assert.deepStrictEqual(WABridge.contextKeyImages(walletContext, [{ txPublicKey: txPublicKey, outputIndex: 1 }]), [expected])
+
+    assert.strictEqual(WABridge.closeWalletContext(walletContext), true)
+    assert.strictEqual(WABridge.closeWalletContext(walletContext), false)
+    chai.expect(() => {
+      WABridge.contextKeyImage(walletContext, txPublicKey, 1)
+    }).to.throw('Unknown or closed wallet context')
+    WABridge.deleteKeyImageCache(address)
+  })
+
+  it('scan outputs finds the owned output and decrypts its amount', async function () {
+    const WABridge = await require(wasmLocation)({})
+    const txPublicKey = '938a463abc1ea1ea0621ada04331b4947e33d4e0ee27d821dd3245c1320add7d'
+
+    const walletContext = WABridge.openWalletContext(address, privateViewKey, privateSpendKey, nettype)
+    const owned = WABridge.scanOutputs(walletContext, [
+      {
+        tx_pub_key: txPublicKey,
+        outputs: [
+          { public_key: '8e74deaffb7e592ed292cb59453754151589ddde4f79d8b510c07637bd61b845', view_tag: 'fe', encrypted_amount: '0000000000000000' },
+          { public_key: 'bb7088875c914a2d3e99e4d047ef0fd1a892bbf87872c2aafe23e2d49acbbc12', view_tag: '1d', encrypted_amount: '66b1747574079d4a' }
+        ]
+      }
+    ], true)
+    WABridge.closeWalletContext(walletContext)
+
+    assert.deepStrictEqual(owned, [
+      {
+        tx_index: '0',
+        index: '1',
+        public_key: 'bb7088875c914a2d3e99e4d047ef0fd1a892bbf87872c2aafe23e2d49acbbc12',
+        amount: '1234567890',
+        key_image: WABridge.generateKeyImage(txPublicKey, privateViewKey, publicSpendKey, privateSpendKey, 1)
+      }
+    ])
+  })
+
+  it('parse owned transactions drops decoy spends and foreign transactions', async function () {
+    const WABridge = await require(wasmLocation)({})
+    const txPublicKey = '938a463abc1ea1ea0621ada04331b4947e33d4e0ee27d821dd3245c1320add7d'
+    const ownKeyImage = WABridge.generateKeyImage(txPublicKey, privateViewKey, publicSpendKey, privateSpendKey, 1)
+    const decoyKeyImage = '8a90c3e855fde0a85e71c9c345a26d094a56a5070b0bba6c1e9495bd49aa0741'
+    const history = WABridge.parseOwnedTransactions({
+      scanned_height: 100,
+      blockchain_height: 120,
+      transactions: [
+        {
+          id: 1,
+          hash: 'a',
+          total_received: '0',
+          total_sent: '3000000000000',
+          payment_id: '0123456789abcdef',
+          spent_outputs: [
+            { amount: '1000000000000', key_image: ownKeyImage, tx_pub_key: txPublicKey, out_index: 1, mixin: 15 },
+            { amount: '2000000000000', key_image: decoyKeyImage, tx_pub_key: txPublicKey, out_index: 0, mixin: 15 }
+          ]
+        },
+        {
+          id: 2,
+          hash: 'b',
+          total_received: '0',
+          total_sent: '2000000000000',
+          spent_outputs: [
+            { amount: '2000000000000', key_image: decoyKeyImage, tx_pub_key: txPublicKey, out_index: 0, mixin: 15 }
+          ]
+        },
+        { id: 3, hash: 'c', total_received: '1500000000000', total_sent: '0', height: null, mempool: true }
+      ]
+    }, wallet)
+
+    assert.strictEqual(history.account_scanned_height, 100)
+    assert.strictEqual(history.blockchain_height, 120)
+    assert.deepStrictEqual(history.serialized_transactions.map(tx => tx.hash), ['c', 'a'])
+    const outgoing = history.serialized_transactions[1]
+    assert.strictEqual(outgoing.total_sent, '1000000000000')
+    assert.strictEqual(outgoing.amount, '-1000000000000')
+    assert.strictEqual(outgoing.approx_float_amount, -1)
+    assert.strictEqual(outgoing.payment_id, undefined)
+    assert.deepStrictEqual(outgoing.spent_outputs.map(output => output.key_image), [ownKeyImage])
+    assert.strictEqual(history.serialized_transactions[0].amount, '1500000000000')
+    assert.strictEqual(history.serialized_transactions[0].approx_float_amount, 1.5)
+  })
+
+  it('wallet state applies only new transactions and resumes from a snapshot', async function () {
+    const WABridge = await require(wasmLocation)({})
+    const txPublicKey = '938a463abc1ea1ea0621ada04331b4947e33d4e0ee27d821dd3245c1320add7d'
+    const ownKeyImage = WABridge.generateKeyImage(txPublicKey, privateViewKey, publicSpendKey, privateSpendKey, 1)
+    const decoyKeyImage = '8a90c3e855fde0a85e71c9c345a26d094a56a5070b0bba6c1e9495bd49aa0741'
+    const transactions = [
+      { id: 1, hash: 'a', total_received: '5000000000000', total_sent: '0', height: 50, mempool: false },
+      {
+        id: 2,
+        hash: 'b',
+        total_received: '0',
+        total_sent: '3000000000000',
+        height: 95,
+        mempool: false,
+        spent_outputs: [
+          { amount: '1000000000000', key_image: ownKeyImage, tx_pub_key: txPublicKey, out_index: 1, mixin: 15 },
+          { amount: '2000000000000', key_image: decoyKeyImage, tx_pub_key: txPublicKey, out_index: 0, mixin: 15 }
+        ]
+      }
+    ]
+
+    const walletContext = WABridge.openWalletContext(address, privateViewKey, privateSpendKey, nettype)
+    const first = WABridge.applyAddressTxs(walletContext, { scanned_block_height: 100, blockchain_height: 100, transactions: transactions })
+    assert.strictEqual(first.isDelta, false)
+    assert.deepStrictEqual(first.history.serialized_transactions.map(tx => tx.hash), ['b', 'a'])
+    assert.strictEqual(first.balances.balance, '4000000000000')
+    assert.strictEqual(first.balances.unlocked_balance, '5000000000000') // b's send is still locked
+    transactions.push({ id: 3, hash: 'c', total_received: '2000000000000', total_sent: '0', height: 105, mempool: false })
+    const second = WABridge.applyAddressTxs(walletContext, JSON.stringify({ scanned_block_height: 110, blockchain_height: 110, transactions: transactions }))
+    assert.strictEqual(second.isDelta, true)
+    assert.deepStrictEqual(second.history.serialized_transactions.map(tx => tx.hash), ['c'])
+    assert.strictEqual(second.balances.balance, '6000000000000')
+    assert.strictEqual(second.balances.unlocked_balance, '4000000000000')
+
+    const output = (publicKey, index, spendKeyImages) => unspentOutput(txPublicKey, publicKey, index, spendKeyImages)
+    assert.strictEqual(WABridge.addOwnedOutputs(walletContext, [output('11'.repeat(32), 1), output('22'.repeat(32), 0)]), 2)
+    const statuses = {}
+    WABridge.walletStateOutputs(walletContext).forEach(function (output) {
+      statuses[output.public_key] = output.status
+    })
+    assert.deepStrictEqual(statuses, { ['11'.repeat(32)]: 'spent', ['22'.repeat(32)]: 'unspent' })
+
+    const snapshot = WABridge.walletStateSnapshot(walletContext)
+    WABridge.closeWalletContext(walletContext)
+    const restarted = WABridge.openWalletContext(address, privateViewKey, privateSpendKey, nettype)
+    assert.strictEqual(WABridge.loadWalletStateSnapshot(restarted, snapshot), true)
+    assert.deepStrictEqual(WABridge.walletStateBalances(restarted), second.balances)
+    assert.strictEqual(WABridge.walletStateOutputs(restarted).length, 2)
+    const resumed = WABridge.applyAddressTxs(restarted, { scanned_block_height: 110, blockchain_height: 110, transactions: transactions })
+    assert.strictEqual(resumed.isDelta, true)
+    assert.strictEqual(resumed.history.serialized_transactions.length, 0)
+    WABridge.closeWalletContext(restarted)
+  })
+
+  it('wallet state payloads must be well formed JSON', async function () {
+    const WABridge = await require(wasmLocation)({})
+    const walletContext = WABridge.openWalletContext(address, privateViewKey, privateSpendKey, nettype)
+    const valid = ' { "scanned_block_height": 10, "blockchain_height": 10, "extra": { "a": [1, {}, [], "]"], "b": null },\n' +
+      '"transactions": [ { "id": 1, "hash": "a", "total_received": "5", "total_sent": "0", "height": 5, "mempool": false } ] } '
+    const applied = WABridge.applyAddressTxs(walletContext, valid)
+    assert.deepStrictEqual(applied.history.serialized_transactions.map(tx => tx.hash), ['a'])
+
+    const malformed = [
+      '{"scanned_block_height":10"blockchain_height":10}', // no separator
+      '{"scanned_block_height":10{"blockchain_height":10}', // an opening brace in place of ','
+      '{"extra":{"a":1{"b":2},"transactions":[]}', // the same, in a skipped object
+      '{"transactions":[{"id":2,"hash":"b"}[{"id":3,"hash":"c"}]}', // an opening bracket in place of ','
+      '{"extra":[1[2]],"transactions":[]}', // the same, in a skipped array
+      '{,"transactions":[]}',
+      '{"transactions":[,{"id":2,"hash":"b"}]}',
+      '{"transactions":[],}',
+      '{"transactions":[{"id":2,"hash":"b"},]}',
+      '{"transactions":[]}}'
+    ]
+    const truncated = [
+      '',
+      '{',
+      '{"transactions"',
+      '{"transactions":[',
+      '{"transactions":[{"id":2,"hash":"b"}',
+      '{"transactions":[{"id":2,"hash":"b'
+    ]
+    malformed.concat(truncated).forEach(function (payload) {
+      chai.expect(() => {
+        WABridge.applyAddressTxs(walletContext, payload)
+      }, payload).to.throw('JSON parse error')
+    })
+    assert.strictEqual(WABridge.applyAddressTxs(walletContext, valid).history.serialized_transactions.length, 0)
+    WABridge.closeWalletContext(walletContext)
+  })
+
+  it('output index adds unspent outputs and removes spent ones', async function () {
+    const WABridge = await require(wasmLocation)({})
+    const txPublicKey = '585d3601bc6f3b63ad041fbb5f301a6239cbc98ec2954ef827d5f81aed59cff9'
+    const keyImage = WABridge.generateKeyImage(txPublicKey, privateViewKey, publicSpendKey, privateSpendKey, 1)
+    const output = (publicKey, index, spendKeyImages) => unspentOutput(txPublicKey, publicKey, index, spendKeyImages)
+
+    const walletContext = WABridge.openWalletContext(address, privateViewKey, privateSpendKey, nettype)
+    assert.strictEqual(WABridge.outputIndexAdd(walletContext, [
+      output('11'.repeat(32), 0, []),
+      output('22'.repeat(32), 1, [keyImage]), // spent
+      output('33'.repeat(32), 2, [keyImage]) // someone else's spend
+    ]), 2)
+    assert.strictEqual(WABridge.outputIndexAdd(walletContext, [output('11'.repeat(32), 0, [])]), 2)
+    assert.strictEqual(WABridge.outputIndexRemove(walletContext, ['33'.repeat(32)]), 1)
+    WABridge.closeWalletContext(walletContext)
+  })
+
+  it('unspent outputs are taken in chunks without the spent ones', async function () {
+    const WABridge = await require(wasmLocation)({})
+    const txPublicKey = '585d3601bc6f3b63ad041fbb5f301a6239cbc98ec2954ef827d5f81aed59cff9'
+    const keyImage = WABridge.generateKeyImage(txPublicKey, privateViewKey, publicSpendKey, privateSpendKey, 1)
+    const output = (publicKey, index, spendKeyImages) => unspentOutput(txPublicKey, publicKey, index, spendKeyImages)
+    async function * pages () {
+      yield { per_byte_fee: '24658', fee_mask: '10000', fork_version: '16', outputs: [output('11'.repeat(32), 0, [])] }
+      yield JSON.stringify({ outputs: [output('22'.repeat(32), 1, [keyImage]), output('33'.repeat(32), 2, [keyImage])] })
+    }
+
+    const walletContext = WABridge.openWalletContext(address, privateViewKey, privateSpendKey, nettype)
+    const unspentOutsId = await WABridge.ingestUnspentOuts(walletContext, pages())
+    assert.strictEqual(WABridge.finishUnspentOuts(unspentOutsId), 2)
+    chai.expect(() => {
+      WABridge.appendUnspentOuts(unspentOutsId, { outputs: [] })
+    }).to.throw('Unspent outputs were already finished')
+    assert.strictEqual(WABridge.releaseUnspentOuts(unspentOutsId), true)
+    assert.strictEqual(WABridge.releaseUnspentOuts(unspentOutsId), false)
+    WABridge.closeWalletContext(walletContext)
+  })
+
+  it('open wallet context throws error on keys of another wallet', async function () {
+    const WABridge = await require(wasmLocation)({})
+
+    chai.expect(() => {
+      WABridge.openWalletContext(
+        address,
+        '5925eac0f78c40a79c75a43be68905adeb7b6ae34c1be2dda2b5b417f8099700',
+        privateSpendKey,
+        nettype
+      )
+    }).to.throw('Private view key does not match address')
+  })
+
   it('generate key image throws error on invalid output index', async function () {
     const WABridge = await require(wasmLocation)({})
 
@@ -557,4 +876,226 @@ describe('cryptonote_utils tests', function () {
       WABridge.estimateTxFee(1, 'test')
     }).to.throw('Invalid feePerb. must be an number')
   })
+
+  it('estimate fee matrix', async function () {
+    const WABridge = await require(wasmLocation)({})
+
+    const matrix = WABridge.estimateFeeMatrix(6000, { maxInputs: 4, maxOutputs: 3, forkVersions: [14, 16] })
+
+    assert.strictEqual(matrix.fees.length, 2 * 4 * 4 * 3)
+    assert.strictEqual(matrix.fee(1, 1, 2), matrix.fees[1])
+    assert.strictEqual(matrix.fee(2, 1, 1, 16), matrix.fees[4 * 4 * 3 + 4 * 3])
+    for (const forkVersion of matrix.forkVersions) {
+      for (let priority = 1; priority <= 4; priority++) {
+        assert.ok(matrix.fee(priority, 2, 2, forkVersion) % 10000 === 0)
+        assert.ok(matrix.fee(priority, 3, 2, forkVersion) > matrix.fee(priority, 2, 2, forkVersion))
+        assert.ok(matrix.fee(priority, 2, 3, forkVersion) > matrix.fee(priority, 2, 2, forkVersion))
+        if (priority > 1) {
+          assert.ok(matrix.fee(priority, 2, 2, forkVersion) > matrix.fee(priority - 1, 2, 2, forkVersion))
+        }
+      }
+    }
+  })
+
+  it('estimate fee matrix invalid shape', async function () {
+    const WABridge = await require(wasmLocation)({})
+
+    chai.expect(() => {
+      WABridge.estimateFeeMatrix(6000, { maxOutputs: 17 })
+    }).to.throw('Invalid maxInputs or maxOutputs')
+    chai.expect(() => {
+      WABridge.estimateFeeMatrix(6000, { feeMask: -1 })
+    }).to.throw('JSON parse error')
+    const args = { fee_per_b: '6000', fork_versions: ['16'], max_inputs: '4', max_outputs: '2' }
+    const errMsg = (changes) => JSON.parse(WABridge.Module.estimateFeeMatrix(JSON.stringify(Object.assign({}, args, changes)))).err_msg
+    assert.strictEqual(errMsg({ fee_mask: '0' }), 'Expected a non-zero fee_mask')
+    assert.strictEqual(errMsg({ fork_versions: ['256'] }), 'Invalid fork version')
+    assert.strictEqual(errMsg({ fork_versions: [] }), 'Expected at least one fork version')
+    assert.strictEqual(errMsg({ max_inputs: '4294967297' }), 'max_inputs out of range')
+    assert.strictEqual(errMsg({ max_outputs: '0' }), 'max_outputs out of range')
+  })
+
+  it('create transactions rejects a payment id', async function () {
+    const WABridge = await require(wasmLocation)({})
+
+    await assert.rejects(WABridge.createTransactions({
+      destinations: [{ to_address: '49qwWM9y7j1fvaBK684Y5sMbN8MZ3XwDLcSaqcKwjh5W9kn9qFigPBNBwzdq6TCAm2gKxQWrdZuEZQBMjQodi9cNRHuCbTr', send_amount: '1' }],
+      shouldSweep: false,
+      paymentId: 'b79f8efc81f58f67',
+      priority: 1,
+      nettype: nettype,
+      walletContext: '1',
+      unspentOuts: { outputs: [] },
+      randomOutsCb: () => Promise.resolve({ amount_outs: [] })
+    }), { message: 'Payment IDs aren\'t supported in batch sends; use integrated addresses' })
+  })
+
+  it('plan transactions gives each integrated address its own transaction', async function () {
+    const WABridge = await require(wasmLocation)({})
+
+    const plan = WABridge.planTransactions({
+      sendingAmounts: ['1', '1', '1'],
+      isIntegrated: [true, false, true],
+      outputAmounts: ['10', '10']
+    })
+
+    assert.deepStrictEqual(plan, [
+      { destinationIndices: [0, 1], outputIndices: [0] },
+      { destinationIndices: [2], outputIndices: [1] }
+    ])
+  })
+
+  it('plan transactions splits destinations by fifteen', async function () {
+    const WABridge = await require(wasmLocation)({})
+
+    const plan = WABridge.planTransactions({
+      sendingAmounts: new Array(16).fill('1'),
+      outputAmounts: ['100', '200']
+    })
+
+    assert.strictEqual(plan.length, 2)
+    assert.deepStrictEqual(plan[0].destinationIndices, [0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14])
+    assert.deepStrictEqual(plan[0].outputIndices, [1]) // largest first
+    assert.deepStrictEqual(plan[1], { destinationIndices: [15], outputIndices: [0] })
+  })
+
+  it('plan transactions halves a group which needs more than 120 inputs', async function () {
+    const WABridge = await require(wasmLocation)({})
+    const outputAmounts = new Array(240).fill('1')
+    const range = (begin, end) => Array.from({ length: end - begin }, (_, i) => begin + i)
+
+    const plan = WABridge.planTransactions({ sendingAmounts: ['100', '100'], outputAmounts })
+
+    assert.deepStrictEqual(plan, [
+      { destinationIndices: [0], outputIndices: range(0, 100) },
+      { destinationIndices: [1], outputIndices: range(100, 200) }
+    ])
+    chai.expect(() => {
+      WABridge.planTransactions({ sendingAmounts: ['200'], outputAmounts })
+    }).to.throw('A destination needs more inputs than fit in one transaction')
+  })
+
+  it('plan transactions with too low a balance', async function () {
+    const WABridge = await require(wasmLocation)({})
+
+    chai.expect(() => {
+      WABridge.planTransactions({ sendingAmounts: ['100'], outputAmounts: ['50', '49'] })
+    }).to.throw('Spendable balance too low')
+    chai.expect(() => { // enough for the amount but not the fee
+      WABridge.planTransactions({ sendingAmounts: ['100'], outputAmounts: ['100'], feePerb: '1' })
+    }).to.throw('Spendable balance too low')
+  })
+
+  it('plan transactions deals a sweep round-robin by amount', async function () {
+    const WABridge = await require(wasmLocation)({})
+    const outputAmounts = Array.from({ length: 241 }, (_, i) => '' + (i + 1)) // index 240 is the largest
+
+    const plan = WABridge.planTransactions({ isSweeping: true, sendingAmounts: [], outputAmounts })
+
+    assert.deepStrictEqual(plan.map(planned => planned.outputIndices.length), [81, 80, 80])
+    assert.deepStrictEqual(plan.map(planned => planned.outputIndices.slice(0, 2)), [[240, 237], [239, 236], [238, 235]])
+    plan.forEach(planned => assert.deepStrictEqual(planned.destinationIndices, [0]))
+  })
+
+  it('send metrics reports every phase', async function () {
+    const WABridge = await require(wasmLocation)({})
+
+    const metrics = WABridge.sendMetrics()
+
+    assert.deepStrictEqual(
+      Object.keys(metrics.phases),
+      ['parseArgs', 'decryptOutputs', 'selectOutputs', 'tieOutsToMixOuts', 'signTransaction', 'verifyTransaction', 'serializeResponse']
+    )
+    assert.ok(parseInt(metrics.prepared) >= 0)
+  })
+
+  it('verify before return accepts a signed transaction, and a tampered one is rejected', async function () {
+    this.timeout(20000)
+    const WABridge = await require(wasmLocation)({})
+    const output = { // 0.01 XMR to the wallet, RingCT v2
+      amount: '10000000000',
+      public_key: '2d9da11ecf627f3c93155654acdee56087c961836512cebc3077fcf8d8b3d039',
+      index: '0',
+      global_index: '1000000',
+      rct: '03aaa4cdb1d6bd904acb64e43b3e4d889b5617cae0b1f91f43623862aebd6c6b12f0cd24bc1fc369',
+      tx_id: '1',
+      tx_hash: '9472ced8b36d0eda454183053ada27172367a91458c84b43797a7b7dc28a110f',
+      tx_prefix_hash: 'fa47b52c6877a5762cdbd7268760125b8c27c5391132153846f3079280db5445',
+      tx_pub_key: '96f1c35a77bd67dafb4af12b3a7d17dde189753d62a192400165aeb8dc5e8186',
+      timestamp: '2022-01-01T00:00:00Z',
+      height: '2500000',
+      spend_key_images: []
+    }
+    const decoys = [ // [public_key, commitment]
+      ['86efcad234715df8bf5a6dc11cf89bac2fcd1bfdf81b24b3327fe12620f7336e', 'af39b29b9d3a15aae2f53f665d1bb008d1f25e5320c596ea994d098e59793ffd'],
+      ['6adfe042686b7645cd62886c3455c6357deabaf1f3203e28ae34a4da2e108d9b', '1d62359ee3c84eb2a752ad317f15df092e83edda7268ba578d6f5f0b53f50fea'],
+      ['32b1f74283637ffd776d942c03156fd12164639fbd190ae532b9d0202c3ab4ef', 'ee1f67a39598e3d730ca679c69da09ab032d73370afc2ce0d074465156592214'],
+      ['8f15771e52a2b46673ddebfe54182357889e11c5195437fcdc101153fa7fddf8', '30e2c03687adacb0822a18a49c1fb6de80e8bed3b0f7b58e19719b7c653a1b7d'],
+      ['be9ba87db4b520b0dce26c646bd949ee10cd0a26eb83390d5a7d63662dbaf71d', '799a667198208d846db34307cb7e65e616a2cb8292aae70cad072883d4d1fab3'],
+      ['d6012a370c78dd0b5b635a8f7500fd9e9ff064b293987509774fd46d6cf723ee', 'd31104c0c3924f398241a5f6ebb677344047e31c2ddf840a439289dcafa9817c'],
+      ['a290c1e3040d1f52008b6b60ca2b2c0d981f0c0c80c48ac31110717677636fd9', '8d3acc3b29c39c0785faf3afbb098f7ddc2e1e8165570cdf6b2b7ab74c3c5c94'],
+      ['01be5ee294b6c367468e65206d786e94617370816c190b7a5c2e4939b7cf5b70', '9e83956b664508149c6375d7087a31da7e9c860efee9a0360222391e218327f0'],
+      ['21baa42e5a4e2149bbd9e997156a9a309054ffbe11c50f76661019ba4b665111', '6bdbe0c6c189cceb67e6870f5d7181cc35ab910f53a4df79befd38ec7d9bc304'],
+      ['7a47cbf7db7c4c3a98c5c8fefd73e77c7ba0ee3b3cf5630840da111dd3382548', 'e9f3cb16449603407f04201342fd865eae2e69a196c05017cc22017e7b76986a'],
+      ['eca4e9f6547a2016a51474ac34d3e0d505149b064d9d7aa029f1adb11ca5514e', '3feaa69d931b4f47c329dd6280c2647e817ca7b45def42a9f638732f8a1a8246'],
+      ['77aaf77d75c077e4827568b24d7a05a18da3e901adc85361ee3a3eff886b95f7', '00ed337f6609400fdb23fcf363bdd22d6da4a8e10d3ffda9d6369f80abb5f2d8'],
+      ['4c34e16012a18e69e935a03dbdb59418fa6cf03ee358579152e399fea6ee335b', 'db690a508d9447651959a0bad65789bfa1fc7d65c2694c1e4bc0cd60797440c6'],
+      ['cc29b375890d64356b9ee734ebd7fcc1c154782603ad7c5e70d127d150050044', 'a60d3405e1a120aae595ac8255cebc85393dd12e6a52c38999a995967809f704'],
+      ['9c0f458d862aa841349544cf4f8aba81802b3f1ec6fe339f4965ecdd78865850', '2dd19289adbe6094a565597bd99767ade654362f99d7ec46d6cb9394ef5af3e2'],
+      ['d4e5b726d95494412ee121c6581e5797df69baef85e4366f6745d3dfc4d4dd73', 'bf5b8e47e2c910f3fab9a83cedd53122a52b40e4a838c92388c2b59082f74849']
+    ].map(([publicKey, rct], j) => ({ global_index: '' + (5000000 + j * 11), public_key: publicKey, rct: rct }))
+    const amountOuts = [{ amount: '0', outputs: decoys }]
+
+    const transaction = await WABridge.createTransaction({
+      destinations: [{ to_address: address, send_amount: 0 }],
+      shouldSweep: true,
+      address: address,
+      privateViewKey: privateViewKey,
+      publicSpendKey: publicSpendKey,
+      privateSpendKey: privateSpendKey,
+      priority: 1,
+      nettype: nettype,
+      unspentOuts: { amount: '10000000000', per_byte_fee: '20000', fee_mask: '10000', fork_version: '16', outputs: [output] },
+      randomOutsCb: () => Promise.resolve({ amount_outs: amountOuts }),
+      verifyBeforeReturn: true
+    })
+    const signed = { serializedSignedTx: transaction.serialized_signed_tx, usingOuts: [output], mixOuts: amountOuts }
+    assert.strictEqual(WABridge.verifyTransaction(signed), true)
+
+    // the one input's CLSAG ends with c1, D and then its pseudo output commitment
+    const c1Offset = transaction.serialized_signed_tx.length - 3 * 64
+    const flipped = (parseInt(transaction.serialized_signed_tx.substr(c1Offset, 2), 16) ^ 1).toString(16).padStart(2, '0')
+    chai.expect(() => {
+      WABridge.verifyTransaction(Object.assign({}, signed, {
+        serializedSignedTx: transaction.serialized_signed_tx.substr(0, c1Offset) + flipped + transaction.serialized_signed_tx.substr(c1Offset + 2)
+      }))
+    }).to.throw('Invalid ring signature of input 0')
+
+    const otherDecoys = decoys.map(decoy => Object.assign({}, decoy, { global_index: '' + (parseInt(decoy.global_index) + 1) }))
+    chai.expect(() => {
+      WABridge.verifyTransaction(Object.assign({}, signed, { mixOuts: [{ amount: '0', outputs: otherDecoys }] }))
+    }).to.throw('Ring member is not among the outputs it was signed with')
+  })
+
+  it('warms up the proof tables once', async function () {
+    const WABridge = await require(wasmLocation)({ warmUp: false })
+
+    assert.strictEqual(WABridge.warmUpProofs(), true)
+    assert.strictEqual(WABridge.warmUpProofs(), false)
+  })
+
+  it('address variant decodes addresses without the send functions', async function () {
+    const WABridge = await require(wasmLocation)({ variant: 'address' })
+    const decoded = WABridge.decodeAddress(
+      '49qwWM9y7j1fvaBK684Y5sMbN8MZ3XwDLcSaqcKwjh5W9kn9qFigPBNBwzdq6TCAm2gKxQWrdZuEZQBMjQodi9cNRHuCbTr',
+      nettype
+    )
+    assert.strictEqual(decoded.publicSpendKey, 'd8f1e81ecbe25ce8b596d426fb02fe7b1d4bb8d14c06b3d3e371a60eeea99534')
+    assert.strictEqual(WABridge.Module.prepareTx, undefined)
+    assert.strictEqual(WABridge.Module.generateKeyImage, undefined)
+  })
+
+  it('unknown variant is rejected', async function () {
+    await assert.rejects(require(wasmLocation)({ variant: 'keys' }), { message: 'Unknown variant keys' })
+  })
 })
@@ -0,0 +1,68 @@
+'use strict'
+
+const assert = require('assert')
+const WireFormat = require('../../src/WireFormat')
+const wasmLocation = '../../src/index'
+
+describe('wire format tests', function () {
+  it('writes unspent outputs as fixed width records', function () {
+    const outputs = [{
+      amount: '1000000000000',
+      global_index: '123',
+      index: 1,
+      public_key: 'ab'.repeat(32),
+      tx_pub_key: 'cd'.repeat(32),
+      rct: 'ef'.repeat(32),
+      spend_key_images: ['01'.repeat(32)]
+    }]
+    const byteLength = WireFormat.unspentOutputsByteLength(outputs)
+    assert.strictEqual(byteLength, 16 + 192 + 32)
+    const bytes = new Uint8Array(byteLength)
+    WireFormat.writeUnspentOutputs(bytes, outputs)
+    const view = new DataView(bytes.buffer)
+    assert.strictEqual(String.fromCharCode(bytes[0], bytes[1], bytes[2], bytes[3]), 'MMUO')
+    assert.strictEqual(view.getUint32(8, true), 1)
+    assert.strictEqual(view.getBigUint64(16, true), BigInt('1000000000000'))
+    assert.strictEqual(view.getBigUint64(24, true), BigInt(123))
+    assert.strictEqual(bytes[16 + 24], 0xab)
+    assert.strictEqual(bytes[16 + 56], 0xcd)
+    assert.strictEqual(view.getUint32(16 + 88, true), 32)
+    assert.strictEqual(view.getUint32(16 + 92, true), 1)
+    assert.strictEqual(bytes[16 + 192], 0x01)
+  })
+
+  it('falls back for outputs the wire format cannot represent', function () {
+    assert.strictEqual(WireFormat.unspentOutputsByteLength([{ public_key: 'ab'.repeat(32), tx_pub_key: 'cd'.repeat(32), rct: 'coinbase' }]), null)
+    assert.strictEqual(WireFormat.randomOutsByteLength([{ amount: '0', outputs: [{ global_index: '1', public_key: 'ab' }] }]), null)
+  })
+
+  it('rejects counts whose byte length would wrap a 32-bit size_t', async function () {
+    const WABridge = await require(wasmLocation)({})
+    const outputs = [{ amount: '1', global_index: '1', index: 0, public_key: 'ab'.repeat(32), tx_pub_key: 'cd'.repeat(32), spend_key_images: [] }]
+    const args = JSON.stringify({
+      destinations: [{ to_address: 'x', send_amount: '1' }],
+      unspentOuts: {},
+      is_sweeping: false,
+      priority: 1,
+      nettype_string: 'MAINNET'
+    })
+    const unspentOutputs = new Uint8Array(WireFormat.unspentOutputsByteLength(outputs))
+    WireFormat.writeUnspentOutputs(unspentOutputs, outputs)
+    new DataView(unspentOutputs.buffer).setUint32(16 + 92, 0x08000000, true) // * 32 bytes = 2^32
+    const prepared = JSON.parse(WABridge._withHeapBytes(unspentOutputs.length, function (bytes) {
+      bytes.set(unspentOutputs)
+    }, (pointer) => WABridge.Module.prepareTxWire(args, pointer, unspentOutputs.length)))
+    assert.strictEqual(prepared.err_msg, 'Truncated spend key images')
+
+    const randomOuts = new Uint8Array(16 + 16 + 16)
+    const view = new DataView(randomOuts.buffer)
+    randomOuts.set([0x4d, 0x4d, 0x52, 0x4f]) // MMRO
+    view.setUint32(4, 1, true)
+    view.setUint32(8, 1, true)
+    view.setUint32(16 + 8, 149130809, true) // * 144 bytes = 2^32 + 16, the bytes left
+    const signed = JSON.parse(WABridge._withHeapBytes(randomOuts.length, function (bytes) {
+      bytes.set(randomOuts)
+    }, (pointer) => WABridge.Module.createAndSignTxWire('', pointer, randomOuts.length)))
+    assert.strictEqual(signed.err_msg, 'Truncated random outs')
+  })
+})
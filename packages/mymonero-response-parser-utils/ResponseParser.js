@@ -191,6 +191,15 @@ function Parsed_AddressTransactions__sync (
   spend_key__private,
   coreBridge_instance
 ) {
+  if (typeof coreBridge_instance.parseOwnedTransactions === 'function') {
+    // the whole history in one call, rather than a bridge call per spent output
+    return coreBridge_instance.parseOwnedTransactions(data, {
+      address: address,
+      privateViewKey: view_key__private,
+      publicSpendKey: spend_key__public,
+      privateSpendKey: spend_key__private
+    })
+  }
   const account_scanned_height = data.scanned_height || 0
   const account_scanned_block_height = data.scanned_block_height || 0
   const account_scan_start_height = data.start_height || 0
@@ -65,7 +65,8 @@ class BackgroundResponseParser {
     address,
     fn // ((err) -> Void)?
   ) {
-    monero_keyImage_cache_utils.DeleteManagedKeyImagesForWalletWith(address)
+    const self = this
+    monero_keyImage_cache_utils.DeleteManagedKeyImagesForWalletWith(address, self.coreBridge_instance)
     if (fn) {
       setTimeout(fn, 0)
       // setImmediate(fn)
@@ -15,6 +15,16 @@ function ownedParsedTxFrom__orNil (
   keyImage_cache,
   coreBridge_instance
 ) {
+  if (typeof coreBridge_instance.parseOwnedTransactions === 'function') {
+    // parsed in C++, which leaves raw_tx untouched
+    const history = coreBridge_instance.parseOwnedTransactions({ transactions: [raw_tx] }, {
+      address: address,
+      privateViewKey: view_key__private,
+      publicSpendKey: spend_key__public,
+      privateSpendKey: spend_key__private
+    })
+    return history.serialized_transactions.length > 0 ? history.serialized_transactions[0] : null
+  }
   var tx = JSON.parse(JSON.stringify(raw_tx)) // copy ... do we need/want to do this?
   
   if ((tx.spent_outputs || []).length > 0) {
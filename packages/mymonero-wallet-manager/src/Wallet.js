@@ -4,6 +4,45 @@ const BigNumber = require('bignumber.js')
 
 const Transaction = require('./Transaction')
 
+/**
+ * Encodes a wallet state snapshot for serialize().
+ * @param {Uint8Array} bytes
+ * @returns {string} base64
+ */
+function encodeWalletState (bytes) {
+  if (typeof Buffer !== 'undefined') {
+    return Buffer.from(bytes.buffer, bytes.byteOffset, bytes.byteLength).toString('base64')
+  }
+  let binary = ''
+  for (let i = 0; i < bytes.length; i += 0x8000) {
+    binary += String.fromCharCode.apply(null, bytes.subarray(i, i + 0x8000))
+  }
+  return btoa(binary)
+}
+
+/**
+ * Decodes the walletState of serialize(): base64, or the number array earlier versions saved.
+ * @param {string|array} walletState
+ * @returns {Uint8Array|null}
+ */
+function decodeWalletState (walletState) {
+  if (Array.isArray(walletState)) {
+    return Uint8Array.from(walletState)
+  }
+  if (typeof walletState !== 'string') {
+    return null
+  }
+  if (typeof Buffer !== 'undefined') {
+    return new Uint8Array(Buffer.from(walletState, 'base64'))
+  }
+  const binary = atob(walletState)
+  const bytes = new Uint8Array(binary.length)
+  for (let i = 0; i < binary.length; i++) {
+    bytes[i] = binary.charCodeAt(i)
+  }
+  return bytes
+}
+
 class Wallet {
   /**
    * Construct new Wallet
@@ -14,6 +53,8 @@ class Wallet {
    * @param {string} [options.url]
    * @param {string} [options.appName]
    * @param {string} [options.appVersion]
+   * @param {string} [options.walletState] - The walletState of serialize(), to resume syncing from
+   * @param {array} [options.transactions] - The transactions of serialize(), kept with the walletState
    */
   constructor (bridge, apiClient, contactManager, options = {}) {
     this.contactManager = contactManager
@@ -23,6 +64,8 @@ class Wallet {
     this.mnemonicLanguage = options.mnemonicLanguage || null
     this.netType = options.netType || 'MAINNET'
     this.keyImageCache = []
+    this.walletContext = null // see _applyToWalletState
+    this.walletState = decodeWalletState(options.walletState) // snapshot to resume from
     this.bridgeClass = bridge
     this.lwsClient = apiClient
     this.url = options.url || 'https://api.mymonero.com'
@@ -52,6 +95,14 @@ class Wallet {
         this.cachedTransactions[options.cachedTransactions[i].hash] = options.cachedTransactions[i]
       }
     }
+    if (this.walletState !== null) {
+      // the walletState only sends what's new since it was taken, so it's only of use with the history it was taken with
+      if (Array.isArray(options.transactions)) {
+        this.transactions = options.transactions.map((transaction) => this._restoreTransaction(transaction))
+      } else {
+        this.walletState = null
+      }
+    }
   }
 
   /**
@@ -68,6 +119,15 @@ class Wallet {
     self.transactionHeight = data.transaction_height
     self.rawTransactions = data.transactions
     self.sinceTxId = data.since_tx_id
+    if (self._canUseWalletState()) {
+      // applies only what's new since the last sync, and keeps the balances in WebAssembly
+      const transactions = self._applyToWalletState(data)
+      if (transactions !== null) {
+        self.transactions = transactions
+        return self.transactions
+      }
+      self.walletState = null // it hasn't seen this response, so the next sync starts again from the full history
+    }
     self.transactions = await self._parseTransactions(self.rawTransactions, self.cachedTransactions)
     // calculate current balances based on the transaction list
     self._calculateBalances()
@@ -342,6 +402,156 @@ class Wallet {
     self.feeMask = unspentOuts.fee_mask
   }
 
+  /**
+   * Whether the bridge can keep the wallet's state between syncs. It needs the private spend key for the key images.
+   * @private
+   * @returns {boolean}
+   */
+  _canUseWalletState () {
+    const self = this
+    return typeof self.bridgeClass.applyAddressTxs === 'function' && self.privateSpendKey !== null
+  }
+
+  /**
+   * Opens the wallet context which holds the wallet's state, resuming from the snapshot of the last sync.
+   * @private
+   * @returns {boolean} False if the bridge has no room for another wallet context.
+   */
+  _openWalletContext () {
+    const self = this
+    try {
+      self.walletContext = self.bridgeClass.openWalletContext(self.address, self.privateViewKey, self.privateSpendKey, self.netType)
+    } catch (error) {
+      if (error.message !== 'Too many wallet contexts open') {
+        throw error
+      }
+      return false
+    }
+    if (self.walletState !== null && !self.bridgeClass.loadWalletStateSnapshot(self.walletContext, self.walletState)) {
+      // corrupt, or of another version - the state starts again from this response, and so does the history
+      self.walletState = null
+      self.transactions = []
+    }
+    return true
+  }
+
+  /**
+   * Applies a get_address_txs response to the wallet state: only the transactions confirmed since the last sync and
+   * those in the mempool are parsed and key imaged. They replace the mempool transactions and are added to the rest.
+   * The wallet context is only held for the call, so that any number of wallets can sync: its state is kept in
+   * walletState until the next sync.
+   * @private
+   * @param {object} data - The get_address_txs response.
+   * @returns {array|null} Clean set of transactions, mempool first then newest to oldest, or null if no wallet
+   * context could be opened
+   */
+  _applyToWalletState (data) {
+    const self = this
+    if (!self._openWalletContext()) {
+      return null
+    }
+    let result
+    try {
+      result = self.bridgeClass.applyAddressTxs(self.walletContext, data)
+      self.walletState = self.bridgeClass.walletStateSnapshot(self.walletContext)
+    } finally {
+      self.close()
+    }
+    const transactions = []
+    result.history.serialized_transactions.forEach(function (rawTransaction) {
+      transactions.push(self._transactionFrom(rawTransaction, self.cachedTransactions))
+    })
+    if (result.isDelta) {
+      self.transactions.forEach(function (transaction) {
+        if (transaction.mempool === true) {
+          return // the response has every mempool transaction
+        }
+        transaction.currentBlockHeight = self.blockHeight
+        transaction._calculateConfirmations()
+        transaction._calulateStatus()
+        transactions.push(transaction)
+      })
+    }
+    transactions.sort(self._compareTransactions)
+    self.balance = new BigNumber(result.balances.balance)
+    self.balancePending = new BigNumber(result.balances.pending_balance)
+    self.balanceUnlocked = new BigNumber(result.balances.unlocked_balance)
+
+    return transactions
+  }
+
+  /**
+   * Builds a Transaction from a transaction of a get_address_txs response, with the local data of a sent one.
+   * @private
+   * @param {object} rawTransaction - The transaction retrieved from the server.
+   * @param {array} cachedTransactions - List of all sent transactions with local data.
+   * @returns {Transaction}
+   */
+  _transactionFrom (rawTransaction, cachedTransactions) {
+    const self = this
+    const options = {
+      hash: rawTransaction.hash,
+      id: rawTransaction.id,
+      timestamp: rawTransaction.timestamp,
+      received: rawTransaction.total_received,
+      sent: rawTransaction.total_sent,
+      fee: rawTransaction.fee,
+      unlockTime: rawTransaction.unlock_time,
+      height: rawTransaction.height,
+      coinbase: rawTransaction.coinbase,
+      mempool: rawTransaction.mempool,
+      mixin: rawTransaction.mixin,
+      spentOutputs: rawTransaction.spent_outputs || [],
+      currentBlockHeight: self.blockHeight
+    }
+
+    if (cachedTransactions[rawTransaction.hash] !== undefined) {
+      options.contact = cachedTransactions[rawTransaction.hash].contact
+      options.txPublicKey = cachedTransactions[rawTransaction.hash].txPublicKey
+      options.destinationAddress = cachedTransactions[rawTransaction.hash].destinationAddress
+    }
+    return new Transaction(options)
+  }
+
+  /**
+   * Rebuilds a Transaction from one of the transactions of serialize().
+   * @private
+   * @param {object} serialized - The transaction, or its JSON.
+   * @returns {Transaction}
+   */
+  _restoreTransaction (serialized) {
+    if (serialized instanceof Transaction) {
+      return serialized
+    }
+    const options = Object.assign({}, serialized)
+    options.spentOutputs = (serialized.spentOutputs || []).map(function (output) {
+      return {
+        tx_pub_key: output.txPublicKey,
+        key_image: output.keyImage,
+        amount: output.amount,
+        out_index: output.outputIndex,
+        mixin: output.mixin
+      }
+    })
+    return new Transaction(options)
+  }
+
+  /**
+   * Orders transactions mempool first then by newest to oldest
+   * @private
+   */
+  _compareTransactions (a, b) {
+    if (a.mempool === true) {
+      if (b.mempool !== true) {
+        return -1 // a first
+      }
+      // both mempool - fall back to .id compare
+    } else if (b.mempool === true) {
+      return 1 // b first
+    }
+    return b.id - a.id // compare sequential transaction id
+  }
+
   /**
    * Parses Transactions. This removes mixins and spent outputs that are not related to the address.
    * @private
@@ -355,30 +565,11 @@ class Wallet {
       return {}
     }
     const transactions = []
+    // derive every uncached key image in one bridge call before checking the spent outputs below
+    self._generateKeyImagesForSpentOutputs(rawTransactions)
     // TODO: rewrite this with more clarity if possible
     for (let i = 0; i < rawTransactions.length; ++i) {
-      const options = {
-        hash: rawTransactions[i].hash,
-        id: rawTransactions[i].id,
-        timestamp: rawTransactions[i].timestamp,
-        received: rawTransactions[i].total_received,
-        sent: rawTransactions[i].total_sent,
-        fee: rawTransactions[i].fee,
-        unlockTime: rawTransactions[i].unlock_time,
-        height: rawTransactions[i].height,
-        coinbase: rawTransactions[i].coinbase,
-        mempool: rawTransactions[i].mempool,
-        mixin: rawTransactions[i].mixin,
-        spentOutputs: rawTransactions[i].spent_outputs || [],
-        currentBlockHeight: self.blockHeight
-      }
-
-      if (cachedTransactions[rawTransactions[i].hash] !== undefined) {
-        options.contact = cachedTransactions[rawTransactions[i].hash].contact
-        options.txPublicKey = cachedTransactions[rawTransactions[i].hash].txPublicKey
-        options.destinationAddress = cachedTransactions[rawTransactions[i].hash].destinationAddress
-      }
-      const transaction = new Transaction(options)
+      const transaction = self._transactionFrom(rawTransactions[i], cachedTransactions)
 
       if ((transaction.spentOutputs || []).length > 0) {
         for (let j = 0; j < transaction.spentOutputs.length; ++j) {
@@ -399,17 +590,7 @@ class Wallet {
     }
 
     // sort transactions mempool first then by newest to oldest
-    transactions.sort(function (a, b) {
-      if (a.mempool === true) {
-        if (b.mempool !== true) {
-          return -1 // a first
-        }
-        // both mempool - fall back to .id compare
-      } else if (b.mempool === true) {
-        return 1 // b first
-      }
-      return b.id - a.id // compare sequential transaction id
-    })
+    transactions.sort(self._compareTransactions)
 
     return transactions
   }
@@ -435,6 +616,42 @@ class Wallet {
     return keyImage
   }
 
+  /**
+   * Fills the key image cache for all spent outputs of the transactions using one batched WASM call.
+   * @private
+   * @param {array} rawTransactions - List of transactions retrieved from the server.
+   */
+  _generateKeyImagesForSpentOutputs (rawTransactions) {
+    const self = this
+    if (typeof self.bridgeClass.generateKeyImages !== 'function') {
+      return // older bridges only support generating one key image at a time
+    }
+    if (self.privateSpendKey === null) {
+      return // view only - there are no key images to tell our spends from decoys
+    }
+    const outputs = []
+    const cacheIndexes = []
+    for (let i = 0; i < rawTransactions.length; ++i) {
+      const spentOutputs = rawTransactions[i].spent_outputs || []
+      for (let j = 0; j < spentOutputs.length; ++j) {
+        const cacheIndex = `${spentOutputs[j].tx_pub_key}:${spentOutputs[j].out_index}`
+        if (self.keyImageCache[cacheIndex] !== undefined) {
+          continue // cached, or already queued (null) for this batch
+        }
+        self.keyImageCache[cacheIndex] = null
+        cacheIndexes.push(cacheIndex)
+        outputs.push({ txPublicKey: spentOutputs[j].tx_pub_key, outputIndex: spentOutputs[j].out_index })
+      }
+    }
+    if (outputs.length === 0) {
+      return
+    }
+    const keyImages = self.bridgeClass.generateKeyImages(self.privateViewKey, self.publicSpendKey, self.privateSpendKey, outputs)
+    for (let i = 0; i < keyImages.length; ++i) {
+      self.keyImageCache[cacheIndexes[i]] = keyImages[i]
+    }
+  }
+
   /**
    * Calculates the wallets balances. Total, locked and pending
    * @private
@@ -476,12 +693,26 @@ class Wallet {
     return bigNumber.dividedBy(1000000000000).toFormat(12)
   }
 
+  /**
+   * Closes the wallet context, wiping the keys it holds. Syncs close it themselves, so this only has work to do
+   * once the wallet is no longer used if a sync was interrupted. Its state is kept in walletState.
+   */
+  close () {
+    const self = this
+    if (self.walletContext === null) {
+      return
+    }
+    self.bridgeClass.closeWalletContext(self.walletContext)
+    self.walletContext = null
+  }
+
   /**
    * Returns key paired array of wallet values used for saving
    * @returns {array}
    */
   serialize () {
     const self = this
+    const walletState = self.walletState
     const tempCache = []
     Object.keys(self.cachedTransactions).forEach((element) => {
       tempCache.push(self.cachedTransactions[element])
@@ -510,7 +741,8 @@ class Wallet {
       balance: self.balance,
       balancePending: self.balancePending,
       balanceUnlocked: self.balanceUnlocked,
-      cachedTransactions: tempCache
+      cachedTransactions: tempCache,
+      walletState: walletState === null ? null : encodeWalletState(walletState)
     }
   }
 }
@@ -42,6 +42,19 @@ class WalletManager {
     return wallet
   }
 
+  /**
+   * Closes a wallet and removes it from the wallet array.
+   * @param {Wallet} wallet
+   */
+  closeWallet (wallet) {
+    const self = this
+    const index = self.wallets.indexOf(wallet)
+    if (index !== -1) {
+      self.wallets.splice(index, 1)
+    }
+    wallet.close()
+  }
+
   /**
    * Creates a new wallet by generating a new mnemonic phrase.
    * @param {string} name - The Wallet name.